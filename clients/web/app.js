@@ -1,7 +1,9 @@
 'use strict';
 
 (function () {
-  const MAX_SENSORS = 10;
+  // Generated from config/channels.yaml (scripts/gen_channel_map.py).
+  const CHANNEL_MAP = window.ORCA_CHANNEL_MAP;
+  const MAX_SENSORS = CHANNEL_MAP.channels.length;
   const MAX_POINTS = 900;
   const WINDOW_MINUTES = 15;
   const DEFAULT_HFE_GOAL_C = -110.0;
@@ -25,8 +27,8 @@
   const PUMP_EST_RATED_INPUT_W = PUMP_RATED_OUTPUT_W / PUMP_NAMEPLATE_EFFICIENCY;
   const RSV_SCALE_INVALID_RAW_COUNTS = new Set([8388607, -8388608]);
   const RSV_SCALE_UNCERTAINTY_KG = 0.05;
-  const TTI_SENSOR_INDEX = 4;
-  const TTO_SENSOR_INDEX = 6;
+  const TTI_SENSOR_INDEX = CHANNEL_MAP.index.TTI;
+  const TTO_SENSOR_INDEX = CHANNEL_MAP.index.TTO;
   const FLUID_REFERENCE = {
     name: 'HFE-7200',
     concentrationPct: 100.0,
@@ -66,8 +68,11 @@
     { column: 'rsv_scale_mass_kg', key: 'mass_kg', digits: 3 },
     { column: 'rsv_scale_raw_counts', key: 'raw_counts', digits: 0 },
     { column: 'rsv_scale_calibrated', key: 'calibrated', digits: 0 },
+    { column: 'rsv_scale_mass_filtered_kg', key: 'mass_filtered_kg', digits: 4 },
+    { column: 'rsv_scale_rate_kg_h', key: 'rate_kg_h', digits: 5 },
+    { column: 'rsv_scale_rate_sigma_kg_h', key: 'rate_sigma_kg_h', digits: 5 },
   ];
-  const TEMP_LOG_COLUMNS = ['THR_C', 'U1_C', 'TTEST_C', 'TFO_C', 'TTI_C', 'TNO_C', 'TTO_C', 'TMI_C', 'THM_C', 'THI_C'];
+  const TEMP_LOG_COLUMNS = CHANNEL_MAP.channels.map((channel) => channel.column);
   const LOG_HEADER = [
     'time_s',
     ...TEMP_LOG_COLUMNS,
@@ -236,18 +241,7 @@
     { key: 'pressure_after_bar_abs', tag: 'PMO', label: 'Pump outlet' },
     { key: 'pressure_tank_bar_abs', tag: 'PTA', label: 'Tank' },
   ];
-  const SENSOR_METADATA = [
-    { tag: 'THR', label: 'Heater internal', connected: true },
-    { tag: 'U1', label: 'Unassigned', connected: false },
-    { tag: 'TTEST', label: 'Test thermocouple', connected: true },
-    { tag: 'TFO', label: 'Flow meter outlet', connected: true },
-    { tag: 'TTI', label: 'Tank inlet', connected: true },
-    { tag: 'TNO', label: 'Nitrogen outlet', connected: true },
-    { tag: 'TTO', label: 'Tank outlet', connected: true },
-    { tag: 'TMI', label: 'Pump inlet', connected: true },
-    { tag: 'THM', label: 'HEX middle', connected: true },
-    { tag: 'THI', label: 'HEX inlet', connected: true },
-  ];
+  const SENSOR_METADATA = CHANNEL_MAP.channels;
   const CONNECTED_SENSOR_INDICES = SENSOR_METADATA.reduce((indices, meta, index) => {
     if (meta && meta.connected) {
       indices.push(index);
@@ -928,18 +922,31 @@
     }
   }
 
-  function renderHeaterState(el, onValue) {
+  function renderHeaterState(el, onValue, loop = null) {
     if (!el) {
       return;
     }
     if (onValue === null || onValue === undefined) {
       el.textContent = '—';
+      el.title = '';
       el.classList.remove('valve-open');
       el.classList.add('valve-closed');
       return;
     }
     const active = Boolean(onValue);
-    el.textContent = active ? 'On' : 'Off';
+    const auto = loop && loop.mode === 'auto';
+    let text = active ? 'On' : 'Off';
+    if (auto) {
+      const interlock = typeof loop.interlock === 'string' && loop.interlock !== 'none' ? loop.interlock : '';
+      text += interlock ? ` (auto, ${interlock.replace(/_/g, ' ')})` : ' (auto)';
+      const setpoint = Number(loop.setpoint_c);
+      el.title = Number.isFinite(setpoint)
+        ? `${loop.law === 'pi' ? 'PI' : 'Hysteresis'} to ${setpoint.toFixed(1)} °C on ${sensorShortName(Number(loop.sensor_index))}`
+        : '';
+    } else {
+      el.title = '';
+    }
+    el.textContent = text;
     el.classList.toggle('valve-open', active);
     el.classList.toggle('valve-closed', !active);
   }
@@ -1009,6 +1016,7 @@
       last_raw_counts: Number.isFinite(lastRawCounts) ? lastRawCounts : null,
       error,
       mass_kg: ready ? scale.mass_kg : null,
+      mass_filtered_kg: ready ? scale.mass_filtered_kg : null,
     };
   }
 
@@ -1090,8 +1098,8 @@
     const afterBar = pump ? finiteNumber(pump.pressure_after_bar_abs) : NaN;
     const deltaPBar =
       Number.isFinite(beforeBar) && Number.isFinite(afterBar) ? afterBar - beforeBar : NaN;
-    const lawLimitBar = rawLaw ? finiteNumber(rawLaw.limit_bar) : NaN;
-    const lawValueBar = rawLaw ? finiteNumber(rawLaw.value_bar) : NaN;
+    const lawLimitBar = rawLaw ? finiteNumber(rawLaw.limit ?? rawLaw.limit_bar) : NaN;
+    const lawValueBar = rawLaw ? finiteNumber(rawLaw.value ?? rawLaw.value_bar) : NaN;
 
     return {
       available: Boolean(safety),
@@ -1770,9 +1778,16 @@
           : 'Calibrate scale';
         setTone(overviewRsvScaleStatusEl, 'warn');
       } else {
+        const rateKgH = finiteNumber(scale.rate_kg_h);
+        const rateSigmaKgH = finiteNumber(scale.rate_sigma_kg_h);
+        const rateText = Number.isFinite(rateKgH)
+          ? `, ${(rateKgH * 1000).toFixed(1)}` +
+            (Number.isFinite(rateSigmaKgH) ? ` +/- ${(rateSigmaKgH * 1000).toFixed(1)}` : '') +
+            ' g/h'
+          : '';
         overviewRsvScaleStatusEl.textContent = Number.isFinite(rawCounts)
-          ? `receiving (raw ${rawCounts.toFixed(0)})`
-          : 'receiving';
+          ? `receiving (raw ${rawCounts.toFixed(0)}${rateText})`
+          : `receiving${rateText}`;
         setTone(overviewRsvScaleStatusEl, '');
       }
     }
@@ -1916,8 +1931,9 @@
     const heaters = data && typeof data.heaters === 'object' ? data.heaters : null;
     const bottomOn = heaters ? coerceOnOff(heaters.bottom) : null;
     const exhaustOn = heaters ? coerceOnOff(heaters.exhaust) : null;
-    renderHeaterState(heaterBottomStateEl, bottomOn);
-    renderHeaterState(heaterExhaustStateEl, exhaustOn);
+    const heaterLoops = heaters && typeof heaters.loops === 'object' ? heaters.loops : {};
+    renderHeaterState(heaterBottomStateEl, bottomOn, heaterLoops.bottom || null);
+    renderHeaterState(heaterExhaustStateEl, exhaustOn, heaterLoops.exhaust || null);
 
     const fluidLog = buildFluidTelemetryModel(fluid, pump);
     const previousEmergencyStop = pumpSafetyState.resetRequired;
@@ -0,0 +1,19 @@
+// Generated by scripts/gen_channel_map.py from config/channels.yaml; do not edit.
+'use strict';
+
+window.ORCA_CHANNEL_MAP = Object.freeze({
+  id: '58f364bf',
+  channels: Object.freeze([
+    Object.freeze({ index: 0, tag: 'THR', label: 'Heater internal', column: 'THR_C', role: 'control', connected: true }),
+    Object.freeze({ index: 1, tag: 'U1', label: 'Unassigned', column: 'U1_C', role: 'spare', connected: false }),
+    Object.freeze({ index: 2, tag: 'TTEST', label: 'Test thermocouple', column: 'TTEST_C', role: 'monitor', connected: true }),
+    Object.freeze({ index: 3, tag: 'TFO', label: 'Flow meter outlet', column: 'TFO_C', role: 'monitor', connected: true }),
+    Object.freeze({ index: 4, tag: 'TTI', label: 'Tank inlet', column: 'TTI_C', role: 'monitor', connected: true }),
+    Object.freeze({ index: 5, tag: 'TNO', label: 'Nitrogen outlet', column: 'TNO_C', role: 'control', connected: true }),
+    Object.freeze({ index: 6, tag: 'TTO', label: 'Tank outlet', column: 'TTO_C', role: 'monitor', connected: true }),
+    Object.freeze({ index: 7, tag: 'TMI', label: 'Pump inlet', column: 'TMI_C', role: 'control', connected: true }),
+    Object.freeze({ index: 8, tag: 'THM', label: 'HEX middle', column: 'THM_C', role: 'control', connected: true }),
+    Object.freeze({ index: 9, tag: 'THI', label: 'HEX inlet', column: 'THI_C', role: 'control', connected: true }),
+  ]),
+  index: Object.freeze({ THR: 0, U1: 1, TTEST: 2, TFO: 3, TTI: 4, TNO: 5, TTO: 6, TMI: 7, THM: 8, THI: 9 }),
+});
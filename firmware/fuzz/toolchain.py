@@ -0,0 +1,18 @@
+# PlatformIO pre-script for the [env:fuzz_*] targets. libFuzzer ships with
+# clang only, so the targets build with clang++ and -fsanitize=fuzzer when it
+# is on PATH. Otherwise they build with the default compiler under ASan/UBSan
+# with src/fuzz/standalone_main.cpp, which replays a corpus without mutating.
+import shutil
+
+Import("env")  # noqa: F821
+
+SANITIZERS = ["-fsanitize=address,undefined", "-fno-sanitize-recover=undefined", "-fno-omit-frame-pointer"]
+
+if shutil.which("clang++"):
+    env.Replace(CC="clang", CXX="clang++", LINK="clang++")  # noqa: F821
+    SANITIZERS.append("-fsanitize=fuzzer")
+else:
+    print("fuzz: clang++ not found, building the corpus replay driver instead of libFuzzer")
+    env.Append(CPPDEFINES=["ORCA_FUZZ_STANDALONE"])  # noqa: F821
+
+env.Append(CCFLAGS=SANITIZERS, LINKFLAGS=SANITIZERS)  # noqa: F821
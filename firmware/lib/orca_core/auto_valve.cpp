@@ -0,0 +1,77 @@
+#include "auto_valve.h"
+
+#include <math.h>
+
+AutoValveStatus autoValveInitialStatus() {
+  return { false, false, true, false, AUTO_CLOSE_MISSING_THI, NAN, NAN, NAN, NAN, NAN, NAN };
+}
+
+void updateAutoValveStatusFromValues(AutoValveStatus *status, const AutoValveTargets& targets,
+                                     float thiTemp, float hfeTempC) {
+  AutoValveStatus &s = *status;
+  s.thiTempC = thiTemp;
+  s.hfeTempC = hfeTempC;
+  s.thiValid = isfinite(thiTemp);
+  s.hfeValid = isfinite(hfeTempC);
+  s.thiCloseThresholdC = targets.hxLimitC;
+  s.hfeCloseThresholdC = targets.hfeGoalC;
+  // THI reopens when it approaches TMI within the HX approach; HFE reopen keeps hysteresis.
+  s.thiReopenThresholdC = isfinite(hfeTempC) ? (hfeTempC - targets.hxApproachC) : NAN;
+  s.hfeReopenThresholdC = targets.hfeGoalC + targets.hysteresisC;
+  s.closeRequested = false;
+  s.readyToOpen = false;
+  s.reason = AUTO_CLOSE_NONE;
+
+  if (!s.thiValid) {
+    s.closeRequested = true;
+    s.reason = AUTO_CLOSE_MISSING_THI;
+    return;
+  }
+
+  if (!s.hfeValid) {
+    s.closeRequested = true;
+    s.reason = AUTO_CLOSE_MISSING_HFE_TEMP;
+    return;
+  }
+
+  if (thiTemp <= targets.hxLimitC) {
+    s.closeRequested = true;
+    s.reason = AUTO_CLOSE_THI_LIMIT;
+    return;
+  }
+
+  if (hfeTempC <= targets.hfeGoalC) {
+    s.closeRequested = true;
+    s.reason = AUTO_CLOSE_HFE_GOAL;
+    return;
+  }
+
+  s.readyToOpen =
+    isfinite(s.thiReopenThresholdC) &&
+    thiTemp >= s.thiReopenThresholdC &&
+    hfeTempC >= s.hfeReopenThresholdC;
+}
+
+bool autoValveDecide(const AutoValveStatus& status, bool *closeLatched) {
+  if (status.closeRequested) {
+    *closeLatched = true;
+    return false;
+  }
+
+  if (*closeLatched && !status.readyToOpen) {
+    return false;
+  }
+
+  *closeLatched = false;
+  return true;
+}
+
+const char* autoCloseReasonKey(AutoCloseReason reason) {
+  switch (reason) {
+    case AUTO_CLOSE_MISSING_THI: return "missing_thi";
+    case AUTO_CLOSE_MISSING_HFE_TEMP: return "missing_hfe_temp";
+    case AUTO_CLOSE_THI_LIMIT: return "thi_limit";
+    case AUTO_CLOSE_HFE_GOAL: return "hfe_goal";
+    default: return "none";
+  }
+}
@@ -0,0 +1,49 @@
+// LN auto valve logic: THI (HX inlet) and TMI (HFE) against the auto targets.
+// Pure functions over explicit state so the control tick, the plant simulator
+// and the log replay tool all run the same decisions.
+#pragma once
+
+#include <stdint.h>
+
+enum AutoCloseReason : uint8_t {
+  AUTO_CLOSE_NONE = 0,
+  AUTO_CLOSE_MISSING_THI,
+  AUTO_CLOSE_MISSING_HFE_TEMP,
+  AUTO_CLOSE_THI_LIMIT,
+  AUTO_CLOSE_HFE_GOAL,
+};
+
+struct AutoValveTargets {
+  float hfeGoalC;
+  float hxLimitC;
+  float hxApproachC;
+  float hysteresisC;
+};
+
+struct AutoValveStatus {
+  bool thiValid;
+  bool hfeValid;
+  bool closeRequested;
+  bool readyToOpen;
+  AutoCloseReason reason;
+  float thiTempC;
+  float hfeTempC;
+  float thiCloseThresholdC;
+  float hfeCloseThresholdC;
+  float thiReopenThresholdC;
+  float hfeReopenThresholdC;
+};
+
+// Status before the first sample: closed, THI missing.
+AutoValveStatus autoValveInitialStatus();
+
+// Re-derives thresholds and the close/reopen request from two temperatures
+// (NAN = missing).
+void updateAutoValveStatusFromValues(AutoValveStatus *status, const AutoValveTargets& targets,
+                                     float thiTempC, float hfeTempC);
+
+// Close on request and stay closed (latched) until readyToOpen.
+// Returns true when the valve should be open.
+bool autoValveDecide(const AutoValveStatus& status, bool *closeLatched);
+
+const char* autoCloseReasonKey(AutoCloseReason reason);
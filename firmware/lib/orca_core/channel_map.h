@@ -0,0 +1,52 @@
+// Generated by scripts/gen_channel_map.py from config/channels.yaml; do not edit.
+//
+// Thermocouple channels in temps[] order. Telemetry carries temperatures by
+// index only; the supervisor and web UI resolve names from their own
+// generated tables, checked against TC_CHANNEL_MAP_ID.
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum TcRole : uint8_t { TC_ROLE_SPARE, TC_ROLE_MONITOR, TC_ROLE_CONTROL };
+
+struct TcChannelDef {
+  uint8_t  csPin;
+  uint8_t  tcType;    // MAX31856_TCTYPE_* (0 = B .. 7 = T)
+  TcRole   role;
+  float    gain;      // calibration default: gain * raw + offsetC
+  float    offsetC;
+  uint16_t periodMs;  // read period default, 0 = disabled
+  uint8_t  avg;       // samples averaged per conversion default
+};
+
+#define TC_CHANNEL_MAP_ID "58f364bf"
+constexpr uint32_t TC_CHANNEL_MAP_CRC = 0x58f364bfUL;  // TC_CHANNEL_MAP_ID as a number
+constexpr size_t TC_CHANNEL_COUNT = 10;
+
+constexpr uint8_t TC_CH_THR   = 0;
+constexpr uint8_t TC_CH_U1    = 1;
+constexpr uint8_t TC_CH_TTEST = 2;
+constexpr uint8_t TC_CH_TFO   = 3;
+constexpr uint8_t TC_CH_TTI   = 4;
+constexpr uint8_t TC_CH_TNO   = 5;
+constexpr uint8_t TC_CH_TTO   = 6;
+constexpr uint8_t TC_CH_TMI   = 7;
+constexpr uint8_t TC_CH_THM   = 8;
+constexpr uint8_t TC_CH_THI   = 9;
+
+constexpr TcChannelDef TC_CHANNELS[TC_CHANNEL_COUNT] = {
+  {  9, 3, TC_ROLE_CONTROL,       1.0f,       0.0f,  1000,  8 },  // U0 / THR (K)
+  {  3, 3, TC_ROLE_SPARE,         1.0f,       0.0f,     0,  1 },  // U1 / U1 (K)
+  { 23, 3, TC_ROLE_MONITOR,  1.016382f, -0.385273f,  1000,  8 },  // U2 / TTEST (K)
+  { 31, 7, TC_ROLE_MONITOR,  1.001612f, -0.625867f,  1000,  8 },  // U3 / TFO (T)
+  { 39, 7, TC_ROLE_MONITOR,  0.997152f, -0.891752f,  1000,  8 },  // U4 / TTI (T)
+  { 47, 3, TC_ROLE_CONTROL,  1.032254f, -0.728583f,  1000,  8 },  // U5 / TNO (K)
+  { 30, 7, TC_ROLE_MONITOR,  1.006183f, -0.187982f,  1000,  8 },  // U6 / TTO (T)
+  { 38, 7, TC_ROLE_CONTROL,  1.003589f, -0.195442f,   250,  2 },  // U7 / TMI (T)
+  { 46, 3, TC_ROLE_CONTROL,  0.990067f, -0.434418f,   250,  2 },  // U8 / THM (K)
+  { 48, 3, TC_ROLE_CONTROL,  1.067338f, -0.738115f,   250,  2 },  // U9 / THI (K)
+};
+
+// Contiguous CS pins for hal::thermocoupleBus() and the emulator board.
+constexpr uint8_t TC_CS_PINS[TC_CHANNEL_COUNT] = { 9, 3, 23, 31, 39, 47, 30, 38, 46, 48 };
@@ -0,0 +1,119 @@
+#include "cmd_parse.h"
+
+#include <float.h>
+#include <ctype.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+
+bool isBlank(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v';
+}
+
+// Trims blanks and copies into buf; false if empty, it does not fit or it
+// holds a NUL (strtod would stop there and ignore the rest).
+bool copyTrimmed(const char *text, size_t len, char *buf, size_t bufSize) {
+  if (!text) return false;
+  while (len && isBlank(*text)) { ++text; --len; }
+  while (len && isBlank(text[len - 1])) --len;
+  if (!len || len >= bufSize || memchr(text, '\0', len)) return false;
+  memcpy(buf, text, len);
+  buf[len] = '\0';
+  return true;
+}
+
+// Finite once narrowed: on the Mega double is float, on the host strtod's
+// double can still overflow the cast.
+bool fitsFloat(double value) {
+  return fabs(value) <= FLT_MAX;
+}
+
+}  // namespace
+
+bool parseFloatText(const char *text, size_t len, float *out) {
+  if (!out) return false;
+  char buf[CMD_FLOAT_TEXT_MAX];
+  if (!copyTrimmed(text, len, buf, sizeof(buf))) return false;
+
+  char *endPtr = nullptr;
+  const double value = strtod(buf, &endPtr);
+  if (endPtr == buf || (endPtr && *endPtr != '\0') || !fitsFloat(value)) return false;
+
+  *out = static_cast<float>(value);
+  return true;
+}
+
+bool parseFloatList(const char *text, size_t len, float values[], size_t count) {
+  if (!values || count == 0) return false;
+  char buf[CMD_FLOAT_LIST_MAX];
+  if (!copyTrimmed(text, len, buf, sizeof(buf))) return false;
+  char *cursor = buf;
+
+  for (size_t i = 0; i < count; ++i) {
+    while (*cursor == ' ' || *cursor == '\t' || *cursor == ',') ++cursor;
+    if (*cursor == '\0') return false;
+
+    char *endPtr = nullptr;
+    const double value = strtod(cursor, &endPtr);
+    if (endPtr == cursor || !fitsFloat(value)) return false;
+    values[i] = static_cast<float>(value);
+    cursor = endPtr;
+  }
+
+  while (*cursor == ' ' || *cursor == '\t' || *cursor == ',') ++cursor;
+  return *cursor == '\0';
+}
+
+CmdText CmdText::substring(size_t from) const {
+  return from < len_ ? CmdText(text_ + from, len_ - from) : CmdText(text_ + len_, 0);
+}
+
+CmdText CmdText::substring(size_t from, size_t to) const {
+  if (from > to) { const size_t t = from; from = to; to = t; }
+  if (to > len_) to = len_;
+  return from < to ? CmdText(text_ + from, to - from) : CmdText(text_ + to, 0);
+}
+
+void CmdText::trim() {
+  while (len_ && isBlank(*text_)) { ++text_; --len_; }
+  while (len_ && isBlank(text_[len_ - 1])) --len_;
+}
+
+int CmdText::indexOf(char c) const {
+  const void *hit = memchr(text_, c, len_);
+  return hit ? static_cast<int>(static_cast<const char*>(hit) - text_) : -1;
+}
+
+bool CmdText::startsWith(const char *prefix) const {
+  const size_t n = strlen(prefix);
+  return n <= len_ && memcmp(text_, prefix, n) == 0;
+}
+
+bool CmdText::endsWith(const char *suffix) const {
+  const size_t n = strlen(suffix);
+  return n <= len_ && memcmp(text_ + len_ - n, suffix, n) == 0;
+}
+
+bool CmdText::operator==(const char *text) const {
+  return strlen(text) == len_ && memcmp(text_, text, len_) == 0;
+}
+
+bool CmdText::equalsIgnoreCase(const char *text) const {
+  if (strlen(text) != len_) return false;
+  for (size_t i = 0; i < len_; ++i) {
+    if (tolower(static_cast<unsigned char>(text_[i])) != tolower(static_cast<unsigned char>(text[i]))) return false;
+  }
+  return true;
+}
+
+float CmdText::toFloat() const {
+  char buf[CMD_FLOAT_TEXT_MAX];
+  const size_t n = len_ < sizeof(buf) - 1 ? len_ : sizeof(buf) - 1;
+  memcpy(buf, text_, n);
+  buf[n] = '\0';
+  const double value = strtod(buf, nullptr);
+  if (fitsFloat(value)) return static_cast<float>(value);
+  return value > 0.0 ? INFINITY : (value < 0.0 ? -INFINITY : NAN);
+}
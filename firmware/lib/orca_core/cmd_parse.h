@@ -0,0 +1,46 @@
+// Serial command text handling: numeric argument parsing and a non-owning
+// view for splitting a command line. Works on plain character ranges so the
+// parser runs (and is fuzzed) without Arduino String, and never allocates.
+#pragma once
+
+#include <stddef.h>
+
+constexpr size_t CMD_FLOAT_TEXT_MAX = 32;  // longest single number, incl. NUL
+constexpr size_t CMD_FLOAT_LIST_MAX = 80;  // longest argument list, incl. NUL
+
+// One finite number with optional surrounding blanks and nothing else.
+bool parseFloatText(const char *text, size_t len, float *out);
+
+// Exactly `count` finite numbers separated by blanks and/or commas.
+bool parseFloatList(const char *text, size_t len, float values[], size_t count);
+
+// View of part of a command line with the String operations the command
+// handlers use. Substrings and trims only move the bounds, so a view stays
+// valid as long as the line buffer it points into.
+class CmdText {
+ public:
+  CmdText() = default;
+  CmdText(const char *text, size_t len) : text_(text), len_(len) {}
+
+  size_t length() const { return len_; }
+  const char* data() const { return text_; }
+  char operator[](size_t i) const { return i < len_ ? text_[i] : '\0'; }
+
+  // Clamped like String::substring: an empty view past the end.
+  CmdText substring(size_t from) const;
+  CmdText substring(size_t from, size_t to) const;
+  void trim();
+  void remove(size_t from) { if (from < len_) len_ = from; }
+
+  int indexOf(char c) const;
+  bool startsWith(const char *prefix) const;
+  bool endsWith(const char *suffix) const;
+  bool operator==(const char *text) const;
+  bool equalsIgnoreCase(const char *text) const;
+  // Like String::toFloat: the leading number, 0 when there is none.
+  float toFloat() const;
+
+ private:
+  const char *text_ = "";
+  size_t len_ = 0;
+};
@@ -0,0 +1,24 @@
+// Control targets and safety limits shared by the firmware and the host
+// tools that run its control logic (plant simulator, log replay).
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "channel_map.h"
+
+// ── Auto valve targets (EEPROM parameter defaults) ───────────────────────
+constexpr float DEFAULT_HFE_GOAL_C           = -110.0f; // °C, LXe reference temperature
+constexpr float DEFAULT_HX_LIMIT_C           = -120.0f; // °C, HFE icing guard at THI
+constexpr float DEFAULT_LN_AUTO_HYSTERESIS_C = 0.5f;    // °C, HFE goal reopen margin
+constexpr float DEFAULT_HX_APPROACH_C        = 10.0f;   // °C, THI reopen margin below TMI
+constexpr size_t HFE_AUTO_SENSOR_INDEX       = TC_CH_TMI;
+constexpr size_t THI_SENSOR_INDEX            = TC_CH_THI;
+
+// ── Safety law limits ────────────────────────────────────────────────────
+constexpr float   PUMP_DELTA_P_ESTOP_BAR = 8.0f;    // emergency-stop threshold for after-before pressure delta
+constexpr float   THI_FREEZE_RISK_C      = -125.0f; // THI freeze-risk law, below the auto-valve HX limit
+constexpr float   THI_FREEZE_RISK_CLEAR_C = 5.0f;   // clears once THI is back above the limit + this
+constexpr uint32_t THI_FREEZE_RISK_HOLD_MS = 60000UL; // keeps the LN valve closed at least this long
+
+constexpr uint8_t CONTROL_TICK_HZ        = 50;
@@ -0,0 +1,87 @@
+// Hardware abstraction for the portable parts of the controller firmware.
+//
+// hal_avr.cpp implements it on the Mega (Arduino core, software-SPI MAX31856);
+// hal_host.cpp implements it for [env:native] with a settable clock, pin and
+// ADC tables, in-memory UARTs and scripted thermocouples. Code under
+// lib/orca_core uses only this header, never <Arduino.h>.
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace hal {
+
+// ── Clock ────────────────────────────────────────────────────────────────
+uint32_t nowMs();
+uint32_t nowUs();
+// Called from busy-wait loops. No-op on the Mega; the host advances its
+// virtual clock so timeouts still expire.
+void idle();
+
+// ── GPIO ─────────────────────────────────────────────────────────────────
+void pinOutput(uint8_t pin);
+void pinInput(uint8_t pin);
+void pinWrite(uint8_t pin, bool high);
+bool pinRead(uint8_t pin);
+
+// ── ADC (10-bit counts, channel = Arduino analog pin) ────────────────────
+uint16_t adcRead(uint8_t pin);
+
+// ── PWM ──────────────────────────────────────────────────────────────────
+enum PwmChannel : uint8_t {
+  PWM_PUMP = 0,  // Timer4 OC4A, 2 kHz
+  PWM_CHANNEL_COUNT,
+};
+
+// duty as a 0..1 fraction of the timer period; the caller owns atomicity
+// against ISRs that also write the compare register
+void pwmWrite(PwmChannel channel, float duty);
+float pwmRead(PwmChannel channel);
+
+// ── UART streams ─────────────────────────────────────────────────────────
+class SerialPort {
+ public:
+  virtual int available() = 0;
+  virtual int read() = 0;                       // -1 when empty
+  virtual size_t write(const uint8_t *data, size_t len) = 0;
+  virtual void flush() = 0;                     // wait until TX has drained
+
+  size_t write(uint8_t byte) { return write(&byte, 1); }
+  size_t print(const char *text) { return write(reinterpret_cast<const uint8_t*>(text), strlen(text)); }
+};
+
+enum PortId : uint8_t {
+  PORT_CONSOLE = 0,  // USART0, supervisor link
+  PORT_FLOW,         // USART2, MFC400 Modbus
+  PORT_VFD,          // USART3, FRENIC-Mini Modbus
+  PORT_COUNT,
+};
+
+SerialPort& port(PortId id);
+
+// ── SPI thermocouple (MAX31856) ──────────────────────────────────────────
+struct ThermocoupleConfig {
+  uint8_t type;        // MAX31856 TC type code, 0..7 = B E J K N R S T
+  uint8_t avgSamples;  // 1, 2, 4, 8 or 16
+  bool    filter50Hz;  // false = 60 Hz rejection
+  bool    continuous;  // free-running conversions; false leaves the chip idle
+};
+
+class ThermocoupleDevice {
+ public:
+  virtual bool begin() = 0;
+  virtual void configure(const ThermocoupleConfig& config) = 0;
+  virtual float readCelsius() = 0;             // latest conversion, no validation
+  virtual float readColdJunctionC() = 0;
+  virtual uint8_t readFault() = 0;             // MAX31856 SR byte
+};
+
+// Shared software-SPI bus: one CS per chip, channel index = U number.
+void thermocoupleBus(uint8_t sckPin, uint8_t mosiPin, uint8_t misoPin,
+                     const uint8_t *csPins, uint8_t count);
+// nullptr past the count given to thermocoupleBus().
+ThermocoupleDevice* thermocouple(uint8_t channel);
+uint8_t thermocoupleCount();
+
+}  // namespace hal
@@ -0,0 +1,210 @@
+// HAL on the Arduino Mega 2560.
+#if defined(ARDUINO_ARCH_AVR)
+
+#include "channel_map.h"
+#include "hal.h"
+
+#include <Arduino.h>
+#include <Adafruit_MAX31856.h>
+
+namespace hal {
+
+uint32_t nowMs() { return millis(); }
+uint32_t nowUs() { return micros(); }
+void idle() {}
+
+void pinOutput(uint8_t pin) { pinMode(pin, OUTPUT); }
+void pinInput(uint8_t pin) { pinMode(pin, INPUT); }
+void pinWrite(uint8_t pin, bool high) { digitalWrite(pin, high ? HIGH : LOW); }
+bool pinRead(uint8_t pin) { return digitalRead(pin) == HIGH; }
+
+uint16_t adcRead(uint8_t pin) { return static_cast<uint16_t>(analogRead(pin)); }
+
+void pwmWrite(PwmChannel channel, float duty) {
+  if (channel != PWM_PUMP) return;
+  OCR4A = static_cast<uint16_t>(duty * ICR4 + 0.5f);
+}
+
+float pwmRead(PwmChannel channel) {
+  if (channel != PWM_PUMP || ICR4 == 0) return 0.0f;
+  return static_cast<float>(OCR4A) / ICR4;
+}
+
+// ── UARTs ────────────────────────────────────────────────────────────────
+namespace {
+
+class HardwareSerialPort : public SerialPort {
+ public:
+  explicit HardwareSerialPort(HardwareSerial& serial) : serial_(serial) {}
+  int available() override { return serial_.available(); }
+  int read() override { return serial_.read(); }
+  size_t write(const uint8_t *data, size_t len) override { return serial_.write(data, len); }
+  void flush() override { serial_.flush(); }
+
+ private:
+  HardwareSerial& serial_;
+};
+
+HardwareSerialPort g_console(Serial);
+HardwareSerialPort g_flow(Serial2);
+HardwareSerialPort g_vfd(Serial3);
+
+}  // namespace
+
+SerialPort& port(PortId id) {
+  switch (id) {
+    case PORT_FLOW: return g_flow;
+    case PORT_VFD:  return g_vfd;
+    default:        return g_console;
+  }
+}
+
+// ── MAX31856 on the shared software-SPI bus ──────────────────────────────
+// Registers are bit-banged here rather than through the Adafruit driver,
+// whose bus object allocates from the heap. The configuration sequence and
+// conversions follow that library (and the datasheet).
+namespace {
+
+constexpr uint8_t MAX_THERMOCOUPLES = TC_CHANNEL_COUNT;  // config/channels.yaml
+
+constexpr uint8_t REG_CR0   = 0x00;
+constexpr uint8_t REG_CR1   = 0x01;
+constexpr uint8_t REG_MASK  = 0x02;
+constexpr uint8_t REG_CJTH  = 0x0A;
+constexpr uint8_t REG_LTCBH = 0x0C;
+constexpr uint8_t REG_SR    = 0x0F;
+constexpr uint8_t REG_WRITE = 0x80;
+
+constexpr uint8_t CR0_AUTOCONVERT = 0x80;
+constexpr uint8_t CR0_ONESHOT     = 0x40;
+constexpr uint8_t CR0_OCFAULT0    = 0x10;
+constexpr uint8_t CR0_FILTER_50HZ = 0x01;
+
+struct SpiBus {
+  uint8_t sck;
+  uint8_t mosi;
+  uint8_t miso;
+};
+
+SpiBus g_tc_bus = {};
+
+// SPI mode 1: the chip shifts out on SCK rising and samples on SCK falling.
+uint8_t spiTransfer(uint8_t out) {
+  uint8_t in = 0;
+  for (uint8_t mask = 0x80; mask; mask >>= 1) {
+    digitalWrite(g_tc_bus.sck, HIGH);
+    digitalWrite(g_tc_bus.mosi, (out & mask) ? HIGH : LOW);
+    digitalWrite(g_tc_bus.sck, LOW);
+    if (digitalRead(g_tc_bus.miso) == HIGH) in |= mask;
+  }
+  return in;
+}
+
+class Max31856Device : public ThermocoupleDevice {
+ public:
+  void attach(uint8_t cs) { cs_ = cs; }
+
+  // As Adafruit_MAX31856::begin(): faults unmasked, open-circuit detection
+  // on, K type, one-shot. Software SPI cannot tell whether a chip answered.
+  bool begin() override {
+    writeRegister(REG_MASK, 0x00);
+    writeRegister(REG_CR0, CR0_OCFAULT0);
+    writeRegister(REG_CR1, (readRegister(REG_CR1) & 0xF0) | MAX31856_TCTYPE_K);
+    return true;
+  }
+
+  // Filter and averaging may only change with auto-conversion off.
+  void configure(const ThermocoupleConfig& config) override {
+    uint8_t cr0 = readRegister(REG_CR0) & static_cast<uint8_t>(~(CR0_AUTOCONVERT | CR0_ONESHOT));
+    if (config.filter50Hz) cr0 |= CR0_FILTER_50HZ;
+    else                   cr0 &= static_cast<uint8_t>(~CR0_FILTER_50HZ);
+    writeRegister(REG_CR0, cr0);
+
+    // CR1: AVGSEL (bits 6:4) and the TC type (bits 3:0).
+    uint8_t avgSel = 0;
+    while ((1U << avgSel) < config.avgSamples && avgSel < 4) ++avgSel;
+    writeRegister(REG_CR1, static_cast<uint8_t>((avgSel << 4) | (config.type & 0x0F)));
+
+    if (config.continuous) writeRegister(REG_CR0, cr0 | CR0_AUTOCONVERT);
+  }
+
+  // LTCBH..LTCBL: 19-bit signed, 2^-7 °C per LSB, left-aligned in 24 bits.
+  float readCelsius() override {
+    uint8_t b[3];
+    readRegisters(REG_LTCBH, b, sizeof(b));
+    int32_t raw = (static_cast<int32_t>(b[0]) << 16) | (static_cast<uint16_t>(b[1]) << 8) | b[2];
+    if (raw & 0x800000L) raw -= 0x1000000L;
+    return (raw >> 5) * 0.0078125f;
+  }
+
+  // CJTH..CJTL: 14-bit signed, 2^-6 °C per LSB, left-aligned in 16 bits.
+  float readColdJunctionC() override {
+    uint8_t b[2];
+    readRegisters(REG_CJTH, b, sizeof(b));
+    return static_cast<int16_t>((b[0] << 8) | b[1]) / 256.0f;
+  }
+
+  uint8_t readFault() override { return readRegister(REG_SR); }
+
+ private:
+  void select() {
+    digitalWrite(g_tc_bus.sck, LOW);
+    digitalWrite(cs_, LOW);
+  }
+
+  void deselect() { digitalWrite(cs_, HIGH); }
+
+  // Multi-byte reads auto-increment the register address.
+  void readRegisters(uint8_t reg, uint8_t *out, uint8_t len) {
+    select();
+    spiTransfer(reg & 0x7F);
+    for (uint8_t i = 0; i < len; ++i) out[i] = spiTransfer(0xFF);
+    deselect();
+  }
+
+  uint8_t readRegister(uint8_t reg) {
+    uint8_t value;
+    readRegisters(reg, &value, 1);
+    return value;
+  }
+
+  void writeRegister(uint8_t reg, uint8_t value) {
+    select();
+    spiTransfer(reg | REG_WRITE);
+    spiTransfer(value);
+    deselect();
+  }
+
+  uint8_t cs_ = 0;
+};
+
+// Fixed at link time; no driver state lives on the heap.
+Max31856Device g_tcs[MAX_THERMOCOUPLES];
+uint8_t g_tc_count = 0;
+
+}  // namespace
+
+void thermocoupleBus(uint8_t sckPin, uint8_t mosiPin, uint8_t misoPin,
+                     const uint8_t *csPins, uint8_t count) {
+  g_tc_bus = { sckPin, mosiPin, misoPin };
+  pinMode(sckPin, OUTPUT);
+  pinMode(mosiPin, OUTPUT);
+  pinMode(misoPin, INPUT);
+  if (count > MAX_THERMOCOUPLES) count = MAX_THERMOCOUPLES;
+  for (uint8_t i = 0; i < count; ++i) {
+    pinMode(csPins[i], OUTPUT);
+    digitalWrite(csPins[i], HIGH);  // deselect
+    g_tcs[i].attach(csPins[i]);
+  }
+  g_tc_count = count;
+}
+
+ThermocoupleDevice* thermocouple(uint8_t channel) {
+  return channel < g_tc_count ? &g_tcs[channel] : nullptr;
+}
+
+uint8_t thermocoupleCount() { return g_tc_count; }
+
+}  // namespace hal
+
+#endif  // ARDUINO_ARCH_AVR
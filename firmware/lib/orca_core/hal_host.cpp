@@ -0,0 +1,86 @@
+// HAL for host builds ([env:native]): deterministic, nothing touches real I/O.
+#if !defined(ARDUINO)
+
+#include "hal_host.h"
+
+namespace hal {
+
+namespace {
+
+uint64_t g_time_us = 0;
+bool     g_pin_level[host::PIN_COUNT] = {};
+uint16_t g_adc_counts[host::PIN_COUNT] = {};
+float    g_pwm_duty[PWM_CHANNEL_COUNT] = {};
+host::MemorySerialPort g_ports[PORT_COUNT];
+std::vector<host::FakeThermocouple> g_tcs;
+
+}  // namespace
+
+uint32_t nowMs() { return static_cast<uint32_t>(g_time_us / 1000U); }
+uint32_t nowUs() { return static_cast<uint32_t>(g_time_us); }
+void idle() { g_time_us += 10U; }
+
+void pinOutput(uint8_t) {}
+void pinInput(uint8_t) {}
+void pinWrite(uint8_t pin, bool high) { if (pin < host::PIN_COUNT) g_pin_level[pin] = high; }
+bool pinRead(uint8_t pin) { return pin < host::PIN_COUNT && g_pin_level[pin]; }
+
+uint16_t adcRead(uint8_t pin) { return pin < host::PIN_COUNT ? g_adc_counts[pin] : 0; }
+
+void pwmWrite(PwmChannel channel, float duty) { if (channel < PWM_CHANNEL_COUNT) g_pwm_duty[channel] = duty; }
+float pwmRead(PwmChannel channel) { return channel < PWM_CHANNEL_COUNT ? g_pwm_duty[channel] : 0.0f; }
+
+SerialPort& port(PortId id) { return host::memoryPort(id); }
+
+void thermocoupleBus(uint8_t, uint8_t, uint8_t, const uint8_t *, uint8_t count) {
+  g_tcs.resize(count);
+}
+
+ThermocoupleDevice* thermocouple(uint8_t channel) {
+  return channel < g_tcs.size() ? &g_tcs[channel] : nullptr;
+}
+
+uint8_t thermocoupleCount() { return static_cast<uint8_t>(g_tcs.size()); }
+
+namespace host {
+
+void setTimeUs(uint64_t us) { g_time_us = us; }
+void advanceUs(uint64_t us) { g_time_us += us; }
+void advanceMs(uint32_t ms) { g_time_us += static_cast<uint64_t>(ms) * 1000U; }
+uint64_t timeUs() { return g_time_us; }
+
+void setPinInput(uint8_t pin, bool high) { if (pin < PIN_COUNT) g_pin_level[pin] = high; }
+bool pinOutputLevel(uint8_t pin) { return pin < PIN_COUNT && g_pin_level[pin]; }
+void setAdcCounts(uint8_t pin, uint16_t counts) { if (pin < PIN_COUNT) g_adc_counts[pin] = counts; }
+
+int MemorySerialPort::read() {
+  if (rx_.empty()) return -1;
+  const uint8_t byte = rx_.front();
+  rx_.pop_front();
+  return byte;
+}
+
+size_t MemorySerialPort::write(const uint8_t *data, size_t len) {
+  tx_.insert(tx_.end(), data, data + len);
+  if (onWrite) onWrite(*this, data, len);
+  return len;
+}
+
+std::string MemorySerialPort::takeOutput() {
+  std::string out(tx_.begin(), tx_.end());
+  tx_.clear();
+  return out;
+}
+
+MemorySerialPort& memoryPort(PortId id) {
+  return g_ports[id < PORT_COUNT ? id : PORT_CONSOLE];
+}
+
+FakeThermocouple* fakeThermocouple(uint8_t channel) {
+  return channel < g_tcs.size() ? &g_tcs[channel] : nullptr;
+}
+
+}  // namespace host
+}  // namespace hal
+
+#endif  // !ARDUINO
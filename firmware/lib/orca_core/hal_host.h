@@ -0,0 +1,75 @@
+// Host-side controls for the [env:native] HAL: drive the clock, inputs and
+// devices from simulators, replay tools and benchmarks, and inspect outputs.
+#pragma once
+
+#if !defined(ARDUINO)
+
+#include "hal.h"
+
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace hal {
+namespace host {
+
+// Clock: time only moves when the harness advances it.
+void setTimeUs(uint64_t us);
+void advanceUs(uint64_t us);
+void advanceMs(uint32_t ms);
+uint64_t timeUs();
+
+// Pins and ADC
+constexpr uint8_t PIN_COUNT = 70;
+void setPinInput(uint8_t pin, bool high);
+bool pinOutputLevel(uint8_t pin);
+void setAdcCounts(uint8_t pin, uint16_t counts);
+
+// In-memory UART: rx is what the firmware reads, tx is what it wrote.
+class MemorySerialPort : public SerialPort {
+ public:
+  int available() override { return static_cast<int>(rx_.size()); }
+  int read() override;
+  size_t write(const uint8_t *data, size_t len) override;
+  void flush() override {}
+
+  void inject(const uint8_t *data, size_t len) { rx_.insert(rx_.end(), data, data + len); }
+  void inject(const std::string& text) { inject(reinterpret_cast<const uint8_t*>(text.data()), text.size()); }
+  std::string takeOutput();
+  const std::vector<uint8_t>& output() const { return tx_; }
+  void clear() { rx_.clear(); tx_.clear(); }
+  // Optional responder, called after each write (e.g. a Modbus slave model).
+  void (*onWrite)(MemorySerialPort& self, const uint8_t *data, size_t len) = nullptr;
+
+ private:
+  std::deque<uint8_t> rx_;
+  std::vector<uint8_t> tx_;
+};
+
+MemorySerialPort& memoryPort(PortId id);
+
+// Scripted MAX31856: returns whatever the harness last set.
+class FakeThermocouple : public ThermocoupleDevice {
+ public:
+  bool begin() override { return true; }
+  void configure(const ThermocoupleConfig& config) override { config_ = config; }
+  float readCelsius() override { ++reads; return tempC; }
+  float readColdJunctionC() override { return coldJunctionC; }
+  uint8_t readFault() override { return fault; }
+  const ThermocoupleConfig& config() const { return config_; }
+
+  float    tempC = 20.0f;
+  float    coldJunctionC = 25.0f;
+  uint8_t  fault = 0;
+  uint32_t reads = 0;
+
+ private:
+  ThermocoupleConfig config_ = {};
+};
+
+FakeThermocouple* fakeThermocouple(uint8_t channel);
+
+}  // namespace host
+}  // namespace hal
+
+#endif  // !ARDUINO
@@ -0,0 +1,105 @@
+#include "modbus_rtu.h"
+
+#include <string.h>
+
+uint16_t modbusCRC(const uint8_t *data, size_t len) {
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < len; ++i) {
+    crc ^= data[i];
+    for (uint8_t b = 0; b < 8; ++b) {
+      if (crc & 0x0001) {
+        crc >>= 1;
+        crc ^= 0xA001;
+      } else {
+        crc >>= 1;
+      }
+    }
+  }
+  return crc;
+}
+
+void modbusBuildReadRequest(uint8_t frame[MODBUS_REQUEST_LEN], uint8_t slave,
+                            uint8_t function, uint16_t startReg, uint8_t regCount) {
+  frame[0] = slave;
+  frame[1] = function;
+  frame[2] = startReg >> 8;
+  frame[3] = startReg & 0xFF;
+  frame[4] = 0x00;
+  frame[5] = regCount;
+
+  const uint16_t crc = modbusCRC(frame, 6);
+  frame[6] = crc & 0xFF;
+  frame[7] = crc >> 8;
+}
+
+bool modbusParseReadReply(const uint8_t *buf, size_t len, uint8_t slave,
+                          uint8_t function, uint8_t regCount, uint16_t *vals) {
+  // Expected reply: addr, func, byteCount (=2*N), data(2*N), CRC(2)
+  if (!buf || regCount == 0 || regCount > MODBUS_MAX_READ_REGS) return false;
+  if (len != 3U + 2U * regCount + 2U) return false;
+
+  const uint16_t crcResp = static_cast<uint16_t>(buf[len - 1] << 8) | buf[len - 2];
+  if (crcResp != modbusCRC(buf, len - 2)) return false;
+
+  if (buf[0] != slave || buf[1] != function) return false;
+  if (buf[2] != 2 * regCount) return false;
+
+  for (uint8_t i = 0; i < regCount; ++i) {
+    vals[i] = static_cast<uint16_t>(buf[3 + 2 * i] << 8) | buf[4 + 2 * i];
+  }
+  return true;
+}
+
+bool modbusReadRegisters(hal::SerialPort& port, uint8_t slave, uint8_t function,
+                         uint16_t startReg, uint8_t regCount, uint16_t *vals,
+                         uint32_t timeoutMs) {
+  if (regCount == 0 || regCount > MODBUS_MAX_READ_REGS) return false;
+
+  uint8_t frame[MODBUS_REQUEST_LEN];
+  modbusBuildReadRequest(frame, slave, function, startReg, regCount);
+
+  while (port.available()) port.read();  // clear stale bytes
+
+  port.write(frame, sizeof(frame));
+  port.flush();
+
+  const uint8_t expectedLen = 3 + 2 * regCount + 2;
+  uint8_t buf[MODBUS_REPLY_MAX];
+  uint8_t len = 0;
+  const uint32_t start = hal::nowMs();
+
+  while ((hal::nowMs() - start) < timeoutMs && len < expectedLen) {
+    if (port.available()) {
+      buf[len++] = static_cast<uint8_t>(port.read());
+    } else {
+      hal::idle();
+    }
+  }
+
+  return modbusParseReadReply(buf, len, slave, function, regCount, vals);
+}
+
+float regsToFloatBE(const uint16_t *regs) {
+  const uint32_t bits = (static_cast<uint32_t>(regs[0]) << 16) | regs[1];
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+float vfdDecodeFormat19CurrentA(uint16_t raw) {
+  return raw / 100.0f;
+}
+
+float vfdDecodeFormat24(uint16_t raw) {
+  const uint16_t exponent = (raw >> 14) & 0x0003;
+  const uint16_t mantissa = raw & 0x3FFF;
+  if (mantissa == 0) return 0.0f;
+
+  const float value = static_cast<float>(mantissa);
+  switch (exponent) {
+    case 0: return value * 0.01f;
+    case 1: return value * 0.1f;
+    case 2: return value;
+    default: return value * 10.0f;
+  }
+}
@@ -0,0 +1,41 @@
+// Modbus RTU master helpers shared by the VFD (FRENIC-Mini) and flow meter
+// (MFC400) pollers: CRC, request framing, reply validation and register decoding.
+#pragma once
+
+#include "hal.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+constexpr uint8_t MODBUS_FC_READ_HOLDING = 0x03;
+constexpr uint8_t MODBUS_FC_READ_INPUT   = 0x04;
+constexpr uint8_t MODBUS_REQUEST_LEN     = 8;
+constexpr uint8_t MODBUS_REPLY_MAX       = 32;                       // receive buffer
+constexpr uint8_t MODBUS_MAX_READ_REGS   = (MODBUS_REPLY_MAX - 5) / 2;  // 13
+
+uint16_t modbusCRC(const uint8_t *data, size_t len);
+
+// Read request: addr, fc, start (BE), count (BE), CRC (LE).
+void modbusBuildReadRequest(uint8_t frame[MODBUS_REQUEST_LEN], uint8_t slave,
+                            uint8_t function, uint16_t startReg, uint8_t regCount);
+
+// Validates a complete read reply (length, CRC, address, function, byte count)
+// and unpacks big-endian registers into vals[regCount].
+bool modbusParseReadReply(const uint8_t *buf, size_t len, uint8_t slave,
+                          uint8_t function, uint8_t regCount, uint16_t *vals);
+
+// One blocking transaction: flush stale RX, send, collect the reply until
+// it is complete or timeoutMs passes, then validate.
+bool modbusReadRegisters(hal::SerialPort& port, uint8_t slave, uint8_t function,
+                         uint16_t startReg, uint8_t regCount, uint16_t *vals,
+                         uint32_t timeoutMs);
+
+// MFC400 C6.8.4 defaults to Big Endian for multi-register values.
+float regsToFloatBE(const uint16_t *regs);
+
+// FRENIC RTU data format [19]: current in 0.01 A steps.
+float vfdDecodeFormat19CurrentA(uint16_t raw);
+
+// FRENIC RTU data format [24]: 2-bit exponent + 14-bit mantissa floating point.
+// Exponent 0..3 maps to decimal shifts of 10^-2, 10^-1, 10^0, 10^1.
+float vfdDecodeFormat24(uint16_t raw);
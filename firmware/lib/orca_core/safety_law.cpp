@@ -0,0 +1,76 @@
+#include "safety_law.h"
+
+#include <math.h>
+
+// Rate over at least SAFETY_RATE_WINDOW_MS of sample time, so slow signals are not
+// differentiated across a single 1 Hz step and fast ADC noise is not amplified.
+static void updateSafetyLawRate(SafetyLawState &law, float value, uint32_t sampleMs) {
+  if (!isfinite(law.rateLimitPerS)) return;
+  if (!isfinite(value) || sampleMs == 0) {
+    law.ratePerS = NAN;
+    law.rateRefValue = NAN;
+    return;
+  }
+  if (!isfinite(law.rateRefValue)) {
+    law.rateRefValue = value;
+    law.rateRefMs = sampleMs;
+    return;
+  }
+  const uint32_t dtMs = sampleMs - law.rateRefMs;
+  if (dtMs < SAFETY_RATE_WINDOW_MS) return;
+  law.ratePerS = (value - law.rateRefValue) * 1000.0f / dtMs;
+  law.rateRefValue = value;
+  law.rateRefMs = sampleMs;
+}
+
+bool safetyLawCondition(SafetyLawState &law, float value, uint32_t sampleMs, uint32_t nowMs) {
+  const float band = law.active && isfinite(law.clearBand) ? law.clearBand : 0.0f;
+  if (law.compare == SAFETY_STALE) {
+    law.value = (sampleMs ? (nowMs - sampleMs) : nowMs) / 1000.0f;
+    return law.value > law.limit - band;
+  }
+
+  law.value = value;
+  updateSafetyLawRate(law, value, sampleMs);
+  if (!isfinite(value)) return false;
+
+  const bool above = law.compare == SAFETY_ABOVE;
+  if (above ? (value > law.limit - band) : (value < law.limit + band)) return true;
+  if (isfinite(law.rateLimitPerS) && isfinite(law.ratePerS)) {
+    return above ? (law.ratePerS > law.rateLimitPerS) : (law.ratePerS < -law.rateLimitPerS);
+  }
+  return false;
+}
+
+SafetyLawEvent safetyLawStep(SafetyLawState &law, bool condition, uint32_t nowMs, uint8_t *actions) {
+  const bool wasActive = law.active;
+  SafetyLawEvent event = SAFETY_EVENT_NONE;
+
+  if (!law.enabled) {
+    law.pending = false;
+    law.active = false;
+  } else if (!condition) {
+    law.pending = false;
+    const bool held = law.latch == SAFETY_AUTO_RESET && wasActive && (nowMs - law.activeSinceMs) < law.holdMs;
+    law.active = held;
+  } else {
+    if (!law.pending) {
+      law.pending = true;
+      law.pendingSinceMs = nowMs;
+    }
+    law.active = wasActive || (nowMs - law.pendingSinceMs) >= law.persistMs;
+  }
+  if (law.active && !wasActive) law.activeSinceMs = nowMs;
+
+  if (law.latch == SAFETY_LATCH) {
+    if (law.active && !law.tripped) {
+      law.tripped = true;
+      event = SAFETY_EVENT_TRIPPED;
+    }
+    if (law.tripped) *actions |= law.actions;
+  } else {
+    if (law.active != wasActive) event = SAFETY_EVENT_CHANGED;
+    if (law.active) *actions |= law.actions;
+  }
+  return event;
+}
@@ -0,0 +1,80 @@
+// Safety law evaluation: one signal against a limit, with optional persistence
+// time and rate-of-change limit, mapped to a set of actions. Auto-reset laws
+// clear only past a clear band and after a minimum hold, so a signal sitting on
+// the limit does not cycle the outputs. The law table and
+// the signal sources live with the caller (the control tick, the simulator);
+// this is the per-law arithmetic they share.
+#pragma once
+
+#include <stdint.h>
+
+enum SafetySignal : uint8_t {
+  SAFETY_SIGNAL_TC = 0,               // channel selects the thermocouple
+  SAFETY_SIGNAL_PRESSURE_BEFORE_BAR,
+  SAFETY_SIGNAL_PRESSURE_AFTER_BAR,
+  SAFETY_SIGNAL_PRESSURE_TANK_BAR,
+  SAFETY_SIGNAL_DELTA_P_BAR,
+  SAFETY_SIGNAL_FLOW_MASS_KGS,        // polled signals from here on are published by loop()
+  SAFETY_SIGNAL_VFD_CURRENT_A,
+  SAFETY_SIGNAL_VFD_POWER_W,
+  SAFETY_SIGNAL_RSV_MASS_KG,
+  SAFETY_SIGNAL_COUNT,
+};
+
+enum SafetyCompare : uint8_t {
+  SAFETY_ABOVE = 0,
+  SAFETY_BELOW,
+  SAFETY_STALE,  // no valid sample for longer than the limit (seconds)
+};
+
+enum SafetyAction : uint8_t {
+  SAFETY_ACTION_PUMP_STOP   = 0x01,
+  SAFETY_ACTION_VALVE_CLOSE = 0x02,
+  SAFETY_ACTION_HEATERS_OFF = 0x04,
+};
+
+enum SafetyLatch : uint8_t { SAFETY_LATCH = 0, SAFETY_AUTO_RESET = 1 };
+
+constexpr uint32_t SAFETY_RATE_WINDOW_MS = 250UL;  // min spacing of rate-of-change samples
+
+struct SafetyLawState {
+  const char*   key;
+  const char*   label;
+  SafetySignal  signal;
+  uint8_t       channel;
+  SafetyCompare compare;
+  bool          enabled;
+  float         limit;
+  float         rateLimitPerS;  // NAN disables the rate-of-change check
+  uint32_t      persistMs;
+  uint8_t       actions;
+  SafetyLatch   latch;
+  float         clearBand;      // auto-reset: clears once back past the limit by this much
+  uint32_t      holdMs;         // auto-reset: stays active at least this long
+  // Runtime state
+  bool          active;
+  bool          tripped;
+  bool          pending;        // condition true, waiting out persistMs
+  float         value;
+  float         ratePerS;
+  float         rateRefValue;
+  uint32_t      rateRefMs;
+  uint32_t      pendingSinceMs;
+  uint32_t      activeSinceMs;
+};
+
+enum SafetyLawEvent : uint8_t {
+  SAFETY_EVENT_NONE = 0,
+  SAFETY_EVENT_TRIPPED,   // latching law tripped; the caller latches the emergency stop
+  SAFETY_EVENT_CHANGED,   // auto-reset law became active or cleared
+};
+
+// Whether the law's condition holds for a sample taken at sampleMs (0 = never
+// sampled, value NAN = invalid). Updates law.value and the rate estimate. An
+// active law compares against the limit moved out by clearBand.
+bool safetyLawCondition(SafetyLawState &law, float value, uint32_t sampleMs, uint32_t nowMs);
+
+// Applies enable, persistence, the auto-reset hold and latching for one
+// evaluation pass and ORs the law's actions into *actions while it holds them.
+// Disabling a law releases it immediately.
+SafetyLawEvent safetyLawStep(SafetyLawState &law, bool condition, uint32_t nowMs, uint8_t *actions);
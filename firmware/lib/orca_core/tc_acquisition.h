@@ -0,0 +1,151 @@
+// Thermocouple acquisition engine: per-channel read scheduling, fault
+// accounting and the cold-junction round robin over hal::ThermocoupleDevice.
+//
+// The channel count is a template parameter (TC_CHANNEL_COUNT on the Mega),
+// so every per-channel array is sized at compile time with no heap, and each
+// call touches each channel at most once: nextDue() is one scan, a read or a
+// cold-junction read is one channel. The caller owns the chips' configuration
+// and hands the engine the resulting read period through schedule().
+#pragma once
+
+#include "hal.h"
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Per-channel diagnostics cached by each read and reported in tc_diag.
+struct TcDiag {
+  float    cjC;                 // last cold-junction reading
+  uint32_t cjMs;
+  uint8_t  fault;               // fault register at the last read
+  uint8_t  faultsSeen;          // OR of every fault byte since the last report
+  uint16_t consecutiveFaults;   // reads in a row with a fault or a rejected value
+  uint16_t maxConsecutiveFaults;
+  uint32_t faultReads;          // total faulted reads since boot
+  uint32_t lastGoodMs;
+};
+
+struct TcAcquisition {
+  uint32_t dueMs;
+  uint32_t lastReadMs;
+  float    rawC;
+  uint16_t periodMs;      // effective read period, 0 = disabled
+  uint16_t windowReads;   // reads since the last closeRateWindow()
+  float    rateHz;        // measured over the last window
+};
+
+template <size_t N>
+class TcAcquisitionEngine {
+  static_assert(N > 0 && N <= 255, "channels are indexed by uint8_t");
+
+ public:
+  static constexpr size_t CHANNELS = N;
+  static constexpr uint8_t STALE_PERIODS = 3;  // a reading expires after this many periods
+
+  void attach(uint8_t ch, hal::ThermocoupleDevice *dev) {
+    if (ch < N) devices_[ch] = dev;
+  }
+  hal::ThermocoupleDevice* device(uint8_t ch) const { return ch < N ? devices_[ch] : nullptr; }
+
+  // After (re)configuring a chip: drop the cached reading and read every
+  // periodMs from firstDueMs (0 or no device disables the channel).
+  void schedule(uint8_t ch, uint16_t periodMs, uint32_t firstDueMs) {
+    if (ch >= N) return;
+    TcAcquisition &acq = acq_[ch];
+    acq.periodMs = devices_[ch] ? periodMs : 0;
+    acq.rawC = NAN;
+    acq.lastReadMs = 0;
+    acq.dueMs = firstDueMs;
+  }
+
+  // The most overdue enabled channel, with its next read scheduled; -1 when
+  // every channel is disabled. A late channel does not catch up in a burst.
+  int nextDue(uint32_t nowMs) {
+    int pick = -1;
+    int32_t pickLateMs = -1;
+    for (size_t ch = 0; ch < N; ++ch) {
+      if (!acq_[ch].periodMs) continue;
+      const int32_t lateMs = static_cast<int32_t>(nowMs - acq_[ch].dueMs);
+      if (lateMs > pickLateMs) {
+        pick = static_cast<int>(ch);
+        pickLateMs = lateMs;
+      }
+    }
+    if (pick < 0) return -1;
+    TcAcquisition &acq = acq_[pick];
+    acq.dueMs += acq.periodMs;
+    if (static_cast<int32_t>(nowMs - acq.dueMs) >= 0) acq.dueMs = nowMs + acq.periodMs;
+    return pick;
+  }
+
+  // Reads one chip; the validated °C, or NAN on a fault, an implausible value
+  // or a missing device.
+  float read(uint8_t ch, uint32_t nowMs) {
+    if (ch >= N) return NAN;
+    TcAcquisition &acq = acq_[ch];
+    acq.rawC = readValidated(ch, nowMs);
+    acq.lastReadMs = nowMs;
+    ++acq.windowReads;
+    return acq.rawC;
+  }
+
+  // One channel's cold junction per call, round robin.
+  void readNextColdJunction(uint32_t nowMs) {
+    const uint8_t ch = cjNext_;
+    cjNext_ = static_cast<uint8_t>((ch + 1) % N);
+    if (!devices_[ch]) return;
+    const float cj = devices_[ch]->readColdJunctionC();
+    diag_[ch].cjC = (isfinite(cj) && cj > -65.0f && cj < 150.0f) ? cj : NAN;
+    diag_[ch].cjMs = nowMs;
+  }
+
+  // Latest reading, or NAN once disabled or not refreshed for STALE_PERIODS
+  // periods (plus the caller's poll interval).
+  float latest(uint8_t ch, uint32_t nowMs, uint32_t pollMs) const {
+    if (ch >= N) return NAN;
+    const TcAcquisition &acq = acq_[ch];
+    const bool fresh = acq.periodMs && acq.lastReadMs &&
+                       nowMs - acq.lastReadMs <= static_cast<uint32_t>(acq.periodMs) * STALE_PERIODS + pollMs;
+    return fresh ? acq.rawC : NAN;
+  }
+
+  // Turns the reads since the last call into rateHz.
+  void closeRateWindow(uint32_t nowMs) {
+    const uint32_t windowMs = nowMs - rateWindowMs_;
+    rateWindowMs_ = nowMs;
+    for (size_t ch = 0; ch < N; ++ch) {
+      if (windowMs) acq_[ch].rateHz = acq_[ch].windowReads * 1000.0f / windowMs;
+      acq_[ch].windowReads = 0;
+    }
+  }
+
+  const TcAcquisition& acquisition(uint8_t ch) const { return acq_[ch < N ? ch : 0]; }
+  TcDiag& diag(uint8_t ch) { return diag_[ch < N ? ch : 0]; }
+
+ private:
+  float readValidated(uint8_t ch, uint32_t nowMs) {
+    hal::ThermocoupleDevice *dev = devices_[ch];
+    if (!dev) return NAN;
+    TcDiag &diag = diag_[ch];
+    const float t = dev->readCelsius();
+    const uint8_t f = dev->readFault();
+    diag.fault = f;
+    diag.faultsSeen |= f;
+    if (f || !isfinite(t) || t < -200.0f || t > 1370.0f) {  // OPEN/other faults, sanity
+      ++diag.faultReads;
+      if (diag.consecutiveFaults < 0xFFFF) ++diag.consecutiveFaults;
+      if (diag.consecutiveFaults > diag.maxConsecutiveFaults) diag.maxConsecutiveFaults = diag.consecutiveFaults;
+      return NAN;
+    }
+    diag.consecutiveFaults = 0;
+    diag.lastGoodMs = nowMs;
+    return t;
+  }
+
+  hal::ThermocoupleDevice *devices_[N] = {};
+  TcDiag        diag_[N] = {};
+  TcAcquisition acq_[N] = {};
+  uint8_t       cjNext_ = 0;
+  uint32_t      rateWindowMs_ = 0;
+};
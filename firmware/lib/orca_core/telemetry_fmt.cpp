@@ -0,0 +1,61 @@
+#include "telemetry_fmt.h"
+
+#include <math.h>
+
+size_t formatJsonFloat(char *buf, float value, uint8_t digits) {
+  // Same limits and rounding as Arduino's Print::printFloat.
+  if (!isfinite(value) || value > 4294967040.0f || value < -4294967040.0f) {
+    memcpy(buf, "null", 5);
+    return 4;
+  }
+  if (digits > 7) digits = 7;
+
+  size_t len = 0;
+  double number = value;
+  if (number < 0.0) {
+    buf[len++] = '-';
+    number = -number;
+  }
+
+  double rounding = 0.5;
+  for (uint8_t i = 0; i < digits; ++i) rounding /= 10.0;
+  number += rounding;
+
+  unsigned long intPart = static_cast<unsigned long>(number);
+  double remainder = number - static_cast<double>(intPart);
+
+  char digitsRev[10];
+  uint8_t n = 0;
+  do {
+    digitsRev[n++] = static_cast<char>('0' + intPart % 10);
+    intPart /= 10;
+  } while (intPart);
+  while (n) buf[len++] = digitsRev[--n];
+
+  if (digits > 0) buf[len++] = '.';
+  while (digits-- > 0) {
+    remainder *= 10.0;
+    const unsigned int toPrint = static_cast<unsigned int>(remainder);
+    buf[len++] = static_cast<char>('0' + toPrint);
+    remainder -= toPrint;
+  }
+  buf[len] = '\0';
+  return len;
+}
+
+size_t printJsonFloat(hal::SerialPort& out, float value, uint8_t digits) {
+  char buf[TELEMETRY_NUMBER_MAX];
+  const size_t len = formatJsonFloat(buf, value, digits);
+  return out.write(reinterpret_cast<const uint8_t*>(buf), len);
+}
+
+size_t printJsonFloatArray(hal::SerialPort& out, const float *values, size_t count, uint8_t digits) {
+  char buf[TELEMETRY_NUMBER_MAX + 2];
+  size_t written = out.write('[');
+  for (size_t i = 0; i < count; ++i) {
+    size_t len = formatJsonFloat(buf, values ? values[i] : NAN, digits);
+    if (i + 1 < count) buf[len++] = ',';
+    written += out.write(reinterpret_cast<const uint8_t*>(buf), len);
+  }
+  return written + out.write(']');
+}
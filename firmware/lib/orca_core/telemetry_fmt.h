@@ -0,0 +1,18 @@
+// JSON number formatting for telemetry lines, byte-identical to Arduino
+// Print::print(double, digits) for finite values. Non-finite values print as
+// null, which is what every telemetry field wants.
+#pragma once
+
+#include "hal.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Formats into buf (NUL-terminated) and returns the length; buf needs 24 bytes.
+constexpr size_t TELEMETRY_NUMBER_MAX = 24;
+size_t formatJsonFloat(char *buf, float value, uint8_t digits);
+
+size_t printJsonFloat(hal::SerialPort& out, float value, uint8_t digits);
+
+// [v0,v1,...] with null for non-finite entries; one write per element.
+size_t printJsonFloatArray(hal::SerialPort& out, const float *values, size_t count, uint8_t digits);
@@ -0,0 +1,356 @@
+// [env:bench] cycle-counted micro-benchmarks of the firmware hot paths, run on
+// the Mega (or under [env:emu], which is cycle-exact):
+//
+//   pio run -e bench -t upload && python3 scripts/firmware_bench.py --port /dev/ttyACM0
+//   .pio/build/emu/program --duration 30s .pio/build/bench/firmware.elf | python3 scripts/firmware_bench.py --input -
+//
+// Timer1 (unused by the controller) free-runs at clk/1 with an overflow count
+// as a 32-bit cycle counter. Timer0 is stopped while a case runs so the
+// millis() ISR does not land inside measurements; the console is flushed
+// before each case for the same reason. Every case is timed per call and
+// reported as the minimum (the repeatable figure the baseline compares) and
+// the mean, less the cost of timing an empty call.
+//
+// Cases use the lib/orca_core code the controller links, with the
+// controller's inputs: Modbus frames as polled from the VFD and MFC400,
+// command lines through the same CmdText front end handleCommand() uses,
+// the two 10-channel temperature arrays of a telemetry frame (formatted into
+// a discarding port, so UART time is excluded), a MAX31856 reading over
+// the software-SPI bus exactly as the acquisition engine issues it, and the
+// engine's schedule scan over TC_CHANNEL_COUNT channels. The SPI case times
+// the bus traffic, so it needs no chip on U0.
+//
+// Prints one {"type":"bench"} JSON line per case and a final
+// {"type":"bench_done"} line, then repeats every BENCH_REPEAT_MS.
+#include <Arduino.h>
+#include <Adafruit_MAX31856.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "auto_valve.h"
+#include "cmd_parse.h"
+#include "control_defaults.h"
+#include "hal.h"
+#include "modbus_rtu.h"
+#include "safety_law.h"
+#include "tc_acquisition.h"
+#include "telemetry_fmt.h"
+
+#include <math.h>
+#include <string.h>
+
+namespace {
+
+constexpr unsigned long BENCH_REPEAT_MS = 10000UL;
+
+// Controller wiring for U0 (main.cpp).
+constexpr uint8_t TC_SCK = 8, TC_MOSI = 2, TC_MISO = 22;
+constexpr uint8_t TC_CS[1] = { 9 };
+
+// ── Cycle counter ────────────────────────────────────────────────────────
+volatile uint16_t g_t1_overflows = 0;
+
+void cycleCounterBegin() {
+  TCCR1A = 0;
+  TCCR1B = 0;
+  TCNT1 = 0;
+  TIFR1 = _BV(TOV1);
+  TIMSK1 = _BV(TOIE1);
+  TCCR1B = _BV(CS10);  // clk/1
+}
+
+// Same overflow-pending correction as micros().
+uint32_t cyclesNow() {
+  const uint8_t sreg = SREG;
+  cli();
+  const uint16_t count = TCNT1;
+  uint16_t overflows = g_t1_overflows;
+  if ((TIFR1 & _BV(TOV1)) && count < 0x8000) ++overflows;
+  SREG = sreg;
+  return (static_cast<uint32_t>(overflows) << 16) | count;
+}
+
+// ── Inputs and sinks ─────────────────────────────────────────────────────
+volatile uint16_t g_sink16;
+volatile float g_sinkF;
+volatile bool g_sinkB;
+
+// FC03 request for M09..M12 and a FC04 MFC400 reply (5 BE floats), the
+// largest frame the controller validates.
+uint8_t g_vfd_request[MODBUS_REQUEST_LEN];
+uint8_t g_flow_reply[5 + 20];
+uint16_t g_flow_regs[10];
+volatile uint16_t g_w21_raw = 0x4123;  // format 24, exponent 1
+
+float g_temps[10] = { 21.37f, 22.05f, -183.6f, -190.02f, 24.9f, NAN, 23.12f, 19.5f, 65.25f, 58.0f };
+float g_temps_raw[10] = { 21.41f, 22.1f, -183.44f, -190.2f, 24.87f, NAN, 23.0f, 19.62f, 65.3f, 57.91f };
+
+const char AUTO_TARGETS_ARGS[] = " -95.0, -120.5, 12.0, 1.5";
+const char AUTO_TARGETS_LINE[] = "auto targets -95.0, -120.5, 12.0, 1.5\r";
+const char PUMP_LINE[] = "PUMP 42.5%\r";
+
+AutoValveStatus g_auto_status;
+bool g_auto_latched = false;
+uint8_t g_auto_step = 0;
+SafetyLawState g_law;
+uint32_t g_law_now_ms = 0;
+
+hal::ThermocoupleDevice *g_tc = nullptr;
+TcAcquisitionEngine<TC_CHANNEL_COUNT> g_tc_engine;  // every channel on U0
+uint32_t g_tc_now_ms = 0;
+
+// Telemetry formatting without the UART.
+class NullPort : public hal::SerialPort {
+ public:
+  int available() override { return 0; }
+  int read() override { return -1; }
+  size_t write(const uint8_t *, size_t len) override { return len; }
+  void flush() override {}
+};
+
+NullPort g_null_port;
+
+void setupInputs() {
+  modbusBuildReadRequest(g_vfd_request, 1, MODBUS_FC_READ_HOLDING, 0x0809, 4);
+
+  const float flow[5] = { 1.25f, 8.4e-5f, 0.12f, -180.5f, 1430.0f };
+  g_flow_reply[0] = 1;
+  g_flow_reply[1] = MODBUS_FC_READ_INPUT;
+  g_flow_reply[2] = 20;
+  for (uint8_t i = 0; i < 5; ++i) {
+    uint32_t bits;
+    memcpy(&bits, &flow[i], sizeof(bits));
+    for (uint8_t b = 0; b < 4; ++b) g_flow_reply[3 + 4 * i + b] = static_cast<uint8_t>(bits >> (24 - 8 * b));
+  }
+  const uint16_t crc = modbusCRC(g_flow_reply, 23);
+  g_flow_reply[23] = static_cast<uint8_t>(crc & 0xFF);
+  g_flow_reply[24] = static_cast<uint8_t>(crc >> 8);
+  modbusParseReadReply(g_flow_reply, sizeof(g_flow_reply), 1, MODBUS_FC_READ_INPUT, 10, g_flow_regs);
+
+  g_auto_status = autoValveInitialStatus();
+
+  memset(&g_law, 0, sizeof(g_law));
+  g_law.key = "hfe_over";
+  g_law.signal = SAFETY_SIGNAL_TC;
+  g_law.compare = SAFETY_ABOVE;
+  g_law.enabled = true;
+  g_law.limit = 40.0f;
+  g_law.rateLimitPerS = 5.0f;
+  g_law.persistMs = 2000;
+  g_law.actions = SAFETY_ACTION_PUMP_STOP | SAFETY_ACTION_HEATERS_OFF;
+  g_law.latch = SAFETY_LATCH;
+
+  hal::thermocoupleBus(TC_SCK, TC_MOSI, TC_MISO, TC_CS, 1);
+  g_tc = hal::thermocouple(0);
+  if (g_tc) {
+    g_tc->begin();
+    g_tc->configure({ MAX31856_TCTYPE_K, 1, true, true });  // K, no averaging, 50 Hz, continuous
+  }
+  for (uint8_t ch = 0; ch < TC_CHANNEL_COUNT; ++ch) {
+    g_tc_engine.attach(ch, g_tc);
+    g_tc_engine.schedule(ch, TC_CHANNELS[ch].periodMs ? TC_CHANNELS[ch].periodMs : 1000, ch);
+  }
+}
+
+// ── Cases ────────────────────────────────────────────────────────────────
+void benchEmpty() {}
+
+void benchCrcRequest() { g_sink16 = modbusCRC(g_vfd_request, 6); }
+
+void benchCrcReply() { g_sink16 = modbusCRC(g_flow_reply, 23); }
+
+void benchParseFlowReply() {
+  uint16_t regs[10];
+  g_sinkB = modbusParseReadReply(g_flow_reply, sizeof(g_flow_reply), 1, MODBUS_FC_READ_INPUT, 10, regs);
+}
+
+void benchRegsToFloat() {
+  float sum = 0.0f;
+  for (uint8_t i = 0; i < 5; ++i) sum += regsToFloatBE(&g_flow_regs[2 * i]);
+  g_sinkF = sum;
+}
+
+void benchFormat24() { g_sinkF = vfdDecodeFormat24(g_w21_raw); }
+
+void benchParseFloatText() {
+  float value;
+  g_sinkB = parseFloatText(" -120.5", 7, &value);
+  g_sinkF = value;
+}
+
+void benchParseFloatList() {
+  float values[4];
+  g_sinkB = parseFloatList(AUTO_TARGETS_ARGS, sizeof(AUTO_TARGETS_ARGS) - 1, values, 4);
+  g_sinkF = values[3];
+}
+
+// handleCommand() front end: trim, upper-case copy, prefix match, then
+// parseFloatArgs() over the original text.
+char g_upper[64];  // CMD_LINE_MAX
+
+CmdText upperCopy(const CmdText& cmd) {
+  for (size_t i = 0; i < cmd.length(); ++i) g_upper[i] = static_cast<char>(toupper(cmd[i]));
+  return CmdText(g_upper, cmd.length());
+}
+
+void benchCommandAutoTargets() {
+  CmdText cmd(AUTO_TARGETS_LINE, sizeof(AUTO_TARGETS_LINE) - 1);
+  cmd.trim();
+  const CmdText upper = upperCopy(cmd);
+  float values[4] = { NAN, NAN, NAN, NAN };
+  g_sinkB = upper.startsWith("AUTO TARGETS") &&
+            parseFloatList(cmd.data() + 12, cmd.length() - 12, values, 4);
+  g_sinkF = values[0];
+}
+
+void benchCommandPump() {
+  CmdText cmd(PUMP_LINE, sizeof(PUMP_LINE) - 1);
+  cmd.trim();
+  const CmdText upper = upperCopy(cmd);
+  if (!upper.startsWith("PUMP")) return;
+  CmdText rest = cmd.substring(4);
+  rest.trim();
+  CmdText restUpper = upper.substring(4);
+  restUpper.trim();
+  if (rest.endsWith("%")) rest.remove(rest.length() - 1);
+  g_sinkB = restUpper.startsWith("HZ");
+  g_sinkF = rest.toFloat();
+}
+
+void benchJsonFloat() {
+  char buf[TELEMETRY_NUMBER_MAX];
+  g_sink16 = static_cast<uint16_t>(formatJsonFloat(buf, -183.6f, 2));
+}
+
+// The two per-channel arrays that dominate emitTelemetry()'s formatting.
+void benchTelemetryTemps() {
+  size_t n = printJsonFloatArray(g_null_port, g_temps, 10, 2);
+  n += printJsonFloatArray(g_null_port, g_temps_raw, 10, 2);
+  g_sink16 = static_cast<uint16_t>(n);
+}
+
+void benchTcReadCelsius() {
+  if (!g_tc) return;
+  g_sinkF = g_tc->readCelsius();
+  g_sink16 = g_tc->readFault();
+}
+
+// One pick of taskTcAcquire(): the scan for the most overdue channel.
+void benchTcNextDue() {
+  g_tc_now_ms += 20;  // TC_POLL_MS
+  g_sink16 = static_cast<uint16_t>(g_tc_engine.nextDue(g_tc_now_ms));
+}
+
+// Alternates THI across the close threshold so both branches run.
+void benchAutoValve() {
+  const AutoValveTargets targets = {
+    DEFAULT_HFE_GOAL_C, DEFAULT_HX_LIMIT_C, DEFAULT_HX_APPROACH_C, DEFAULT_LN_AUTO_HYSTERESIS_C,
+  };
+  const float thi = (++g_auto_step & 1) ? DEFAULT_HX_LIMIT_C - 20.0f : DEFAULT_HX_LIMIT_C + 5.0f;
+  updateAutoValveStatusFromValues(&g_auto_status, targets, thi, DEFAULT_HFE_GOAL_C + 10.0f);
+  g_sinkB = autoValveDecide(g_auto_status, &g_auto_latched);
+}
+
+// One law per 20 ms tick with the rate estimate live.
+void benchSafetyLaw() {
+  g_law_now_ms += 20;
+  uint8_t actions = 0;
+  const float value = 30.0f + 0.01f * static_cast<float>(g_law_now_ms & 0x3FF);
+  const bool condition = safetyLawCondition(g_law, value, g_law_now_ms, g_law_now_ms);
+  g_sink16 = safetyLawStep(g_law, condition, g_law_now_ms, &actions) | actions;
+}
+
+struct BenchCase {
+  const char *key;
+  void (*fn)();
+  uint16_t reps;
+};
+
+const BenchCase BENCH_CASES[] = {
+  { "modbus_crc_request",      benchCrcRequest,         200 },
+  { "modbus_crc_reply",        benchCrcReply,           200 },
+  { "modbus_parse_reply_flow", benchParseFlowReply,     200 },
+  { "regs_to_float_be",        benchRegsToFloat,        200 },
+  { "vfd_format24",            benchFormat24,           200 },
+  { "parse_float_text",        benchParseFloatText,     200 },
+  { "parse_float_list",        benchParseFloatList,     200 },
+  { "command_auto_targets",    benchCommandAutoTargets, 100 },
+  { "command_pump",            benchCommandPump,        100 },
+  { "json_float",              benchJsonFloat,          200 },
+  { "telemetry_temps",         benchTelemetryTemps,      50 },
+  { "tc_read_celsius_fault",   benchTcReadCelsius,       50 },
+  { "tc_next_due",             benchTcNextDue,          200 },
+  { "auto_valve_step",         benchAutoValve,          200 },
+  { "safety_law_step",         benchSafetyLaw,          200 },
+};
+
+struct BenchResult {
+  uint32_t minCycles;
+  uint32_t meanCycles;
+};
+
+BenchResult runCase(void (*fn)(), uint16_t reps, uint32_t overhead) {
+  uint32_t minCycles = UINT32_MAX;
+  uint32_t total = 0;
+  for (uint16_t i = 0; i < reps; ++i) {
+    const uint32_t start = cyclesNow();
+    fn();
+    uint32_t cycles = cyclesNow() - start;
+    cycles = cycles > overhead ? cycles - overhead : 0;
+    if (cycles < minCycles) minCycles = cycles;
+    total += cycles;
+  }
+  return { minCycles, total / reps };
+}
+
+void printResult(const char *key, uint16_t reps, const BenchResult& result) {
+  Serial.print(F("{\"type\":\"bench\",\"case\":\""));
+  Serial.print(key);
+  Serial.print(F("\",\"reps\":"));
+  Serial.print(reps);
+  Serial.print(F(",\"min_cycles\":"));
+  Serial.print(result.minCycles);
+  Serial.print(F(",\"mean_cycles\":"));
+  Serial.print(result.meanCycles);
+  Serial.print(F(",\"us\":"));
+  Serial.print(static_cast<float>(result.minCycles) / (F_CPU / 1000000.0f), 2);
+  Serial.println('}');
+}
+
+void runAll() {
+  Serial.flush();
+  const uint8_t timsk0 = TIMSK0;
+  TIMSK0 = 0;
+  const uint32_t overhead = runCase(benchEmpty, 200, 0).minCycles;
+  TIMSK0 = timsk0;
+
+  for (const BenchCase& c : BENCH_CASES) {
+    Serial.flush();
+    TIMSK0 = 0;
+    const BenchResult result = runCase(c.fn, c.reps, overhead);
+    TIMSK0 = timsk0;
+    printResult(c.key, c.reps, result);
+  }
+
+  Serial.print(F("{\"type\":\"bench_done\",\"f_cpu\":"));
+  Serial.print(F_CPU);
+  Serial.print(F(",\"overhead_cycles\":"));
+  Serial.print(overhead);
+  Serial.println('}');
+}
+
+}  // namespace
+
+ISR(TIMER1_OVF_vect) { ++g_t1_overflows; }
+
+void setup() {
+  Serial.begin(115200);
+  setupInputs();
+  cycleCounterBegin();
+  Serial.println(F("# Firmware micro-benchmarks (cycles at clk/1, Timer1)"));
+}
+
+void loop() {
+  runAll();
+  delay(BENCH_REPEAT_MS);
+}
@@ -0,0 +1,62 @@
+// The controller board as the emulator wires it: Arduino Mega pin numbers from
+// the constants at the top of src/main.cpp, resolved to ATmega2560 port bits
+// for simavr's IOPORT IRQs. Keep in step with main.cpp when the wiring moves.
+#pragma once
+
+#include <stdint.h>
+
+#include "channel_map.h"
+
+struct AvrPin {
+  char    port;  // 'A'..'L'
+  uint8_t bit;
+};
+
+// Arduino Mega 2560 digital pin -> port bit (variants/mega/pins_arduino.h).
+constexpr AvrPin MEGA_PINS[] = {
+  {'E', 0}, {'E', 1}, {'E', 4}, {'E', 5}, {'G', 5}, {'E', 3}, {'H', 3}, {'H', 4},  //  0- 7
+  {'H', 5}, {'H', 6}, {'B', 4}, {'B', 5}, {'B', 6}, {'B', 7}, {'J', 1}, {'J', 0},  //  8-15
+  {'H', 1}, {'H', 0}, {'D', 3}, {'D', 2}, {'D', 1}, {'D', 0}, {'A', 0}, {'A', 1},  // 16-23
+  {'A', 2}, {'A', 3}, {'A', 4}, {'A', 5}, {'A', 6}, {'A', 7}, {'C', 7}, {'C', 6},  // 24-31
+  {'C', 5}, {'C', 4}, {'C', 3}, {'C', 2}, {'C', 1}, {'C', 0}, {'D', 7}, {'G', 2},  // 32-39
+  {'G', 1}, {'G', 0}, {'L', 7}, {'L', 6}, {'L', 5}, {'L', 4}, {'L', 3}, {'L', 2},  // 40-47
+  {'L', 1}, {'L', 0}, {'B', 3}, {'B', 2}, {'B', 1}, {'B', 0},                      // 48-53
+};
+constexpr uint8_t MEGA_PIN_COUNT = sizeof(MEGA_PINS) / sizeof(MEGA_PINS[0]);
+
+constexpr uint32_t MEGA_F_CPU = 16000000UL;
+constexpr uint16_t MEGA_EEPROM_BYTES = 4096;
+
+// ── MAX31856 software SPI ────────────────────────────────────────────────
+constexpr uint8_t TC_SCK_PIN  = 8;
+constexpr uint8_t TC_MOSI_PIN = 2;
+constexpr uint8_t TC_MISO_PIN = 22;
+// CS pins: TC_CS_PINS[] from channel_map.h (config/channels.yaml), U0..
+constexpr uint8_t TC_COUNT = TC_CHANNEL_COUNT;
+
+// ── Outputs ──────────────────────────────────────────────────────────────
+constexpr uint8_t VALVE_PIN          = 7;
+constexpr uint8_t HEATER_BOTTOM_PIN  = 11;
+constexpr uint8_t HEATER_EXHAUST_PIN = 5;
+constexpr uint8_t PUMP_PWM_PIN       = 6;  // OC4A
+
+// Timer4 data-space addresses, read to recover the pump duty (OCR4A / ICR4).
+constexpr uint16_t ICR4_ADDR  = 0xA6;
+constexpr uint16_t OCR4A_ADDR = 0xA8;
+
+// ── HX711 reservoir scale ────────────────────────────────────────────────
+constexpr uint8_t SCALE_DOUT_PIN = 36;
+constexpr uint8_t SCALE_SCK_PIN  = 28;
+
+// ── Pressure transducers, ADC channel numbers ────────────────────────────
+enum PressureInput : uint8_t { PRESSURE_BEFORE = 0, PRESSURE_AFTER, PRESSURE_TANK, PRESSURE_INPUT_COUNT };
+constexpr uint8_t PRESSURE_ADC_CHANNELS[PRESSURE_INPUT_COUNT] = { 8, 0, 1 };  // A8, A0, A1
+
+// ── UARTs ────────────────────────────────────────────────────────────────
+constexpr char CONSOLE_UART = '0';
+constexpr char FLOW_UART    = '2';  // MFC400, 19200 8E1, slave 1
+constexpr char VFD_UART     = '3';  // FRENIC-Mini, 9600 8E1, slave 1
+constexpr uint8_t FLOW_SLAVE_ADDR = 1;
+constexpr uint8_t VFD_SLAVE_ADDR  = 1;
+constexpr uint32_t FLOW_BAUD = 19200;
+constexpr uint32_t VFD_BAUD  = 9600;
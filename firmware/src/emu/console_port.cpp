@@ -0,0 +1,76 @@
+#include "console_port.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pty.h>
+#include <stdio.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace {
+
+// setup() prints this once per boot, so it also counts watchdog resets.
+constexpr char BOOT_BANNER[] = "# Telemetry keys:";
+constexpr size_t LINE_KEEP = sizeof(BOOT_BANNER);
+
+}  // namespace
+
+ConsolePort::ConsolePort(avr_t *avr, char uart) : UartLink(avr, uart) {}
+
+ConsolePort::~ConsolePort() {
+  if (!linkPath_.empty()) unlink(linkPath_.c_str());
+  if (master_ >= 0) close(master_);
+  if (slave_ >= 0) close(slave_);
+}
+
+bool ConsolePort::openPty(const std::string& linkPath, std::string *error) {
+  char name[128];
+  if (openpty(&master_, &slave_, name, nullptr, nullptr) != 0) {
+    *error = std::string("openpty: ") + strerror(errno);
+    return false;
+  }
+  // Raw like a USB CDC port; the slave stays open so the master never sees
+  // EIO while no client is attached.
+  termios tio;
+  tcgetattr(slave_, &tio);
+  cfmakeraw(&tio);
+  tcsetattr(slave_, TCSANOW, &tio);
+  fcntl(master_, F_SETFL, fcntl(master_, F_GETFL) | O_NONBLOCK);
+  ptyName_ = name;
+
+  if (!linkPath.empty()) {
+    unlink(linkPath.c_str());
+    if (symlink(name, linkPath.c_str()) != 0) {
+      *error = linkPath + ": " + strerror(errno);
+      return false;
+    }
+    linkPath_ = linkPath;
+  }
+  return true;
+}
+
+void ConsolePort::poll() {
+  if (master_ < 0) return;
+  uint8_t buf[64];
+  const ssize_t n = read(master_, buf, sizeof(buf));
+  if (n > 0) send(buf, static_cast<size_t>(n));
+}
+
+void ConsolePort::onTx(uint8_t byte) {
+  if (master_ >= 0) {
+    // Nobody reading: drop, as the Mega's USB bridge does.
+    if (write(master_, &byte, 1) < 0 && errno != EAGAIN) perror("pty write");
+  } else {
+    putchar(byte);
+    if (byte == '\n') fflush(stdout);
+  }
+
+  if (byte == '\n') {
+    ++lines_;
+    if (line_.compare(0, sizeof(BOOT_BANNER) - 1, BOOT_BANNER) == 0) ++boots_;
+    line_.clear();
+  } else if (line_.size() < LINE_KEEP) {
+    line_.push_back(static_cast<char>(byte));
+  }
+}
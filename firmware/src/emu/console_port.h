@@ -0,0 +1,37 @@
+// USART0, the supervisor link. Either streamed to stdout (scripted benches)
+// or bridged to a pseudo-terminal that supervisor/app.py opens like the
+// Mega's /dev/ttyACM device.
+#pragma once
+
+#include "emu_io.h"
+
+#include <stdint.h>
+
+#include <string>
+
+class ConsolePort : public UartLink {
+ public:
+  ConsolePort(avr_t *avr, char uart);
+  ~ConsolePort() override;
+
+  // Creates the pty and, if linkPath is set, a symlink to its slave side.
+  bool openPty(const std::string& linkPath, std::string *error);
+  const std::string& ptyName() const { return ptyName_; }
+
+  // Moves host -> firmware bytes from the pty; call about once a millisecond.
+  void poll();
+
+  unsigned long lines() const { return lines_; }
+  unsigned long boots() const { return boots_; }
+
+ private:
+  void onTx(uint8_t byte) override;
+
+  int master_ = -1;
+  int slave_ = -1;
+  std::string ptyName_;
+  std::string linkPath_;
+  std::string line_;
+  unsigned long lines_ = 0;
+  unsigned long boots_ = 0;
+};
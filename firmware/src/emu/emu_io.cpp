@@ -0,0 +1,81 @@
+#include "emu_io.h"
+
+#include "board.h"
+
+#include <simavr/avr_ioport.h>
+#include <simavr/avr_uart.h>
+#include <simavr/sim_cycle_timers.h>
+#include <simavr/sim_io.h>
+
+#include <string.h>
+
+#include <utility>
+
+avr_irq_t* pinIrq(avr_t *avr, uint8_t arduinoPin) {
+  if (arduinoPin >= MEGA_PIN_COUNT) return nullptr;
+  const AvrPin &pin = MEGA_PINS[arduinoPin];
+  return avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(pin.port), pin.bit);
+}
+
+double emuTimeS(const avr_t *avr) {
+  return static_cast<double>(avr->cycle) / avr->frequency;
+}
+
+namespace {
+
+avr_cycle_count_t runDeferred(avr_t *, avr_cycle_count_t, void *param) {
+  auto *fn = static_cast<std::function<void()>*>(param);
+  (*fn)();
+  delete fn;
+  return 0;  // one-shot
+}
+
+}  // namespace
+
+void emuAfterUs(avr_t *avr, uint32_t usec, std::function<void()> fn) {
+  avr_cycle_timer_register_usec(avr, usec ? usec : 1, runDeferred, new std::function<void()>(std::move(fn)));
+}
+
+UartLink::UartLink(avr_t *avr, char uart) : avr_(avr) {
+  // Keep simavr from echoing the USART to its own stdout.
+  uint32_t flags = 0;
+  avr_ioctl(avr, AVR_IOCTL_UART_GET_FLAGS(uart), &flags);
+  flags &= ~AVR_UART_FLAG_STDIO;
+  avr_ioctl(avr, AVR_IOCTL_UART_SET_FLAGS(uart), &flags);
+
+  rxIrq_ = avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ(uart), UART_IRQ_INPUT);
+  avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ(uart), UART_IRQ_OUTPUT), txHook, this);
+  avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ(uart), UART_IRQ_OUT_XON), xonHook, this);
+  avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ(uart), UART_IRQ_OUT_XOFF), xoffHook, this);
+}
+
+void UartLink::send(const uint8_t *data, size_t len) {
+  pending_.insert(pending_.end(), data, data + len);
+  pump();
+}
+
+void UartLink::send(const char *text) {
+  send(reinterpret_cast<const uint8_t*>(text), strlen(text));
+}
+
+void UartLink::pump() {
+  while (!xoff_ && !pending_.empty()) {
+    const uint8_t byte = pending_.front();
+    pending_.pop_front();
+    avr_raise_irq(rxIrq_, byte);
+  }
+}
+
+void UartLink::txHook(avr_irq_t *, uint32_t value, void *param) {
+  static_cast<UartLink*>(param)->onTx(static_cast<uint8_t>(value));
+}
+
+void UartLink::xonHook(avr_irq_t *, uint32_t, void *param) {
+  UartLink *link = static_cast<UartLink*>(param);
+  link->xoff_ = false;
+  link->pump();
+}
+
+void UartLink::xoffHook(avr_irq_t *, uint32_t, void *param) {
+  static_cast<UartLink*>(param)->xoff_ = true;
+}
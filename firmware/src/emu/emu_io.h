@@ -0,0 +1,47 @@
+// Glue between the device models and simavr: pin IRQ lookup, one-shot cycle
+// timers and a flow-controlled byte link to an emulated USART.
+#pragma once
+
+#include <simavr/sim_avr.h>
+#include <simavr/sim_irq.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <deque>
+#include <functional>
+
+// IRQ of an Arduino Mega digital pin: raise it to drive an input, register a
+// notify on it to watch an output.
+avr_irq_t* pinIrq(avr_t *avr, uint8_t arduinoPin);
+
+double emuTimeS(const avr_t *avr);
+
+// Runs fn once, usec of emulated time from now.
+void emuAfterUs(avr_t *avr, uint32_t usec, std::function<void()> fn);
+
+// One USART: bytes the firmware transmits arrive in onTx(); send() queues bytes
+// for its receiver, fed as fast as the USART's XON/XOFF flow control allows.
+class UartLink {
+ public:
+  UartLink(avr_t *avr, char uart);
+  virtual ~UartLink() = default;
+
+  void send(const uint8_t *data, size_t len);
+  void send(const char *text);
+
+ protected:
+  virtual void onTx(uint8_t byte) = 0;
+
+  avr_t *avr_;
+
+ private:
+  static void txHook(avr_irq_t *irq, uint32_t value, void *param);
+  static void xonHook(avr_irq_t *irq, uint32_t value, void *param);
+  static void xoffHook(avr_irq_t *irq, uint32_t value, void *param);
+  void pump();
+
+  avr_irq_t *rxIrq_;
+  std::deque<uint8_t> pending_;
+  bool xoff_ = false;
+};
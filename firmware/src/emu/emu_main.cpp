@@ -0,0 +1,434 @@
+// [env:emu] full-firmware emulation: the unmodified megaatmega2560 ELF under
+// simavr with the board's peripherals modelled around it.
+//
+//   program [--bench FILE] [--duration T] [--pty] [--pty-link PATH] [--realtime]
+//           [--eeprom FILE] [--vcd FILE] ELF
+//
+// Models: ten MAX31856 on the software-SPI pins, the HX711 on D36/D28, the
+// three pressure transducers as ADC voltages, a FRENIC-Mini on USART3 whose
+// frequency follows the OC4A pump duty, and an MFC400 on USART2. USART0 goes
+// to stdout, or with --pty to a pseudo-terminal that supervisor/app.py can
+// open as its serial port (--realtime is implied so its timeouts hold).
+//
+// A bench file uses the sim scenario syntax (src/sim/scenario.h) with
+// emulator events:
+//
+//   at <time> send <text>                 line to USART0
+//   at <time> tc <0-9> <C>|open|clear     MAX31856 reading / open-circuit fault
+//   at <time> cj <C>                      all cold junctions
+//   at <time> adc before|after|tank <V>
+//   at <time> scale <counts>|stall|resume
+//   at <time> vfd|flow online|offline
+//   param <key> <value>                   model parameters, see PARAM_KEYS
+//   expect <metric> <op> <value>          metrics, see metricValue()
+//
+// Harness lines (`# t=...`) and the {"type":"emu_summary"} line go to stderr;
+// stdout carries exactly what the firmware wrote to USART0. Exits 1 when an
+// expect fails or the CPU crashes, 2 on bad input.
+#include "board.h"
+#include "console_port.h"
+#include "emu_io.h"
+#include "hx711_model.h"
+#include "max31856_model.h"
+#include "modbus_slave.h"
+
+#include "scenario.h"
+
+#include <simavr/avr_adc.h>
+#include <simavr/avr_eeprom.h>
+#include <simavr/avr_timer.h>
+#include <simavr/sim_avr.h>
+#include <simavr/sim_cycle_timers.h>
+#include <simavr/sim_elf.h>
+#include <simavr/sim_io.h>
+#include <simavr/sim_time.h>
+#include <simavr/sim_vcd_file.h>
+
+#include <math.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t HOUSEKEEPING_US = 1000;
+constexpr float    DEFAULT_PRESSURE_V = 0.029f;  // 1 atm on the installed transducers
+// ~3 kg with the default tare/slope in main.cpp, above the rsv_mass_low law.
+constexpr int32_t  DEFAULT_SCALE_COUNTS = 5833;
+
+struct Options {
+  std::string benchPath;
+  std::string elfPath;
+  std::string ptyLink;
+  std::string eepromPath;
+  std::string vcdPath;
+  double durationS = 0.0;  // 0 = until interrupted
+  bool pty = false;
+  bool realtime = false;
+};
+
+struct ParamKey {
+  const char *key;
+  float defaultValue;
+};
+
+const ParamKey PARAM_KEYS[] = {
+  { "scale_sps", 10.0f },
+  { "vfd_max_hz", FrenicParams().maxHz },
+  { "vfd_full_current_a", FrenicParams().fullCurrentA },
+  { "vfd_full_power_w", FrenicParams().fullPowerW },
+  { "flow_lpm_per_pct", Mfc400Params().lpmPerPct },
+  { "flow_bore_area_m2", Mfc400Params().boreAreaM2 },
+  { "flow_density_kg_m3", Mfc400Params().densityKgM3 },
+  { "flow_temp_c", Mfc400Params().temperatureC },
+};
+
+struct OutputPin {
+  const avr_t *avr;
+  const char *name;
+  uint8_t pin;
+  bool high;
+  unsigned long rises;
+  unsigned long falls;
+};
+
+// The emulated board: the AVR plus every model wired to it.
+struct Board {
+  avr_t *avr = nullptr;
+  std::unique_ptr<ConsolePort> console;
+  std::unique_ptr<Max31856Bus> tcs;
+  std::unique_ptr<Hx711Model> scale;
+  std::unique_ptr<FrenicSlave> vfd;
+  std::unique_ptr<Mfc400Slave> flow;
+  OutputPin outputs[3] = {
+    { nullptr, "valve", VALVE_PIN, false, 0, 0 },
+    { nullptr, "heater_bottom", HEATER_BOTTOM_PIN, false, 0, 0 },
+    { nullptr, "heater_exhaust", HEATER_EXHAUST_PIN, false, 0, 0 },
+  };
+};
+
+volatile sig_atomic_t g_stop = 0;
+
+void onSignal(int) { g_stop = 1; }
+
+float paramValue(const Scenario& bench, const char *key) {
+  float value = NAN;
+  for (const ParamKey &p : PARAM_KEYS) {
+    if (strcmp(p.key, key) == 0) value = p.defaultValue;
+  }
+  for (const auto &param : bench.params) {
+    if (param.first == key) value = static_cast<float>(param.second);
+  }
+  return value;
+}
+
+bool knownParam(const std::string& key) {
+  for (const ParamKey &p : PARAM_KEYS) {
+    if (key == p.key) return true;
+  }
+  return false;
+}
+
+float pumpDuty(const avr_t *avr) {
+  const uint16_t top = avr->data[ICR4_ADDR] | (avr->data[ICR4_ADDR + 1] << 8);
+  const uint16_t ocr = avr->data[OCR4A_ADDR] | (avr->data[OCR4A_ADDR + 1] << 8);
+  if (top == 0) return 0.0f;
+  return ocr >= top ? 1.0f : static_cast<float>(ocr) / top;
+}
+
+void setAdcVolts(avr_t *avr, uint8_t channel, float volts) {
+  avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, ADC_IRQ_ADC0 + channel),
+                static_cast<uint32_t>(lroundf(volts * 1000.0f)));
+}
+
+void outputHook(avr_irq_t *, uint32_t value, void *param) {
+  OutputPin *out = static_cast<OutputPin*>(param);
+  const bool high = value != 0;
+  if (high == out->high) return;
+  out->high = high;
+  if (high) ++out->rises;
+  else      ++out->falls;
+  fprintf(stderr, "# t=%.3fs %s %s\n", emuTimeS(out->avr), out->name, high ? "on" : "off");
+}
+
+bool parseNumber(const std::string& text, float *out) {
+  char *end = nullptr;
+  *out = strtof(text.c_str(), &end);
+  return end != text.c_str() && *end == '\0' && isfinite(*out);
+}
+
+bool applyEvent(Board& board, const ScenarioEvent& event) {
+  const std::vector<std::string> &args = event.args;
+  float value = NAN;
+  if (event.verb == "send" && !args.empty()) {
+    std::string line;
+    for (const std::string &word : args) line += (line.empty() ? "" : " ") + word;
+    board.console->send((line + "\n").c_str());
+    return true;
+  }
+  if (event.verb == "tc" && args.size() == 2 && parseNumber(args[0], &value)) {
+    const int channel = static_cast<int>(value);
+    if (channel < 0 || channel >= board.tcs->count()) return false;
+    Max31856Model &chip = board.tcs->chip(static_cast<uint8_t>(channel));
+    if (args[1] == "open")  { chip.setOpen(true); return true; }
+    if (args[1] == "clear") { chip.setOpen(false); return true; }
+    if (!parseNumber(args[1], &value)) return false;
+    chip.setTemperatureC(value);
+    return true;
+  }
+  if (event.verb == "cj" && args.size() == 1 && parseNumber(args[0], &value)) {
+    for (uint8_t i = 0; i < board.tcs->count(); ++i) board.tcs->chip(i).setColdJunctionC(value);
+    return true;
+  }
+  if (event.verb == "adc" && args.size() == 2 && parseNumber(args[1], &value)) {
+    static const char *const NAMES[PRESSURE_INPUT_COUNT] = { "before", "after", "tank" };
+    for (uint8_t i = 0; i < PRESSURE_INPUT_COUNT; ++i) {
+      if (args[0] != NAMES[i]) continue;
+      setAdcVolts(board.avr, PRESSURE_ADC_CHANNELS[i], value);
+      return true;
+    }
+    return false;
+  }
+  if (event.verb == "scale" && args.size() == 1) {
+    if (args[0] == "stall")  { board.scale->setStalled(true); return true; }
+    if (args[0] == "resume") { board.scale->setStalled(false); return true; }
+    if (!parseNumber(args[0], &value)) return false;
+    board.scale->setCounts(static_cast<int32_t>(value));
+    return true;
+  }
+  if ((event.verb == "vfd" || event.verb == "flow") && args.size() == 1 &&
+      (args[0] == "online" || args[0] == "offline")) {
+    ModbusSlave &slave = event.verb == "vfd" ? static_cast<ModbusSlave&>(*board.vfd)
+                                             : static_cast<ModbusSlave&>(*board.flow);
+    slave.setOnline(args[0] == "online");
+    return true;
+  }
+  return false;
+}
+
+double metricValue(const std::string& key, const Board& board) {
+  if (key == "boots") return board.console->boots();
+  if (key == "console_lines") return board.console->lines();
+  if (key == "valve_opens") return board.outputs[0].rises;
+  if (key == "valve_closes") return board.outputs[0].falls;
+  if (key == "valve_open") return board.outputs[0].high ? 1.0 : 0.0;
+  if (key == "heater_bottom_on") return board.outputs[1].high ? 1.0 : 0.0;
+  if (key == "heater_exhaust_on") return board.outputs[2].high ? 1.0 : 0.0;
+  if (key == "pump_pct") return pumpDuty(board.avr) * 100.0;
+  if (key == "vfd_requests") return board.vfd->requests();
+  if (key == "flow_requests") return board.flow->requests();
+  if (key == "modbus_crc_errors") return board.vfd->crcErrors() + board.flow->crcErrors();
+  if (key == "scale_samples") return board.scale->samplesRead();
+  return NAN;
+}
+
+const char *const SUMMARY_KEYS[] = {
+  "boots", "console_lines", "valve_opens", "valve_closes", "valve_open", "pump_pct",
+  "vfd_requests", "flow_requests", "modbus_crc_errors", "scale_samples",
+};
+
+bool loadEeprom(avr_t *avr, const std::string& path) {
+  FILE *f = fopen(path.c_str(), "rb");
+  if (!f) return false;  // first run: erased EEPROM
+  uint8_t image[MEGA_EEPROM_BYTES];
+  memset(image, 0xFF, sizeof(image));
+  const size_t n = fread(image, 1, sizeof(image), f);
+  fclose(f);
+  avr_eeprom_desc_t desc = { image, 0, static_cast<uint32_t>(n) };
+  avr_ioctl(avr, AVR_IOCTL_EEPROM_SET, &desc);
+  return true;
+}
+
+void saveEeprom(avr_t *avr, const std::string& path) {
+  uint8_t image[MEGA_EEPROM_BYTES];
+  avr_eeprom_desc_t desc = { image, 0, MEGA_EEPROM_BYTES };
+  FILE *f = fopen(path.c_str(), "wb");
+  if (!f || avr_ioctl(avr, AVR_IOCTL_EEPROM_GET, &desc) < 0) {
+    fprintf(stderr, "%s: cannot write EEPROM image\n", path.c_str());
+    if (f) fclose(f);
+    return;
+  }
+  fwrite(desc.ee, 1, MEGA_EEPROM_BYTES, f);
+  fclose(f);
+}
+
+// Bench events, pty polling, real-time pacing and the duration limit, once
+// per emulated millisecond.
+struct Housekeeping {
+  Board *board;
+  const Scenario *bench;
+  size_t nextEvent;
+  double durationS;
+  bool realtime;
+  bool badEvent;
+  std::chrono::steady_clock::time_point wallStart;
+};
+
+avr_cycle_count_t housekeeping(avr_t *avr, avr_cycle_count_t when, void *param) {
+  Housekeeping &hk = *static_cast<Housekeeping*>(param);
+  const double nowS = emuTimeS(avr);
+  while (hk.nextEvent < hk.bench->events.size() && hk.bench->events[hk.nextEvent].timeS <= nowS) {
+    const ScenarioEvent &event = hk.bench->events[hk.nextEvent++];
+    if (!applyEvent(*hk.board, event)) {
+      fprintf(stderr, "line %d: bad event '%s'\n", event.line, event.verb.c_str());
+      hk.badEvent = true;
+      g_stop = 1;
+    }
+  }
+  hk.board->console->poll();
+  if (hk.realtime) {
+    const auto due = hk.wallStart + std::chrono::duration<double>(nowS);
+    if (due > std::chrono::steady_clock::now()) std::this_thread::sleep_until(due);
+  }
+  if (hk.durationS > 0.0 && nowS >= hk.durationS) g_stop = 1;
+  return when + avr_usec_to_cycles(avr, HOUSEKEEPING_US);
+}
+
+bool parseOptions(int argc, char **argv, Options *opts) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (arg == "--bench" && hasValue) opts->benchPath = argv[++i];
+    else if (arg == "--duration" && hasValue) {
+      if (!parseDurationS(argv[++i], &opts->durationS)) return false;
+    }
+    else if (arg == "--pty") opts->pty = true;
+    else if (arg == "--pty-link" && hasValue) { opts->pty = true; opts->ptyLink = argv[++i]; }
+    else if (arg == "--realtime") opts->realtime = true;
+    else if (arg == "--eeprom" && hasValue) opts->eepromPath = argv[++i];
+    else if (arg == "--vcd" && hasValue) opts->vcdPath = argv[++i];
+    else if (!arg.empty() && arg[0] == '-') return false;
+    else if (opts->elfPath.empty()) opts->elfPath = arg;
+    else return false;
+  }
+  return !opts->elfPath.empty();
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options opts;
+  if (!parseOptions(argc, argv, &opts)) {
+    fprintf(stderr,
+            "usage: %s [--bench FILE] [--duration T] [--pty] [--pty-link PATH] [--realtime]\n"
+            "          [--eeprom FILE] [--vcd FILE] ELF\n",
+            argv[0]);
+    return 2;
+  }
+
+  Scenario bench;
+  std::string error;
+  if (!opts.benchPath.empty()) {
+    if (!loadScenario(opts.benchPath, &bench, &error)) {
+      fprintf(stderr, "%s\n", error.c_str());
+      return 2;
+    }
+    for (const auto &param : bench.params) {
+      if (!knownParam(param.first)) {
+        fprintf(stderr, "%s: unknown param '%s'\n", opts.benchPath.c_str(), param.first.c_str());
+        return 2;
+      }
+    }
+    if (opts.durationS <= 0.0) opts.durationS = bench.durationS;
+  }
+
+  elf_firmware_t firmware = {};
+  if (elf_read_firmware(opts.elfPath.c_str(), &firmware) != 0) {
+    fprintf(stderr, "%s: cannot load ELF\n", opts.elfPath.c_str());
+    return 2;
+  }
+  Board board;
+  board.avr = avr_make_mcu_by_name("atmega2560");
+  if (!board.avr) {
+    fprintf(stderr, "simavr has no atmega2560 core\n");
+    return 2;
+  }
+  avr_init(board.avr);
+  if (!firmware.frequency) firmware.frequency = MEGA_F_CPU;
+  avr_load_firmware(board.avr, &firmware);
+  avr_t *avr = board.avr;
+  avr->vcc = avr->avcc = avr->aref = 5000;  // mV, analogReference(DEFAULT)
+  if (!opts.eepromPath.empty()) loadEeprom(avr, opts.eepromPath);
+
+  board.console.reset(new ConsolePort(avr, CONSOLE_UART));
+  if (opts.pty) {
+    if (!board.console->openPty(opts.ptyLink, &error)) {
+      fprintf(stderr, "%s\n", error.c_str());
+      return 2;
+    }
+    opts.realtime = true;
+    fprintf(stderr, "# console on %s%s%s\n", board.console->ptyName().c_str(),
+            opts.ptyLink.empty() ? "" : " -> ", opts.ptyLink.c_str());
+  }
+  board.tcs.reset(new Max31856Bus(avr, TC_SCK_PIN, TC_MOSI_PIN, TC_MISO_PIN, TC_CS_PINS, TC_COUNT));
+  board.scale.reset(new Hx711Model(avr, SCALE_DOUT_PIN, SCALE_SCK_PIN,
+                                   static_cast<uint32_t>(paramValue(bench, "scale_sps"))));
+  board.scale->setCounts(DEFAULT_SCALE_COUNTS);
+  auto duty = [avr]() { return pumpDuty(avr); };
+  board.vfd.reset(new FrenicSlave(avr, VFD_UART, VFD_SLAVE_ADDR, VFD_BAUD, duty));
+  board.vfd->params.maxHz = paramValue(bench, "vfd_max_hz");
+  board.vfd->params.fullCurrentA = paramValue(bench, "vfd_full_current_a");
+  board.vfd->params.fullPowerW = paramValue(bench, "vfd_full_power_w");
+  board.flow.reset(new Mfc400Slave(avr, FLOW_UART, FLOW_SLAVE_ADDR, FLOW_BAUD, duty));
+  board.flow->params.lpmPerPct = paramValue(bench, "flow_lpm_per_pct");
+  board.flow->params.boreAreaM2 = paramValue(bench, "flow_bore_area_m2");
+  board.flow->params.densityKgM3 = paramValue(bench, "flow_density_kg_m3");
+  board.flow->params.temperatureC = paramValue(bench, "flow_temp_c");
+  for (uint8_t ch : PRESSURE_ADC_CHANNELS) setAdcVolts(avr, ch, DEFAULT_PRESSURE_V);
+  for (OutputPin &out : board.outputs) {
+    out.avr = avr;
+    avr_irq_register_notify(pinIrq(avr, out.pin), outputHook, &out);
+  }
+
+  avr_vcd_t vcd;
+  if (!opts.vcdPath.empty()) {
+    avr_vcd_init(avr, opts.vcdPath.c_str(), &vcd, 100 /* us */);
+    avr_vcd_add_signal(&vcd, pinIrq(avr, VALVE_PIN), 1, "valve");
+    avr_vcd_add_signal(&vcd, avr_io_getirq(avr, AVR_IOCTL_TIMER_GETIRQ('4'), TIMER_IRQ_OUT_PWM0), 16, "pump_ocr4a");
+    avr_vcd_add_signal(&vcd, pinIrq(avr, TC_SCK_PIN), 1, "tc_sck");
+    avr_vcd_add_signal(&vcd, pinIrq(avr, SCALE_SCK_PIN), 1, "scale_sck");
+    avr_vcd_add_signal(&vcd, pinIrq(avr, SCALE_DOUT_PIN), 1, "scale_dout");
+    avr_vcd_start(&vcd);
+  }
+
+  Housekeeping hk = { &board, &bench, 0, opts.durationS, opts.realtime, false, std::chrono::steady_clock::now() };
+  avr_cycle_timer_register_usec(avr, HOUSEKEEPING_US, housekeeping, &hk);
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+
+  int state = cpu_Running;
+  while (!g_stop) {
+    state = avr_run(avr);
+    if (state == cpu_Done || state == cpu_Crashed) break;
+  }
+  const double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - hk.wallStart).count();
+  const double simS = emuTimeS(avr);
+
+  if (!opts.vcdPath.empty()) avr_vcd_close(&vcd);
+  if (!opts.eepromPath.empty()) saveEeprom(avr, opts.eepromPath);
+
+  fprintf(stderr, "{\"type\":\"emu_summary\",\"elf\":\"%s\",\"cpu\":\"%s\",\"cycles\":%llu,\"sim_s\":%.3f,"
+                  "\"wall_s\":%.3f,\"speed\":%.3f",
+          opts.elfPath.c_str(), state == cpu_Crashed ? "crashed" : "ok",
+          static_cast<unsigned long long>(avr->cycle), simS, wallS, wallS > 0.0 ? simS / wallS : 0.0);
+  for (const char *key : SUMMARY_KEYS) fprintf(stderr, ",\"%s\":%.6g", key, metricValue(key, board));
+  fprintf(stderr, "}\n");
+
+  int status = state == cpu_Crashed ? 1 : 0;
+  if (hk.badEvent) status = 2;
+  for (const ScenarioExpect &expect : bench.expects) {
+    const double actual = metricValue(expect.metric, board);
+    const bool ok = expectHolds(expect, actual);
+    fprintf(stderr, "# expect %s %s %g: %s (%g)\n", expect.metric.c_str(), expect.op.c_str(), expect.value,
+            ok ? "ok" : "FAIL", actual);
+    if (!ok && status == 0) status = 1;
+  }
+  return status;
+}
@@ -0,0 +1,40 @@
+#include "hx711_model.h"
+
+Hx711Model::Hx711Model(avr_t *avr, uint8_t doutPin, uint8_t sckPin, uint32_t samplesPerS)
+  : avr_(avr), doutIrq_(pinIrq(avr, doutPin)), periodUs_(1000000UL / (samplesPerS ? samplesPerS : 10)) {
+  avr_irq_register_notify(pinIrq(avr, sckPin), sckHook, this);
+  avr_raise_irq(doutIrq_, 1);
+  scheduleConversion();
+}
+
+void Hx711Model::scheduleConversion() {
+  emuAfterUs(avr_, periodUs_, [this]() {
+    if (stalled_) {
+      scheduleConversion();
+      return;
+    }
+    shift_ = static_cast<uint32_t>(counts_) & 0xFFFFFFUL;
+    pulses_ = 0;
+    ready_ = true;
+    avr_raise_irq(doutIrq_, 0);
+  });
+}
+
+void Hx711Model::sckHook(avr_irq_t *, uint32_t value, void *param) {
+  Hx711Model *hx = static_cast<Hx711Model*>(param);
+  const bool high = value != 0;
+  if (high == hx->sck_) return;
+  hx->sck_ = high;
+  if (!high || !hx->ready_) return;
+
+  ++hx->pulses_;
+  if (hx->pulses_ <= 24) {
+    avr_raise_irq(hx->doutIrq_, (hx->shift_ >> (24 - hx->pulses_)) & 1);
+    return;
+  }
+  // 25th pulse: gain 128 on channel A for the next conversion.
+  hx->ready_ = false;
+  ++hx->samplesRead_;
+  avr_raise_irq(hx->doutIrq_, 1);
+  hx->scheduleConversion();
+}
@@ -0,0 +1,33 @@
+// HX711 load-cell ADC: DOUT falls when a conversion is ready (10 or 80 SPS),
+// each PD_SCK rising edge shifts out the next bit MSB first, and the 25th
+// pulse ends the read (channel A, gain 128) and raises DOUT until the next
+// conversion.
+#pragma once
+
+#include "emu_io.h"
+
+#include <stdint.h>
+
+class Hx711Model {
+ public:
+  Hx711Model(avr_t *avr, uint8_t doutPin, uint8_t sckPin, uint32_t samplesPerS);
+
+  void setCounts(int32_t counts) { counts_ = counts; }
+  void setStalled(bool stalled) { stalled_ = stalled; }
+  unsigned long samplesRead() const { return samplesRead_; }
+
+ private:
+  static void sckHook(avr_irq_t *irq, uint32_t value, void *param);
+  void scheduleConversion();
+
+  avr_t *avr_;
+  avr_irq_t *doutIrq_;
+  uint32_t periodUs_;
+  int32_t counts_ = 0;
+  uint32_t shift_ = 0;
+  uint8_t pulses_ = 0;
+  bool ready_ = false;
+  bool sck_ = false;
+  bool stalled_ = false;  // no conversions: DOUT stays high
+  unsigned long samplesRead_ = 0;
+};
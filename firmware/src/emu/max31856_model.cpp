@@ -0,0 +1,144 @@
+#include "max31856_model.h"
+
+#include <math.h>
+
+namespace {
+
+constexpr uint8_t CR0_CMODE   = 0x80;
+constexpr uint8_t CR0_1SHOT   = 0x40;
+constexpr uint8_t SR_OPEN     = 0x01;
+constexpr uint8_t SR_TC_RANGE = 0x40;
+
+int32_t clampCounts(float value, int32_t lo, int32_t hi) {
+  const float rounded = roundf(value);
+  if (rounded < lo) return lo;
+  if (rounded > hi) return hi;
+  return static_cast<int32_t>(rounded);
+}
+
+}  // namespace
+
+void Max31856Model::setTemperatureC(float tempC) {
+  tempC_ = tempC;
+  latchResult();
+}
+
+void Max31856Model::setColdJunctionC(float tempC) {
+  cjC_ = tempC;
+  latchResult();
+}
+
+void Max31856Model::setOpen(bool open) {
+  open_ = open;
+  latchResult();
+}
+
+// An open thermocouple leaves the last conversion in place and flags OPEN;
+// the firmware's fault handling decides what the reading is worth.
+void Max31856Model::latchResult() {
+  const int32_t tc = clampCounts(tempC_ * 128.0f, -(1L << 18), (1L << 18) - 1);
+  const uint32_t tcBits = static_cast<uint32_t>(tc) << 5;
+  if (!open_) {
+    regs_[REG_LTCBH] = static_cast<uint8_t>(tcBits >> 16);
+    regs_[REG_LTCBH + 1] = static_cast<uint8_t>(tcBits >> 8);
+    regs_[REG_LTCBH + 2] = static_cast<uint8_t>(tcBits);
+  }
+  const int32_t cj = clampCounts(cjC_ * 64.0f, -(1L << 13), (1L << 13) - 1);
+  const uint16_t cjBits = static_cast<uint16_t>(static_cast<uint32_t>(cj) << 2);
+  regs_[REG_CJTH] = static_cast<uint8_t>(cjBits >> 8);
+  regs_[REG_CJTH + 1] = static_cast<uint8_t>(cjBits);
+
+  uint8_t sr = 0;
+  if (open_) sr |= SR_OPEN;
+  if (tempC_ < -270.0f || tempC_ > 1372.0f) sr |= SR_TC_RANGE;
+  regs_[REG_SR] = sr;
+}
+
+void Max31856Model::writeRegister(uint8_t reg, uint8_t value) {
+  if (reg >= REG_LTCBH) return;  // TC result and status registers are read-only
+  if (reg == REG_CR0 && (value & CR0_1SHOT)) {
+    latchResult();
+    value &= static_cast<uint8_t>(~CR0_1SHOT);  // conversion done
+  }
+  regs_[reg] = value;
+  if (reg == REG_CR0 && (value & CR0_CMODE)) latchResult();
+}
+
+void Max31856Model::select() {
+  addressed_ = false;
+  writing_ = false;
+  inByte_ = 0;
+  inBits_ = 0;
+  outByte_ = 0;
+  outBits_ = 0;
+}
+
+void Max31856Model::deselect() {
+  addressed_ = false;
+}
+
+uint8_t Max31856Model::misoBit() {
+  if (outBits_ == 0) {
+    outByte_ = (addressed_ && !writing_) ? regs_[addr_ & 0x0F] : 0x00;
+    if (addressed_ && !writing_) addr_ = (addr_ + 1) & 0x0F;
+    outBits_ = 8;
+  }
+  --outBits_;
+  return (outByte_ >> outBits_) & 1;
+}
+
+void Max31856Model::mosiBit(bool bit) {
+  inByte_ = static_cast<uint8_t>((inByte_ << 1) | (bit ? 1 : 0));
+  if (++inBits_ < 8) return;
+  inBits_ = 0;
+  if (!addressed_) {
+    addressed_ = true;
+    writing_ = (inByte_ & 0x80) != 0;
+    addr_ = inByte_ & 0x0F;
+  } else if (writing_) {
+    writeRegister(addr_, inByte_);
+    addr_ = (addr_ + 1) & 0x0F;
+  }
+}
+
+Max31856Bus::Max31856Bus(avr_t *avr, uint8_t sckPin, uint8_t mosiPin, uint8_t misoPin,
+                         const uint8_t *csPins, uint8_t count)
+  : misoIrq_(pinIrq(avr, misoPin)), count_(count > MAX_CHIPS ? MAX_CHIPS : count) {
+  avr_irq_register_notify(pinIrq(avr, sckPin), sckHook, this);
+  avr_irq_register_notify(pinIrq(avr, mosiPin), mosiHook, this);
+  for (uint8_t i = 0; i < count_; ++i) {
+    chips_[i].setTemperatureC(chips_[i].temperatureC());
+    csLines_[i] = { this, i };
+    avr_irq_register_notify(pinIrq(avr, csPins[i]), csHook, &csLines_[i]);
+  }
+}
+
+void Max31856Bus::sckHook(avr_irq_t *, uint32_t value, void *param) {
+  Max31856Bus *bus = static_cast<Max31856Bus*>(param);
+  const bool high = value != 0;
+  if (high == bus->sck_) return;
+  bus->sck_ = high;
+  if (bus->selected_ < 0) return;
+  Max31856Model &chip = bus->chips_[bus->selected_];
+  if (high) avr_raise_irq(bus->misoIrq_, chip.misoBit());
+  else      chip.mosiBit(bus->mosi_);
+}
+
+void Max31856Bus::mosiHook(avr_irq_t *, uint32_t value, void *param) {
+  static_cast<Max31856Bus*>(param)->mosi_ = value != 0;
+}
+
+// More than one CS low at once is a wiring fault on the real bus; the model
+// follows the most recent falling edge.
+void Max31856Bus::csHook(avr_irq_t *, uint32_t value, void *param) {
+  CsLine *line = static_cast<CsLine*>(param);
+  Max31856Bus *bus = line->bus;
+  if (value == 0) {
+    if (bus->selected_ == line->index) return;
+    bus->selected_ = line->index;
+    bus->chips_[line->index].select();
+  } else if (bus->selected_ == line->index) {
+    bus->chips_[line->index].deselect();
+    bus->selected_ = -1;
+  }
+}
@@ -0,0 +1,89 @@
+// MAX31856 register model on the shared software-SPI bus (SPI mode 1: the
+// chip shifts SDO out on SCK rising edges and samples SDI on falling edges).
+//
+// Registers follow the datasheet: address byte bit 7 selects write, the
+// address auto-increments, 0x0C..0x0E hold the linearized TC temperature
+// (19 bits, 1/128 C) and 0x0A..0x0B the cold junction (14 bits, 1/64 C). A
+// one-shot request in CR0 completes at once; continuous mode just keeps the
+// result registers current.
+#pragma once
+
+#include "emu_io.h"
+
+#include <stdint.h>
+
+class Max31856Model {
+ public:
+  Max31856Model() = default;
+
+  void setTemperatureC(float tempC);
+  void setColdJunctionC(float tempC);
+  void setOpen(bool open);
+
+  float temperatureC() const { return tempC_; }
+  uint8_t cr0() const { return regs_[REG_CR0]; }
+  uint8_t cr1() const { return regs_[REG_CR1]; }
+
+  // Bus events, called by Max31856Bus.
+  void select();
+  void deselect();
+  uint8_t misoBit();       // on SCK rising edge
+  void mosiBit(bool bit);  // on SCK falling edge
+
+ private:
+  static constexpr uint8_t REG_CR0 = 0x00;
+  static constexpr uint8_t REG_CR1 = 0x01;
+  static constexpr uint8_t REG_MASK = 0x02;
+  static constexpr uint8_t REG_CJTH = 0x0A;
+  static constexpr uint8_t REG_LTCBH = 0x0C;
+  static constexpr uint8_t REG_SR = 0x0F;
+  static constexpr uint8_t REG_COUNT = 16;
+
+  void latchResult();
+  void writeRegister(uint8_t reg, uint8_t value);
+
+  // Power-on defaults: CR1 = 3 (type K, 1 sample), faults masked.
+  uint8_t regs_[REG_COUNT] = { 0x00, 0x03, 0xFF, 0x7F, 0xC0, 0x7F, 0xFF, 0x80, 0x00 };
+  float tempC_ = 22.0f;
+  float cjC_ = 22.0f;
+  bool open_ = false;
+
+  uint8_t addr_ = 0;
+  bool addressed_ = false;
+  bool writing_ = false;
+  uint8_t inByte_ = 0;
+  uint8_t inBits_ = 0;
+  uint8_t outByte_ = 0;
+  uint8_t outBits_ = 0;
+};
+
+// Watches SCK, SDI and every CS line and routes edges to the selected chip;
+// drives the shared SDO line.
+class Max31856Bus {
+ public:
+  Max31856Bus(avr_t *avr, uint8_t sckPin, uint8_t mosiPin, uint8_t misoPin,
+              const uint8_t *csPins, uint8_t count);
+
+  Max31856Model& chip(uint8_t index) { return chips_[index]; }
+  uint8_t count() const { return count_; }
+
+ private:
+  static constexpr uint8_t MAX_CHIPS = 16;
+
+  static void sckHook(avr_irq_t *irq, uint32_t value, void *param);
+  static void mosiHook(avr_irq_t *irq, uint32_t value, void *param);
+  static void csHook(avr_irq_t *irq, uint32_t value, void *param);
+
+  struct CsLine {
+    Max31856Bus *bus;
+    uint8_t index;
+  };
+
+  avr_irq_t *misoIrq_;
+  Max31856Model chips_[MAX_CHIPS];
+  CsLine csLines_[MAX_CHIPS];
+  uint8_t count_;
+  int selected_ = -1;
+  bool sck_ = false;
+  bool mosi_ = false;
+};
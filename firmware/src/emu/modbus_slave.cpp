@@ -0,0 +1,148 @@
+#include "modbus_slave.h"
+
+#include "modbus_rtu.h"
+
+#include <simavr/sim_time.h>
+
+#include <math.h>
+#include <string.h>
+
+#include <utility>
+
+namespace {
+
+constexpr uint8_t MODBUS_EXCEPTION_ILLEGAL_ADDRESS = 0x02;
+constexpr uint8_t MODBUS_EXCEPTION_ILLEGAL_FUNCTION = 0x01;
+
+uint16_t clampRegister(float value) {
+  if (!(value > 0.0f)) return 0;
+  if (value > 65535.0f) return 65535;
+  return static_cast<uint16_t>(lroundf(value));
+}
+
+// Inverse of vfdDecodeFormat24(): the finest exponent that fits 14 bits.
+uint16_t encodeFormat24(float value) {
+  static const float SCALES[4] = { 100.0f, 10.0f, 1.0f, 0.1f };
+  for (uint16_t exponent = 0; exponent < 4; ++exponent) {
+    const float mantissa = roundf(value * SCALES[exponent]);
+    if (mantissa < 0x4000) return static_cast<uint16_t>((exponent << 14) | static_cast<uint16_t>(mantissa));
+  }
+  return 0xFFFF;
+}
+
+void floatToRegsBE(float value, uint16_t *hi, uint16_t *lo) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  *hi = static_cast<uint16_t>(bits >> 16);
+  *lo = static_cast<uint16_t>(bits);
+}
+
+}  // namespace
+
+// 8E1: 11 bits per character on the wire.
+ModbusSlave::ModbusSlave(avr_t *avr, char uart, uint8_t address, uint32_t baud, uint32_t turnaroundUs)
+  : UartLink(avr, uart), address_(address), charUs_(11000000UL / baud), turnaroundUs_(turnaroundUs) {}
+
+void ModbusSlave::onTx(uint8_t byte) {
+  // A silent interval longer than 3.5 characters starts a new frame.
+  const avr_cycle_count_t gap = avr_->cycle - lastRxCycle_;
+  lastRxCycle_ = avr_->cycle;
+  if (!rx_.empty() && gap > avr_usec_to_cycles(avr_, 4 * charUs_)) rx_.clear();
+  rx_.push_back(byte);
+  if (rx_.size() >= MODBUS_REQUEST_LEN) handleFrame();
+}
+
+void ModbusSlave::handleFrame() {
+  const uint8_t *frame = rx_.data();
+  const uint16_t crc = static_cast<uint16_t>(frame[7] << 8) | frame[6];
+  if (crc != modbusCRC(frame, 6)) {
+    ++crcErrors_;
+    rx_.erase(rx_.begin());  // resynchronise on the next byte
+    return;
+  }
+  std::vector<uint8_t> request(rx_.begin(), rx_.begin() + MODBUS_REQUEST_LEN);
+  rx_.clear();
+  if (request[0] != address_ || !online_) return;
+  ++requests_;
+
+  const uint8_t function = request[1];
+  const uint16_t start = static_cast<uint16_t>(request[2] << 8) | request[3];
+  const uint16_t count = static_cast<uint16_t>(request[4] << 8) | request[5];
+  std::vector<uint8_t> out = { address_, function };
+  uint8_t exception = 0;
+  if ((function != MODBUS_FC_READ_HOLDING && function != MODBUS_FC_READ_INPUT) || count == 0 || count > 125) {
+    exception = MODBUS_EXCEPTION_ILLEGAL_FUNCTION;
+  } else {
+    out.push_back(static_cast<uint8_t>(2 * count));
+    for (uint16_t i = 0; i < count && !exception; ++i) {
+      uint16_t value = 0;
+      if (!readRegister(function, static_cast<uint16_t>(start + i), &value)) {
+        exception = MODBUS_EXCEPTION_ILLEGAL_ADDRESS;
+        break;
+      }
+      out.push_back(static_cast<uint8_t>(value >> 8));
+      out.push_back(static_cast<uint8_t>(value));
+    }
+  }
+  if (exception) {
+    ++exceptions_;
+    out = { address_, static_cast<uint8_t>(function | 0x80), exception };
+  }
+  const uint16_t replyCrc = modbusCRC(out.data(), out.size());
+  out.push_back(static_cast<uint8_t>(replyCrc & 0xFF));
+  out.push_back(static_cast<uint8_t>(replyCrc >> 8));
+  reply(std::move(out));
+}
+
+void ModbusSlave::reply(std::vector<uint8_t> frame) {
+  for (size_t i = 0; i < frame.size(); ++i) {
+    const uint8_t byte = frame[i];
+    emuAfterUs(avr_, turnaroundUs_ + static_cast<uint32_t>(i + 1) * charUs_, [this, byte]() { send(&byte, 1); });
+  }
+}
+
+// ── FRENIC-Mini ──────────────────────────────────────────────────────────
+// Holding registers the firmware polls: M09..M12 and W05, W06, W21.
+FrenicSlave::FrenicSlave(avr_t *avr, char uart, uint8_t address, uint32_t baud, PumpDutyFn duty)
+  : ModbusSlave(avr, uart, address, baud, 3000), duty_(std::move(duty)) {}
+
+bool FrenicSlave::readRegister(uint8_t function, uint16_t reg, uint16_t *value) {
+  if (function != MODBUS_FC_READ_HOLDING) return false;
+  const float duty = duty_();
+  const float currentA = duty * params.fullCurrentA;
+  const float powerW = duty * params.fullPowerW;
+  const float voltageV = duty * params.baseVoltageV;
+  switch (reg) {
+    case 0x0809: *value = clampRegister(duty * params.maxHz * 100.0f); return true;                   // M09
+    case 0x080A: *value = clampRegister(powerW / params.ratedPowerW * 10000.0f); return true;         // M10
+    case 0x080B: *value = clampRegister(currentA / params.ratedCurrentA * 10000.0f); return true;     // M11
+    case 0x080C: *value = clampRegister(voltageV * 10.0f); return true;                               // M12
+    case 0x0F05: *value = clampRegister(currentA * 100.0f); return true;                              // W05
+    case 0x0F06: *value = clampRegister(voltageV * 10.0f); return true;                               // W06
+    case 0x0F15: *value = encodeFormat24(powerW / 1000.0f); return true;                              // W21
+    default:     return false;
+  }
+}
+
+// ── MFC400 ───────────────────────────────────────────────────────────────
+// Input registers 30000..30009: velocity, volume flow, mass flow,
+// temperature, density as big-endian float32 pairs.
+Mfc400Slave::Mfc400Slave(avr_t *avr, char uart, uint8_t address, uint32_t baud, PumpDutyFn duty)
+  : ModbusSlave(avr, uart, address, baud, 2000), duty_(std::move(duty)) {}
+
+bool Mfc400Slave::readRegister(uint8_t function, uint16_t reg, uint16_t *value) {
+  if (function != MODBUS_FC_READ_INPUT || reg < 30000 || reg > 30009) return false;
+  const float volumeM3s = duty_() * 100.0f * params.lpmPerPct / 60000.0f;
+  const float values[5] = {
+    params.boreAreaM2 > 0.0f ? volumeM3s / params.boreAreaM2 : 0.0f,
+    volumeM3s,
+    volumeM3s * params.densityKgM3,
+    params.temperatureC,
+    params.densityKgM3,
+  };
+  const uint16_t offset = reg - 30000;
+  uint16_t hi, lo;
+  floatToRegsBE(values[offset / 2], &hi, &lo);
+  *value = (offset & 1) ? lo : hi;
+  return true;
+}
@@ -0,0 +1,85 @@
+// Modbus RTU slaves on the field-bus USARTs: a FRENIC-Mini on USART3 and an
+// MFC400 flow meter on USART2. Requests are framed and CRC-checked with the
+// firmware's own lib/orca_core helpers; replies go out after a turnaround
+// delay plus the frame's time on the wire.
+#pragma once
+
+#include "emu_io.h"
+
+#include <stdint.h>
+
+#include <functional>
+#include <vector>
+
+class ModbusSlave : public UartLink {
+ public:
+  ModbusSlave(avr_t *avr, char uart, uint8_t address, uint32_t baud, uint32_t turnaroundUs);
+
+  void setOnline(bool online) { online_ = online; }
+  unsigned long requests() const { return requests_; }
+  unsigned long crcErrors() const { return crcErrors_; }
+  unsigned long exceptions() const { return exceptions_; }
+
+ protected:
+  // False for an address outside the device's map (exception 02).
+  virtual bool readRegister(uint8_t function, uint16_t reg, uint16_t *value) = 0;
+
+ private:
+  void onTx(uint8_t byte) override;
+  void handleFrame();
+  void reply(std::vector<uint8_t> frame);
+
+  uint8_t address_;
+  uint32_t charUs_;
+  uint32_t turnaroundUs_;
+  bool online_ = true;
+  std::vector<uint8_t> rx_;
+  avr_cycle_count_t lastRxCycle_ = 0;
+  unsigned long requests_ = 0;
+  unsigned long crcErrors_ = 0;
+  unsigned long exceptions_ = 0;
+};
+
+// Pump drive state shared by both models: the 0..1 PWM duty the firmware
+// writes to OC4A, which the VFD's analog input follows.
+using PumpDutyFn = std::function<float()>;
+
+struct FrenicParams {
+  float maxHz = 71.7f;          // PUMP_MAX_FREQ_HZ
+  float fullCurrentA = 3.4f;    // at 100 % duty
+  float fullPowerW = 870.0f;
+  float ratedCurrentA = 3.4f;   // M11 reference
+  float ratedPowerW = 746.0f;   // M10 reference
+  float baseVoltageV = 230.0f;
+};
+
+class FrenicSlave : public ModbusSlave {
+ public:
+  FrenicSlave(avr_t *avr, char uart, uint8_t address, uint32_t baud, PumpDutyFn duty);
+  FrenicParams params;
+
+ protected:
+  bool readRegister(uint8_t function, uint16_t reg, uint16_t *value) override;
+
+ private:
+  PumpDutyFn duty_;
+};
+
+struct Mfc400Params {
+  float lpmPerPct = 0.0677341f;   // sim/plant_params.txt pump_flow_lpm_per_pct
+  float boreAreaM2 = 1.267e-4f;   // 1/2" tube
+  float densityKgM3 = 1430.0f;
+  float temperatureC = 22.0f;
+};
+
+class Mfc400Slave : public ModbusSlave {
+ public:
+  Mfc400Slave(avr_t *avr, char uart, uint8_t address, uint32_t baud, PumpDutyFn duty);
+  Mfc400Params params;
+
+ protected:
+  bool readRegister(uint8_t function, uint16_t reg, uint16_t *value) override;
+
+ private:
+  PumpDutyFn duty_;
+};
@@ -0,0 +1,78 @@
+// [env:fuzz_cmd_parse] libFuzzer target for the serial command argument
+// parsers (lib/orca_core cmd_parse), which handleCommand() reaches through
+// tryParseFloat(), parseFloatSuffix() and parseFloatArgs().
+//
+// The input is one command line as the supervisor sends it. Like the
+// handlers, the target parses the whole line and every suffix after a space
+// (the argument text past `PUMP`, `AUTO TARGETS`, `HEATER <name> PI`, ...)
+// as a single number and as 1..6 numbers. The bytes sit in an exact-size
+// heap copy without a terminator, so ASan flags any read past `len`.
+//
+// Traps on: a non-finite accepted value, an accepted number with a NUL in its
+// text (strtod would stop there and drop the rest), an accepted list longer
+// than the CMD_FLOAT_LIST_MAX buffer, or a number parseFloatText() accepts
+// that parseFloatList(.., 1) rejects or reads differently.
+#include "cmd_parse.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+
+constexpr size_t MAX_LIST_COUNT = 6;  // HEATER <name> PI
+constexpr size_t MAX_SUFFIXES = 4;
+
+void check(bool condition) {
+  if (!condition) __builtin_trap();
+}
+
+bool isBlank(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v';
+}
+
+void parseArgs(const char *text, size_t len) {
+  float single = NAN;
+  const bool singleOk = parseFloatText(text, len, &single);
+  if (singleOk) check(isfinite(single) && !memchr(text, '\0', len));
+
+  for (size_t count = 1; count <= MAX_LIST_COUNT; ++count) {
+    float values[MAX_LIST_COUNT];
+    if (!parseFloatList(text, len, values, count)) {
+      check(!(singleOk && count == 1));
+      continue;
+    }
+    check(len > 0);
+    for (size_t i = 0; i < count; ++i) check(isfinite(values[i]));
+    if (singleOk && count == 1) check(values[0] == single);
+  }
+
+  // Trimmed text that does not fit the list buffer is always rejected.
+  size_t start = 0, end = len;
+  while (start < end && isBlank(text[start])) ++start;
+  while (end > start && isBlank(text[end - 1])) --end;
+  if (end - start >= CMD_FLOAT_LIST_MAX) {
+    float values[1];
+    check(!parseFloatList(text, len, values, 1));
+  }
+}
+
+}  // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  if (size == 0) return 0;
+  char *line = static_cast<char*>(malloc(size));
+  memcpy(line, data, size);
+
+  parseArgs(line, size);
+  size_t suffixes = 0;
+  for (size_t i = 0; i < size && suffixes < MAX_SUFFIXES; ++i) {
+    if (line[i] != ' ') continue;
+    parseArgs(line + i + 1, size - i - 1);
+    ++suffixes;
+  }
+
+  free(line);
+  return 0;
+}
@@ -0,0 +1,83 @@
+// [env:fuzz_modbus_read] libFuzzer target for modbusReadRegisters(), the
+// whole transaction vfdReadHoldingRegs() and flowReadMeasurements() run:
+// request framing, collecting the reply into its MODBUS_REPLY_MAX buffer,
+// then validation.
+//
+// Input: register count, function code, then the bytes the slave answers
+// with, delivered on the in-memory UART (hal_host) as soon as the request
+// is written. Stale bytes queued ahead of the request are in the input too
+// when it is longer than the register count allows. Runs against the VFD
+// port with the controller's reply timeout; the host clock advances while
+// the master waits, so short replies time out as on the Mega.
+//
+// Traps when the request on the wire is malformed or when a transaction
+// succeeds with a count the guards should have refused.
+#include "hal_host.h"
+#include "modbus_rtu.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+namespace {
+
+constexpr uint8_t SLAVE_ADDR = 1;
+constexpr uint16_t START_REG = 0x0809;          // VFD M09
+constexpr uint32_t REPLY_TIMEOUT_MS = 200;      // VFD_REPLY_TIMEOUT_MS
+
+const uint8_t *g_reply = nullptr;
+size_t g_reply_len = 0;
+
+void check(bool condition) {
+  if (!condition) __builtin_trap();
+}
+
+void answer(hal::host::MemorySerialPort& port, const uint8_t *, size_t) {
+  port.inject(g_reply, g_reply_len);
+  g_reply_len = 0;
+}
+
+}  // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  if (size < 2) return 0;
+  const uint8_t regCount = data[0];
+  const uint8_t function = data[1];
+
+  hal::host::MemorySerialPort& port = hal::host::memoryPort(hal::PORT_VFD);
+  port.clear();
+  port.onWrite = answer;
+
+  // Bytes past a full-size reply are queued before the request (stale RX).
+  const size_t replyMax = 5U + 2U * MODBUS_MAX_READ_REGS;
+  size_t replyLen = size - 2;
+  if (replyLen > replyMax) {
+    port.inject(data + 2 + replyMax, replyLen - replyMax);
+    replyLen = replyMax;
+  }
+  uint8_t *reply = static_cast<uint8_t*>(malloc(replyLen ? replyLen : 1));
+  if (replyLen) memcpy(reply, data + 2, replyLen);
+  g_reply = reply;
+  g_reply_len = replyLen;
+
+  uint16_t *vals = static_cast<uint16_t*>(malloc(regCount ? regCount * sizeof(uint16_t) : 1));
+  const bool ok = modbusReadRegisters(port, SLAVE_ADDR, function, START_REG, regCount, vals, REPLY_TIMEOUT_MS);
+  if (ok) check(regCount > 0 && regCount <= MODBUS_MAX_READ_REGS);
+
+  const std::vector<uint8_t>& request = port.output();
+  if (regCount > 0 && regCount <= MODBUS_MAX_READ_REGS) {
+    check(request.size() == MODBUS_REQUEST_LEN);
+    check(request[0] == SLAVE_ADDR && request[1] == function && request[5] == regCount);
+    check(modbusCRC(request.data(), 6) == static_cast<uint16_t>(request[6] | (request[7] << 8)));
+  } else {
+    check(request.empty());
+  }
+
+  free(vals);
+  free(reply);
+  port.onWrite = nullptr;
+  port.clear();
+  return 0;
+}
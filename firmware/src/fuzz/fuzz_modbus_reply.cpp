@@ -0,0 +1,54 @@
+// [env:fuzz_modbus_reply] libFuzzer target for modbusParseReadReply(), the
+// validator behind vfdReadHoldingRegs() and flowReadMeasurements().
+//
+// Input: one byte of register count (taken raw, so 0 and counts past
+// MODBUS_MAX_READ_REGS reach the guards), then the reply frame. The frame is
+// validated against its own address and function and against the two the
+// controller polls (slave 1 FC03 on the VFD, FC04 on the MFC400). The frame
+// and the register output sit in exact-size heap buffers for ASan.
+//
+// Traps when an accepted reply is not 5 + 2n bytes with a matching CRC,
+// header and byte count, or when the decoded registers differ from the
+// payload.
+#include "modbus_rtu.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+
+void check(bool condition) {
+  if (!condition) __builtin_trap();
+}
+
+void parse(const uint8_t *frame, size_t len, uint8_t slave, uint8_t function, uint8_t regCount) {
+  uint16_t *vals = static_cast<uint16_t*>(malloc(regCount ? regCount * sizeof(uint16_t) : 1));
+  if (modbusParseReadReply(frame, len, slave, function, regCount, vals)) {
+    check(regCount > 0 && regCount <= MODBUS_MAX_READ_REGS);
+    check(len == 5U + 2U * regCount);
+    check(frame[0] == slave && frame[1] == function && frame[2] == 2 * regCount);
+    check(modbusCRC(frame, len - 2) == static_cast<uint16_t>(frame[len - 2] | (frame[len - 1] << 8)));
+    for (uint8_t i = 0; i < regCount; ++i) {
+      check(vals[i] == static_cast<uint16_t>((frame[3 + 2 * i] << 8) | frame[4 + 2 * i]));
+    }
+  }
+  free(vals);
+}
+
+}  // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  if (size < 1) return 0;
+  const uint8_t regCount = data[0];
+  const size_t len = size - 1;
+  uint8_t *frame = static_cast<uint8_t*>(malloc(len ? len : 1));
+  if (len) memcpy(frame, data + 1, len);
+
+  if (len >= 2) parse(frame, len, frame[0], frame[1], regCount);
+  parse(frame, len, 1, MODBUS_FC_READ_HOLDING, regCount);
+  parse(frame, len, 1, MODBUS_FC_READ_INPUT, regCount);
+
+  free(frame);
+  return 0;
+}
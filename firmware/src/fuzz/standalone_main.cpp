@@ -0,0 +1,55 @@
+// Corpus replay driver for the fuzz targets when the compiler has no
+// libFuzzer (gcc): fuzz/toolchain.py defines ORCA_FUZZ_STANDALONE and links
+// this main, which runs every file given, or found under a directory given,
+// through LLVMFuzzerTestOneInput() once under ASan/UBSan.
+//
+//   program fuzz/corpus/cmd_parse [crash-...]
+#if defined(ORCA_FUZZ_STANDALONE)
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+namespace {
+
+bool runFile(const std::filesystem::path& path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    fprintf(stderr, "%s: cannot open\n", path.c_str());
+    return false;
+  }
+  const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  LLVMFuzzerTestOneInput(bytes.data(), bytes.size());
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  size_t inputs = 0;
+  bool ok = true;
+  for (int i = 1; i < argc; ++i) {
+    const std::filesystem::path path(argv[i]);
+    if (std::filesystem::is_directory(path)) {
+      for (const auto& entry : std::filesystem::recursive_directory_iterator(path)) {
+        if (!entry.is_regular_file()) continue;
+        ok = runFile(entry.path()) && ok;
+        ++inputs;
+      }
+    } else {
+      ok = runFile(path) && ok;
+      ++inputs;
+    }
+  }
+  printf("# ran %zu inputs\n", inputs);
+  return ok ? 0 : 2;
+}
+
+#endif  // ORCA_FUZZ_STANDALONE
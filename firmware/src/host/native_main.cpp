@@ -0,0 +1,118 @@
+// [env:native] entry point: a line-oriented driver for the portable firmware
+// modules, so they can be exercised on a PC without the Mega.
+//
+//   crc <hex bytes>                      Modbus CRC16 of the bytes
+//   modbus <slave> <fc> <regs> <hex>     validate and decode a read reply
+//   float <text>                         command-argument number parser
+//   floats <count> <text>                command-argument list parser
+//   json <value> <digits>                telemetry number formatting
+//   auto <thi> <hfe> <goal> <limit> <approach> <hysteresis>
+//                                        one auto valve decision (latch persists)
+#include "auto_valve.h"
+#include "cmd_parse.h"
+#include "hal_host.h"
+#include "modbus_rtu.h"
+#include "telemetry_fmt.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+bool parseHex(const std::string& text, std::vector<uint8_t> *out) {
+  std::string digits;
+  for (char c : text) {
+    if (isxdigit(static_cast<unsigned char>(c))) digits += c;
+    else if (c != ' ' && c != ':') return false;
+  }
+  if (digits.size() % 2) return false;
+  out->clear();
+  for (size_t i = 0; i < digits.size(); i += 2) {
+    out->push_back(static_cast<uint8_t>(strtoul(digits.substr(i, 2).c_str(), nullptr, 16)));
+  }
+  return true;
+}
+
+std::string restOf(std::istringstream& in) {
+  std::string rest;
+  std::getline(in, rest);
+  return rest;
+}
+
+bool g_close_latched = true;
+AutoValveStatus g_status = autoValveInitialStatus();
+
+void runLine(const std::string& line) {
+  std::istringstream in(line);
+  std::string cmd;
+  if (!(in >> cmd) || cmd[0] == '#') return;
+
+  if (cmd == "crc") {
+    std::vector<uint8_t> bytes;
+    if (!parseHex(restOf(in), &bytes)) { puts("error bad_hex"); return; }
+    printf("%04X\n", modbusCRC(bytes.data(), bytes.size()));
+  } else if (cmd == "modbus") {
+    unsigned slave = 0, fc = 0, regs = 0;
+    std::vector<uint8_t> bytes;
+    if (!(in >> slave >> fc >> regs) || slave > 0xFF || fc > 0xFF || regs == 0 || regs > MODBUS_MAX_READ_REGS) {
+      puts("error usage");
+      return;
+    }
+    if (!parseHex(restOf(in), &bytes)) { puts("error usage"); return; }
+    uint16_t vals[MODBUS_MAX_READ_REGS];
+    if (!modbusParseReadReply(bytes.data(), bytes.size(), slave, fc, regs, vals)) { puts("invalid"); return; }
+    for (unsigned i = 0; i < regs; ++i) printf(i ? " %u" : "%u", vals[i]);
+    putchar('\n');
+  } else if (cmd == "float") {
+    const std::string text = restOf(in);
+    float v = NAN;
+    if (parseFloatText(text.c_str(), text.size(), &v)) printf("%.7g\n", v);
+    else puts("invalid");
+  } else if (cmd == "floats") {
+    size_t count = 0;
+    if (!(in >> count) || count == 0 || count > 16) { puts("error usage"); return; }
+    const std::string text = restOf(in);
+    float vals[16];
+    if (!parseFloatList(text.c_str(), text.size(), vals, count)) { puts("invalid"); return; }
+    for (size_t i = 0; i < count; ++i) printf(i ? " %.7g" : "%.7g", vals[i]);
+    putchar('\n');
+  } else if (cmd == "json") {
+    std::string valueText;
+    unsigned digits = 2;
+    in >> valueText >> digits;
+    const float value = strtof(valueText.c_str(), nullptr);
+    char buf[TELEMETRY_NUMBER_MAX];
+    formatJsonFloat(buf, value, static_cast<uint8_t>(digits));
+    puts(buf);
+  } else if (cmd == "auto") {
+    float thi = NAN, hfe = NAN;
+    AutoValveTargets targets = {};
+    std::string thiText, hfeText;
+    if (!(in >> thiText >> hfeText >> targets.hfeGoalC >> targets.hxLimitC >>
+          targets.hxApproachC >> targets.hysteresisC)) {
+      puts("error usage");
+      return;
+    }
+    if (thiText != "nan") thi = strtof(thiText.c_str(), nullptr);
+    if (hfeText != "nan") hfe = strtof(hfeText.c_str(), nullptr);
+    updateAutoValveStatusFromValues(&g_status, targets, thi, hfe);
+    const bool open = autoValveDecide(g_status, &g_close_latched);
+    printf("%s %s\n", open ? "open" : "closed", autoCloseReasonKey(g_status.reason));
+  } else {
+    printf("error unknown_command %s\n", cmd.c_str());
+  }
+}
+
+}  // namespace
+
+int main() {
+  std::string line;
+  while (std::getline(std::cin, line)) runLine(line);
+  return 0;
+}
@@ -1,35 +1,35 @@
 #include <Arduino.h>
 #include <Wire.h>
 #include <Adafruit_MAX31856.h>
+#include <EEPROM.h>
+#include <avr/wdt.h>
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
+#include <util/atomic.h>
+
+#include "auto_valve.h"
+#include "channel_map.h"
+#include "cmd_parse.h"
+#include "control_defaults.h"
+#include "hal.h"
+#include "modbus_rtu.h"
+#include "safety_law.h"
+#include "tc_acquisition.h"
+#include "telemetry_fmt.h"
 
 // ── Shared software-SPI pins ─────────────────────────────────────────────
 constexpr int SCK_PIN  = 8;   // CLK
 constexpr int MOSI_PIN = 2;   // DI  (MCU -> MAX31856)
 constexpr int MISO_PIN = 22;  // DO  (MAX31856 -> MCU)
 
-// ── CS pins for U0..U9 (U9 on D48) ───────────────────────────────────────
-constexpr uint8_t CS_PINS[] = { 9, 3, 23, 31, 39, 47, 30, 38, 46, 48 };
-// Installed probes are T-type everywhere except the HX probes on U8/U9.
-// Leave unused channels on the default K-type unless/until wiring is assigned.
-constexpr max31856_thermocoupletype_t TC_TYPES[] = {
-  MAX31856_TCTYPE_K, // U0 / THR
-  MAX31856_TCTYPE_K, // U1 (unused)
-  MAX31856_TCTYPE_K, // U2 / TTEST
-  MAX31856_TCTYPE_T, // U3 / TFO
-  MAX31856_TCTYPE_T, // U4 / TTI
-  MAX31856_TCTYPE_K, // U5 / TNO
-  MAX31856_TCTYPE_T, // U6 / TTO
-  MAX31856_TCTYPE_T, // U7 / TMI
-  MAX31856_TCTYPE_K, // U8 / THM
-  MAX31856_TCTYPE_K, // U9 / THI
-};
-constexpr size_t  NUM_TCS   = sizeof(CS_PINS) / sizeof(CS_PINS[0]);
-
-// ── Always emit 10 columns: temp0_C .. temp9_C ───────────────────────────
-constexpr size_t MAX_TCS_OUT = 10;
+// ── Thermocouple channels U0.. ───────────────────────────────────────────
+// CS pins, types and the calibration/acquisition parameter defaults are the
+// generated TC_CHANNELS[] (channel_map.h from config/channels.yaml).
+// The count sizes the acquisition engine, the per-channel parameters and
+// telemetry temps[]/temps_raw[], which carry exactly NUM_TCS entries.
+constexpr size_t  NUM_TCS              = TC_CHANNEL_COUNT;
+constexpr uint8_t DEFAULT_TC_FILTER_HZ = 60;
 
 // ── Valve output ─────────────────────────────────────────────────────────
 constexpr int VALVE_PIN = 7;
@@ -39,9 +39,18 @@ constexpr int SCALE_DIGITAL_OUTPUT = 36; // RSV scale output
 constexpr int SCALE_DIGITAL_INPUT = 28; // RSV scale input
 constexpr int   RSV_SCALE_DATA_PIN = SCALE_DIGITAL_OUTPUT;
 constexpr int   RSV_SCALE_CLOCK_PIN = SCALE_DIGITAL_INPUT;
-constexpr long  RSV_SCALE_TARE_COUNTS = -24745L;
-constexpr float RSV_SCALE_COUNTS_PER_KG = 10192.8f; // calibrated from raw -24745 empty and 30296 at 5.4 kg
-constexpr unsigned long RSV_SCALE_TIMEOUT_US = 50000UL;
+constexpr long  DEFAULT_RSV_SCALE_TARE_COUNTS = -24745L;
+constexpr float DEFAULT_RSV_SCALE_COUNTS_PER_KG = 10192.8f; // calibrated from raw -24745 empty and 30296 at 5.4 kg
+constexpr unsigned long RSV_SCALE_STALE_MS = 500UL;  // no HX711 sample for this long -> timeout
+constexpr uint8_t RSV_SCALE_RING_SIZE = 32;           // 400 ms at 80 SPS
+// Streaming filter: median-of-5 spike rejection, then an EMA with a 2 s time constant.
+constexpr uint8_t RSV_SCALE_MEDIAN_N = 5;
+constexpr float   RSV_SCALE_EMA_TAU_S = 2.0f;
+constexpr float   RSV_SCALE_SPIKE_KG = 0.05f;             // sample this far from the median counts as a spike
+// Mass-rate regression over 1 min bin means, 1 h window.
+constexpr unsigned long RSV_SCALE_RATE_BIN_MS = 60000UL;
+constexpr uint8_t RSV_SCALE_RATE_BINS = 60;
+constexpr uint8_t RSV_SCALE_RATE_MIN_BINS = 5;
 // Invalid HX711 frames seen when the data line is floating/glitching. Without this guard,
 // raw -1 would be converted to about 2.3 kg with the current tare/slope.
 constexpr long RSV_SCALE_RAW_ALL_HIGH = -1L;
@@ -51,6 +60,22 @@ constexpr long RSV_SCALE_RAW_ALL_LOW = 0L;
 constexpr int HEATER_BOTTOM_PIN = 11;  // tank bottom heater relay
 constexpr int HEATER_EXHAUST_PIN = 5;  // LN exhaust heater relay
 
+// Thermostatic auto mode defaults. Manual ON/OFF remains the power-up state.
+constexpr size_t DEFAULT_HEATER_BOTTOM_SENSOR_INDEX  = TC_CH_THR;
+constexpr float  DEFAULT_HEATER_BOTTOM_SETPOINT_C    = 20.0f;    // °C, warmup target
+constexpr unsigned long DEFAULT_HEATER_BOTTOM_MAX_ON_MS = 900000UL;  // 15 min continuous
+constexpr size_t DEFAULT_HEATER_EXHAUST_SENSOR_INDEX = TC_CH_TNO;
+constexpr float  DEFAULT_HEATER_EXHAUST_SETPOINT_C   = 0.0f;     // °C, keep exhaust above icing
+constexpr unsigned long DEFAULT_HEATER_EXHAUST_MAX_ON_MS = 600000UL; // 10 min continuous
+constexpr float  DEFAULT_HEATER_BAND_C               = 2.0f;     // °C, on below setpoint - band
+constexpr float  DEFAULT_HEATER_KP_PER_C             = 0.10f;    // duty per °C of error
+constexpr float  DEFAULT_HEATER_KI_PER_C_S           = 0.001f;   // duty per °C·s of error
+constexpr unsigned long DEFAULT_HEATER_WINDOW_MS     = 30000UL;  // relay time-proportioning window
+constexpr unsigned long HEATER_MIN_WINDOW_MS         = 5000UL;   // keep relay cycling slow
+constexpr unsigned long HEATER_MAX_WINDOW_MS         = 600000UL; // 10 min
+constexpr unsigned long HEATER_MIN_MAX_ON_MS         = 1000UL;   // max-on interlock cannot be disabled
+constexpr unsigned long HEATER_MAX_MAX_ON_MS         = 14400000UL; // 4 h
+
 // ── Pump / VFD (Fuji FRENIC-Mini) ────────────────────────────────────────
 constexpr uint8_t  PWM_PIN           = 6;       // OC4A on Arduino Mega
 constexpr uint16_t PWM_TOP           = 999;     // 2 kHz with prescaler 8
@@ -66,11 +91,13 @@ constexpr float    MOTOR_EST_RPM_PER_HZ = 30.0f; // 4-pole motor estimate; actua
 constexpr uint8_t  VFD_SLAVE_ADDR    = 1;       // y01
 constexpr uint32_t VFD_BAUD          = 9600;    // y04
 constexpr unsigned long VFD_POLL_MS  = 1000UL;  // poll VFD monitor registers once per second
+constexpr uint32_t VFD_REPLY_TIMEOUT_MS  = 200;
 
 // Flow Velocity, Volume Flow, Mass Flow, Temperature, Density.
 constexpr uint8_t  FLOW_SLAVE_ADDR   = 1;
 constexpr uint32_t FLOW_BAUD         = 19200;
 constexpr unsigned long FLOW_POLL_MS = 1000UL;
+constexpr uint32_t FLOW_REPLY_TIMEOUT_MS = 250;
 constexpr uint16_t FLOW_REG_START    = 30000;   // 30000..30008, five floats
 constexpr uint8_t  FLOW_REG_COUNT    = 10;      // 10 x 16-bit regs = 5 x float32
 constexpr float    FLUID_CONC_PCT    = 100.0f;
@@ -80,14 +107,17 @@ constexpr char     FLUID_NAME[]      = "HFE-7200";
 constexpr uint8_t PRESSURE_PIN_BEFORE = A8;  // before pump
 constexpr uint8_t PRESSURE_PIN_AFTER  = A0;  // after pump
 constexpr uint8_t PRESSURE_PIN_TANK   = A1;  // tank
-constexpr float   PRESSURE_FSO_V      = 5.013f;   // full-scale output voltage
+constexpr float   DEFAULT_PRESSURE_FSO_V = 5.013f; // full-scale output voltage
 constexpr float   PRESSURE_FSO_BAR    = 10.0f;    // full-scale in bar (gauge)
 constexpr float   PRESSURE_ERR_BAR    = 0.05f;    // sensor accuracy (±)
 constexpr float   ADC_REF_V           = 5.0f;     // default analog reference (5 V)
 constexpr float   PSI_PER_BAR         = 14.5037738f;
 constexpr float   ATMOSPHERE_BAR      = 1.01325f; // add for absolute pressure display
-constexpr float   PRESSURE_AFTER_ZERO_V = 0.029f; // 1 atm output for after-pump sensor
-constexpr float   PUMP_DELTA_P_ESTOP_BAR = 8.0f;  // emergency-stop threshold for after-before pressure delta
+constexpr float   DEFAULT_PRESSURE_AFTER_ZERO_V = 0.029f; // 1 atm output for after-pump sensor
+constexpr uint8_t PUMP_DELTA_P_FAST_PERSIST_MS = 3; // ADC fast path: delta-P must stay above the limit this long
+constexpr float   TANK_PRESSURE_HIGH_BAR = 5.0f;  // tank over-pressure law (disabled until set for the installed tank)
+constexpr float   VFD_CURRENT_HIGH_A     = 3.74f;   // 110 % of motor FLA
+constexpr float   RSV_MASS_LOW_KG        = 1.0f;    // pump dry-run guard
 
 // Modbus group M registers (Fuji FRENIC-Mini)
 constexpr uint16_t REG_M09 = 0x0809;  // output frequency (0.01 Hz)
@@ -98,13 +128,43 @@ constexpr uint16_t REG_W05 = 0x0F05;  // output current (RTU format [19], engine
 constexpr uint16_t REG_W21 = 0x0F15;  // input power   (RTU format [24], engineering units)
 constexpr uint8_t  N_W_DRIVE_REG = 2; // W05–W06 inclusive
 
-// ── Control parameters ───────────────────────────────────────────────────
-constexpr float DEFAULT_HFE_GOAL_C           = -110.0f; // °C, LXe reference temperature
-constexpr float DEFAULT_HX_LIMIT_C           = -120.0f; // °C, HFE icing guard at THI
-constexpr float DEFAULT_LN_AUTO_HYSTERESIS_C = 0.5f;    // °C, HFE goal reopen margin
-constexpr float DEFAULT_HX_APPROACH_C        = 10.0f;   // °C, THI reopen margin below TMI
-constexpr size_t HFE_AUTO_SENSOR_INDEX       = 7;       // U7 = TMI
-constexpr size_t THI_SENSOR_INDEX            = 9;       // U9 = THI
+// ── Persistent parameters ────────────────────────────────────────────────
+// Calibration and auto targets, loaded from EEPROM at boot (see loadParams()).
+// Append new fields at the end: older blocks load their stored prefix and keep
+// defaults for the rest.
+struct ParamBlock {
+  uint16_t magic;
+  uint8_t  version;
+  uint8_t  length;              // bytes stored, including the trailing CRC
+  uint16_t seq;                 // commit counter; the newer of the two slots wins
+  uint32_t channelMap;          // TC_CHANNEL_MAP_CRC the per-channel fields were stored under
+  long     rsvScaleTareCounts;
+  float    rsvScaleCountsPerKg;
+  float    pressureAfterZeroV;
+  float    pressureFsoV;
+  uint8_t  tcTypes[NUM_TCS];
+  float    hfeGoalC;
+  float    hxLimitC;
+  float    hxApproachC;
+  float    lnAutoHysteresisC;
+  float    tcGain[NUM_TCS];
+  float    tcOffsetC[NUM_TCS];
+  uint8_t  tcAvg[NUM_TCS];       // samples averaged per conversion: 1/2/4/8/16
+  uint8_t  tcFilterHz[NUM_TCS];  // mains rejection: 50 or 60
+  uint16_t tcPeriodMs[NUM_TCS];  // read period, 0 = disabled
+  uint16_t crc;
+};
+
+static ParamBlock g_params = {};
+static bool          g_params_targets_dirty = false; // auto targets differ from EEPROM (autosaved)
+static bool          g_params_cal_dirty = false;     // other fields differ from EEPROM (PARAM COMMIT only)
+static unsigned long g_params_autosave_ms = 0;       // last target change awaiting autosave
+
+// Auto targets persist on their own after a quiet period (see persistParamsIfDue()).
+static void markTargetsChanged() {
+  g_params_targets_dirty = true;
+  g_params_autosave_ms = millis() | 1UL;
+}
 
 // ── Valve/override state ─────────────────────────────────────────────────
 enum ValveState   : uint8_t { CLOSED = 0, OPEN = 1 };
@@ -114,23 +174,383 @@ constexpr OverrideMode DEFAULT_VALVE_MODE = FORCE_CLOSE;
 
 static ValveState   g_valve = CLOSED;
 static OverrideMode g_mode  = DEFAULT_VALVE_MODE;
-static float        g_hfe_goal_c = DEFAULT_HFE_GOAL_C;
-static float        g_hx_limit_c = DEFAULT_HX_LIMIT_C;
-static float        g_ln_auto_hysteresis_c = DEFAULT_LN_AUTO_HYSTERESIS_C;
-static float        g_hx_approach_c = DEFAULT_HX_APPROACH_C;
 static bool         g_auto_close_latched = false;
 static bool         g_auto_status_sampled = false;
-static bool         g_heater_bottom_on = false;
-static bool         g_heater_exhaust_on = false;
 
-// ── Sensor objects (software SPI: (CS, DI, DO, CLK)) ─────────────────────
-static Adafruit_MAX31856* tc[NUM_TCS] = { nullptr };
+// ── Heater relays + thermostatic loops ──────────────────────────────────
+enum HeaterIndex : uint8_t {
+  HEATER_BOTTOM = 0,
+  HEATER_EXHAUST,
+};
+
+enum HeaterMode : uint8_t { HEATER_MANUAL = 0, HEATER_AUTO = 1 };
+enum HeaterLaw  : uint8_t { HEATER_LAW_HYSTERESIS = 0, HEATER_LAW_PI = 1 };
+
+enum HeaterInterlock : uint8_t {
+  HEATER_INTERLOCK_NONE = 0,
+  HEATER_INTERLOCK_SAFETY,
+  HEATER_INTERLOCK_SENSOR_INVALID,
+  HEATER_INTERLOCK_MAX_ON_TIME,
+};
+
+struct HeaterLoop {
+  const char* key;
+  uint8_t pin;
+  volatile bool on;    // cleared by the control tick on a HEATERS_OFF law; switched via applyHeater()
+  HeaterMode mode;
+  HeaterLaw  law;
+  uint8_t sensorIndex;
+  float   setpointC;
+  float   bandC;
+  float   kpPerC;
+  float   kiPerCS;
+  unsigned long windowMs;
+  unsigned long maxOnMs;
+  float   tempC;
+  float   integral;    // PI integral term, duty fraction
+  float   duty;        // PI output, 0..1
+  unsigned long windowStartMs;
+  unsigned long onSinceMs;
+  unsigned long lastUpdateMs;
+  HeaterInterlock interlock;
+  bool    maxOnLatched;
+};
+
+static HeaterLoop g_heaters[] = {
+  { "bottom", HEATER_BOTTOM_PIN, false, HEATER_MANUAL, HEATER_LAW_HYSTERESIS,
+    DEFAULT_HEATER_BOTTOM_SENSOR_INDEX, DEFAULT_HEATER_BOTTOM_SETPOINT_C, DEFAULT_HEATER_BAND_C,
+    DEFAULT_HEATER_KP_PER_C, DEFAULT_HEATER_KI_PER_C_S, DEFAULT_HEATER_WINDOW_MS,
+    DEFAULT_HEATER_BOTTOM_MAX_ON_MS, NAN, 0.0f, 0.0f, 0, 0, 0, HEATER_INTERLOCK_NONE, false },
+  { "exhaust", HEATER_EXHAUST_PIN, false, HEATER_MANUAL, HEATER_LAW_HYSTERESIS,
+    DEFAULT_HEATER_EXHAUST_SENSOR_INDEX, DEFAULT_HEATER_EXHAUST_SETPOINT_C, DEFAULT_HEATER_BAND_C,
+    DEFAULT_HEATER_KP_PER_C, DEFAULT_HEATER_KI_PER_C_S, DEFAULT_HEATER_WINDOW_MS,
+    DEFAULT_HEATER_EXHAUST_MAX_ON_MS, NAN, 0.0f, 0.0f, 0, 0, 0, HEATER_INTERLOCK_NONE, false },
+};
+
+// ── Thermocouple acquisition (software SPI, one CS per chip) ─────────────
+// Every chip free-runs in continuous-conversion mode and is read at its own
+// period; the cold junction is read for one channel per second so the read
+// cost barely moves.
+constexpr unsigned long TC_POLL_MS = 20UL;     // acquisition task release
+constexpr uint8_t  TC_READS_PER_PASS = 2;      // bounds one pass to ~2 chip reads
+
+static TcAcquisitionEngine<NUM_TCS> g_tc;
+
+// Continuous-mode conversion time from the MAX31856 datasheet (max): 90/110 ms
+// for one sample at 60/50 Hz, plus 33.3/40 ms per extra averaged sample.
+static uint16_t tcConversionMs(uint8_t ch) {
+  const uint16_t extra = g_params.tcAvg[ch] > 1 ? g_params.tcAvg[ch] - 1 : 0;
+  if (g_params.tcFilterHz[ch] == 50) return 110 + extra * 40;
+  return 90 + (extra * 100 + 2) / 3;
+}
+
+// Reads faster than the chip converts would only repeat a sample.
+static uint16_t tcEffectivePeriodMs(uint8_t ch) {
+  if (ch >= NUM_TCS || !g_params.tcPeriodMs[ch]) return 0;
+  const uint16_t convMs = tcConversionMs(ch);
+  return g_params.tcPeriodMs[ch] > convMs ? g_params.tcPeriodMs[ch] : convMs;
+}
+
+// MAX31856 SR bits 0..7 (MAX31856_FAULT_OPEN .. MAX31856_FAULT_CJRANGE).
+static const char *const TC_FAULT_KEYS[8] = {
+  "open", "ovuv", "tc_low", "tc_high", "cj_low", "cj_high", "tc_range", "cj_range",
+};
+
+static void emitTcDiagFrame(unsigned long nowMs) {
+  g_tc.closeRateWindow(nowMs);
+  Serial.print(F("{\"type\":\"tc_diag\",\"t\":"));
+  Serial.print(nowMs / 1000.0f, 3);
+  Serial.print(F(",\"channels\":["));
+  for (uint8_t i = 0; i < NUM_TCS; ++i) {
+    TcDiag &diag = g_tc.diag(i);
+    const TcAcquisition &acq = g_tc.acquisition(i);
+    const uint16_t periodMs = acq.periodMs;
+    if (i) Serial.print(',');
+    Serial.print(F("{\"enabled\":"));
+    Serial.print(periodMs ? F("true") : F("false"));
+    Serial.print(F(",\"avg\":"));
+    Serial.print(g_params.tcAvg[i]);
+    Serial.print(F(",\"filter_hz\":"));
+    Serial.print(g_params.tcFilterHz[i]);
+    Serial.print(F(",\"conv_ms\":"));
+    Serial.print(tcConversionMs(i));
+    Serial.print(F(",\"period_ms\":"));
+    Serial.print(periodMs);
+    Serial.print(F(",\"rate_hz\":"));
+    Serial.print(acq.rateHz, 2);
+    Serial.print(F(",\"cj_c\":"));
+    if (isfinite(diag.cjC) && diag.cjMs) Serial.print(diag.cjC, 2); else Serial.print(F("null"));
+    Serial.print(F(",\"fault\":"));
+    Serial.print(diag.fault);
+    Serial.print(F(",\"flags\":["));
+    bool first = true;
+    for (uint8_t b = 0; b < 8; ++b) {
+      if (!(diag.faultsSeen & (1U << b))) continue;
+      if (!first) Serial.print(',');
+      first = false;
+      Serial.print('"');
+      Serial.print(TC_FAULT_KEYS[b]);
+      Serial.print('"');
+    }
+    Serial.print(F("],\"consecutive\":"));
+    Serial.print(diag.consecutiveFaults);
+    Serial.print(F(",\"max_consecutive\":"));
+    Serial.print(diag.maxConsecutiveFaults);
+    Serial.print(F(",\"fault_reads\":"));
+    Serial.print(diag.faultReads);
+    Serial.print(F(",\"last_good_age_s\":"));
+    if (diag.lastGoodMs) Serial.print((nowMs - diag.lastGoodMs) / 1000.0f, 1); else Serial.print(F("null"));
+    Serial.print('}');
+    diag.faultsSeen = diag.fault;
+  }
+  Serial.println(F("]}"));
+}
 
-// ── Timing ───────────────────────────────────────────────────────────────
-static unsigned long lastSample = 0;
-static unsigned long lastVfdPoll = 0;
-static unsigned long lastFlowPoll = 0;
+// ── Timing / cooperative scheduler ──────────────────────────────────────
 constexpr unsigned long SAMPLE_INTERVAL_MS = 1000UL;
+// Modbus polls are phased away from the sample tick so one pass never stacks all three.
+constexpr unsigned long VFD_POLL_PHASE_MS  = 250UL;
+constexpr unsigned long FLOW_POLL_PHASE_MS = 500UL;
+constexpr unsigned long CAPTURE_STREAM_MS  = 50UL;   // transient capture: one chunk per release
+constexpr unsigned long RSV_SCALE_DRAIN_MS = 100UL;  // HX711 ring drain (8 samples at 80 SPS)
+constexpr unsigned long TC_DIAG_REPORT_MS  = 10000UL;  // {"type":"tc_diag"} cadence
+constexpr unsigned long MEM_REPORT_MS      = 10000UL;  // {"type":"mem"} cadence
+
+enum SchedTaskIndex : uint8_t {
+  SCHED_TASK_COMMANDS = 0,
+  SCHED_TASK_SAMPLE,
+  SCHED_TASK_VFD,
+  SCHED_TASK_FLOW,
+  SCHED_TASK_PERF,
+  SCHED_TASK_CAPTURE,
+  SCHED_TASK_RSV_SCALE,
+  SCHED_TASK_TC_DIAG,
+  SCHED_TASK_TC,
+  SCHED_TASK_MEM,
+};
+
+struct SchedTask {
+  const char* key;
+  void (*run)(unsigned long nowMs);
+  unsigned long periodMs;   // 0 = run every loop() pass
+  unsigned long phaseMs;
+  uint8_t       priority;   // higher runs first within a pass
+  unsigned long budgetUs;
+  unsigned long releaseMs;  // next scheduled release
+  unsigned long lastUs;
+  unsigned long maxUs;
+  unsigned long avgUs;      // EMA, alpha = 1/8
+  unsigned long lastLateMs; // start latency behind the release time
+  unsigned long maxLateMs;
+  uint32_t      runs;
+  uint32_t      missed;     // releases skipped because the task started a full period late
+  uint32_t      overruns;   // runs that exceeded budgetUs
+};
+
+// ── Main-loop profiler ───────────────────────────────────────────────────
+constexpr unsigned long PERF_REPORT_MS = 10000UL;  // periodic compact perf frame
+
+enum PerfSection : uint8_t {
+  PERF_COMMANDS = 0,
+  PERF_TC_SWEEP,
+  PERF_PRESSURE_ADC,
+  PERF_VFD_M09,
+  PERF_VFD_W05,
+  PERF_VFD_W21,
+  PERF_FLOW_MODBUS,
+  PERF_RSV_SCALE_DRAIN,
+  PERF_RSV_SCALE_IRQ_OFF,
+  PERF_TELEMETRY,
+  PERF_CONTROL_TICK,
+  PERF_SAFETY_LAWS,
+  PERF_SECTION_COUNT,
+};
+
+static const char* const PERF_SECTION_KEYS[PERF_SECTION_COUNT] = {
+  "commands",
+  "tc_sweep",
+  "pressure_adc",
+  "vfd_m09",
+  "vfd_w05",
+  "vfd_w21",
+  "flow_modbus",
+  "rsv_scale_drain",
+  "rsv_scale_irq_off",
+  "telemetry",
+  "control_tick",
+  "safety_laws",
+};
+
+struct PerfStat {
+  uint32_t count;
+  uint32_t lastUs;
+  uint32_t windowMaxUs;  // max since the last periodic frame
+  uint32_t peakUs;       // max since boot / PERF RESET
+  uint32_t avgUs;        // EMA, alpha = 1/8
+};
+
+// Loop iteration histogram buckets: <256 us, <1 ms, <4 ms, <16 ms, <64 ms, <256 ms, <1 s, >=1 s.
+constexpr uint8_t PERF_LOOP_BUCKETS = 8;
+
+struct LoopProfile {
+  unsigned long lastPassUs;
+  uint32_t passes;
+  uint32_t windowMaxUs;
+  uint32_t peakUs;
+  uint32_t avgUs;
+  uint32_t hist[PERF_LOOP_BUCKETS];
+};
+
+// One writer per section: control_tick, pressure_adc and safety_laws are
+// recorded by the Timer5 control tick, the rest by the main loop (no other
+// ISR records). Loop-side reads and resets go through ATOMIC_BLOCK.
+static PerfStat    g_perf[PERF_SECTION_COUNT] = {};
+static LoopProfile g_loop_profile = {};
+
+static void perfRecord(PerfSection section, uint32_t elapsedUs) {
+  PerfStat &stat = g_perf[section];
+  stat.lastUs = elapsedUs;
+  if (elapsedUs > stat.windowMaxUs) stat.windowMaxUs = elapsedUs;
+  if (elapsedUs > stat.peakUs) stat.peakUs = elapsedUs;
+  stat.avgUs = stat.count ? (stat.avgUs - (stat.avgUs >> 3) + (elapsedUs >> 3)) : elapsedUs;
+  ++stat.count;
+}
+
+// Scoped timer: records the enclosing block's wall time in µs.
+struct PerfScope {
+  PerfSection section;
+  unsigned long startUs;
+  explicit PerfScope(PerfSection s) : section(s), startUs(micros()) {}
+  ~PerfScope() { perfRecord(section, micros() - startUs); }
+};
+
+// ── Watchdog supervisor ──────────────────────────────────────────────────
+// The hardware WDT is only kicked while every stage below has checked in within
+// its deadline. First timeout (interrupt) forces safe outputs; the second resets.
+enum WdtStage : uint8_t {
+  WDT_STAGE_NONE = 0,
+  WDT_STAGE_TC_SWEEP,
+  WDT_STAGE_VFD,
+  WDT_STAGE_FLOW,
+  WDT_STAGE_TELEMETRY,
+  WDT_STAGE_CONTROL_TICK,
+  WDT_STAGE_COUNT,
+};
+
+static const char* const WDT_STAGE_KEYS[WDT_STAGE_COUNT] = {
+  "none",
+  "tc_sweep",
+  "vfd",
+  "flow",
+  "telemetry",
+  "control_tick",
+};
+
+static const unsigned long WDT_STAGE_DEADLINE_MS[WDT_STAGE_COUNT] = {
+  0UL,     // none
+  5000UL,  // tc_sweep
+  5000UL,  // vfd
+  5000UL,  // flow
+  5000UL,  // telemetry
+  500UL,   // control_tick
+};
+
+// WDTO_1S, kicked between scheduler tasks: each blocking task must fit on its own.
+constexpr unsigned long WDT_TIMEOUT_MS = 1000UL;
+static_assert(3 * VFD_REPLY_TIMEOUT_MS <= WDT_TIMEOUT_MS * 3 / 4, "pollVfd's three timed-out reads must fit inside the WDT");
+static_assert(FLOW_REPLY_TIMEOUT_MS <= WDT_TIMEOUT_MS * 3 / 4, "pollFlowMeter's timed-out read must fit inside the WDT");
+
+constexpr uint16_t WDT_NOINIT_MAGIC   = 0x5744;  // "WD"
+constexpr int      EEPROM_RESET_RECORD_ADDR = 0;
+constexpr uint8_t  RESET_RECORD_MAGIC   = 0xA5;
+constexpr uint8_t  RESET_RECORD_VERSION = 1;
+// Parameter block: two slots written alternately, so a power loss mid-write
+// leaves the previous commit intact.
+// The per-channel arrays tie the block to the channel map: the header carries
+// TC_CHANNEL_MAP_CRC, and a block stored under another map (a different
+// count, order, pin or type) is rejected, so the firmware starts from the
+// generated defaults rather than read shifted or reassigned fields. Larger
+// counts take a bigger slot; `length` and the ParamDesc offsets are bytes.
+constexpr int      EEPROM_PARAM_ADDR = 32;
+constexpr int      EEPROM_PARAM_SLOT_BYTES = sizeof(ParamBlock) <= 192 ? 192 : 255;
+constexpr uint16_t PARAM_MAGIC = 0x5052;    // "PR"
+constexpr uint8_t  PARAM_VERSION = 2;       // bump only for incompatible layout changes (2: channelMap)
+constexpr unsigned long PARAM_AUTOSAVE_MS = 10000UL;
+static_assert(sizeof(ParamBlock) <= EEPROM_PARAM_SLOT_BYTES, "ParamBlock outgrew its EEPROM slot (16 channels at most)");
+
+// Survives a watchdog reset (not cleared by the C runtime).
+struct WdtNoinit {
+  uint16_t magic;
+  uint8_t  activeStage;  // stage executing when the loop last entered one
+  uint8_t  missedStage;  // stage the supervisor saw miss its deadline
+};
+
+struct ResetRecord {
+  uint8_t  magic;
+  uint8_t  version;
+  uint8_t  mcusr;
+  uint8_t  stage;
+  uint16_t bootCount;
+  uint16_t watchdogResets;
+};
+
+static WdtNoinit g_wdt_noinit __attribute__((section(".noinit")));
+static uint8_t   g_mcusr_at_boot __attribute__((section(".noinit")));
+static volatile unsigned long g_wdt_checkin_ms[WDT_STAGE_COUNT] = {};
+static volatile bool g_wdt_expired = false;
+static bool        g_wdt_enabled = false;
+static ResetRecord g_reset_record = {};
+static bool        g_reset_reported = false;
+
+// Runs before main(): keep MCUSR for reporting and stop a pending watchdog from
+// looping the board while setup() is still initialising.
+void wdtCaptureResetCause() __attribute__((naked, used, section(".init3")));
+void wdtCaptureResetCause() {
+  g_mcusr_at_boot = MCUSR;
+  MCUSR = 0;
+  wdt_disable();
+}
+
+static void wdtCheckin(WdtStage stage) {
+  const unsigned long nowMs = millis();
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    g_wdt_checkin_ms[stage] = nowMs;
+  }
+}
+
+// Marks the stage in progress so a hang inside it is attributed after reset.
+struct WdtStageScope {
+  WdtStage stage;
+  explicit WdtStageScope(WdtStage s) : stage(s) { g_wdt_noinit.activeStage = s; }
+  ~WdtStageScope() {
+    g_wdt_noinit.activeStage = WDT_STAGE_NONE;
+    wdtCheckin(stage);
+  }
+};
+
+static void taskSerialCommands(unsigned long nowMs);
+static void taskSample(unsigned long nowMs);
+static void taskPollVfd(unsigned long nowMs);
+static void taskPollFlow(unsigned long nowMs);
+static void taskPerfReport(unsigned long nowMs);
+static void taskCaptureStream(unsigned long nowMs);
+static void taskRsvScale(unsigned long nowMs);
+static void taskTcDiagReport(unsigned long nowMs);
+static void taskTcAcquire(unsigned long nowMs);
+static void taskMemReport(unsigned long nowMs);
+
+static SchedTask g_sched_tasks[] = {
+  { "commands", taskSerialCommands, 0UL,                0UL,                3,   5000UL, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+  { "sample",   taskSample,         SAMPLE_INTERVAL_MS, 0UL,                2, 320000UL, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+  { "vfd",      taskPollVfd,        VFD_POLL_MS,        VFD_POLL_PHASE_MS,  1, 150000UL, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+  { "flow",     taskPollFlow,       FLOW_POLL_MS,       FLOW_POLL_PHASE_MS, 0,  60000UL, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+  { "perf",     taskPerfReport,     PERF_REPORT_MS,     750UL,              0,  20000UL, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+  { "capture",  taskCaptureStream,  CAPTURE_STREAM_MS,  100UL,              0,  20000UL, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+  { "rsv_scale", taskRsvScale,      RSV_SCALE_DRAIN_MS, 0UL,                1,   2000UL, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+  { "tc_diag",  taskTcDiagReport,   TC_DIAG_REPORT_MS,  5250UL,             0,  60000UL, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+  { "tc",       taskTcAcquire,      TC_POLL_MS,         10UL,               2,   8000UL, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+  { "mem",      taskMemReport,      MEM_REPORT_MS,      2750UL,             0,   5000UL, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+};
 
 // ── Pump / VFD state ─────────────────────────────────────────────────────
 HardwareSerial &VFD = Serial3;
@@ -150,7 +570,8 @@ struct VfdSnapshot {
 };
 
 static VfdSnapshot g_vfd = { false, NAN, NAN, NAN, NAN, NAN, NAN, NAN, NAN, 0 };
-static float       g_pump_cmd_pct = 0.0f;
+static volatile float g_pump_cmd_pct = 0.0f;  // written in the control tick on a pump stop
+static volatile uint8_t g_pump_duty_half_pct = 0;  // applied PWM duty in 0.5 % steps, for the capture ring
 
 struct FlowSnapshot {
   bool   valid;
@@ -177,31 +598,31 @@ struct RsvScaleSnapshot {
   RsvScaleError error;
   float massKg;
   unsigned long lastReadMs;
+  unsigned long lastSampleMs;
+  uint32_t samples;
+  float rateHz;
 };
 
-static RsvScaleSnapshot g_rsv_scale = { false, 0L, 0L, RSV_SCALE_TIMEOUT, NAN, 0 };
-
-enum AutoCloseReason : uint8_t {
-  AUTO_CLOSE_NONE = 0,
-  AUTO_CLOSE_MISSING_THI,
-  AUTO_CLOSE_MISSING_HFE_TEMP,
-  AUTO_CLOSE_THI_LIMIT,
-  AUTO_CLOSE_HFE_GOAL,
+static RsvScaleSnapshot g_rsv_scale = { false, 0L, 0L, RSV_SCALE_TIMEOUT, NAN, 0, 0, 0, NAN };
+
+struct RsvScaleFilter {
+  float    window[RSV_SCALE_MEDIAN_N];
+  uint8_t  windowHead;
+  uint8_t  windowCount;
+  float    filteredKg;
+  uint32_t spikes;
+  float    binSumKg;
+  uint16_t binCount;
+  unsigned long binStartMs;
+  float    bins[RSV_SCALE_RATE_BINS];  // per-minute means of the median output, NAN if empty
+  uint8_t  binHead;
+  uint8_t  binFilled;
+  uint8_t  ratePoints;
+  float    rateKgH;
+  float    rateSigmaKgH;
 };
 
-struct AutoValveStatus {
-  bool thiValid;
-  bool hfeValid;
-  bool closeRequested;
-  bool readyToOpen;
-  AutoCloseReason reason;
-  float thiTempC;
-  float hfeTempC;
-  float thiCloseThresholdC;
-  float hfeCloseThresholdC;
-  float thiReopenThresholdC;
-  float hfeReopenThresholdC;
-};
+static RsvScaleFilter g_rsv_filter = {};
 
 static AutoValveStatus g_auto_status = {
   false,
@@ -217,48 +638,499 @@ static AutoValveStatus g_auto_status = {
   DEFAULT_HFE_GOAL_C + DEFAULT_LN_AUTO_HYSTERESIS_C,
 };
 
+// ── Safety laws ──────────────────────────────────────────────────────────
+// Each law watches one signal against a limit, optionally with a persistence time and a
+// rate-of-change limit, and maps to a set of actions. Latching laws trip the emergency stop
+// (ESTOP RESET clears it once safe); auto-reset laws hold their actions only while active.
+// All laws are evaluated in one pass per control tick.
+constexpr uint8_t SAFETY_SIGNAL_POLLED_FIRST = SAFETY_SIGNAL_FLOW_MASS_KGS;
+constexpr uint8_t SAFETY_SIGNAL_POLLED_COUNT = SAFETY_SIGNAL_COUNT - SAFETY_SIGNAL_POLLED_FIRST;
+
+static const char* const SAFETY_SIGNAL_KEYS[SAFETY_SIGNAL_COUNT] = {
+  "tc",
+  "pressure_before",
+  "pressure_after",
+  "pressure_tank",
+  "delta_p",
+  "flow_mass",
+  "vfd_current",
+  "vfd_power",
+  "rsv_mass",
+};
+
+static const char* const SAFETY_SIGNAL_UNITS[SAFETY_SIGNAL_COUNT] = {
+  "C", "bar", "bar", "bar", "bar", "kg/s", "A", "W", "kg",
+};
+
+// Table positions referenced directly (the ADC fast path for delta-P).
 enum SafetyLawIndex : uint8_t {
   SAFETY_LAW_PUMP_DELTA_P_HIGH = 0,
 };
 
-struct SafetyLawState {
-  const char* key;
-  const char* label;
-  bool  enabled;
-  bool  active;
-  bool  tripped;
-  float limitBar;
-  float valueBar;
-};
+#define SAFETY_LAW(key, label, signal, channel, compare, enabled, limit, rate, persistMs, actions, latch, band, holdMs) \
+  { key, label, signal, channel, compare, enabled, limit, rate, persistMs, actions, latch, band, holdMs, \
+    false, false, false, NAN, NAN, NAN, 0, 0, 0 }
 
 static SafetyLawState g_safety_laws[] = {
-  { "pump_delta_p_high", "Pump delta P high", true, false, false, PUMP_DELTA_P_ESTOP_BAR, NAN },
+  SAFETY_LAW("pump_delta_p_high", "Pump delta P high", SAFETY_SIGNAL_DELTA_P_BAR, 0, SAFETY_ABOVE,
+             true, PUMP_DELTA_P_ESTOP_BAR, NAN, 0, SAFETY_ACTION_PUMP_STOP, SAFETY_LATCH, 0.0f, 0),
+  SAFETY_LAW("tank_pressure_high", "Tank pressure high", SAFETY_SIGNAL_PRESSURE_TANK_BAR, 0, SAFETY_ABOVE,
+             false, TANK_PRESSURE_HIGH_BAR, NAN, 500,
+             SAFETY_ACTION_PUMP_STOP | SAFETY_ACTION_VALVE_CLOSE | SAFETY_ACTION_HEATERS_OFF, SAFETY_LATCH, 0.0f, 0),
+  SAFETY_LAW("thi_freeze_risk", "THI freeze risk", SAFETY_SIGNAL_TC, THI_SENSOR_INDEX, SAFETY_BELOW,
+             true, THI_FREEZE_RISK_C, NAN, 2000, SAFETY_ACTION_VALVE_CLOSE, SAFETY_AUTO_RESET,
+             THI_FREEZE_RISK_CLEAR_C, THI_FREEZE_RISK_HOLD_MS),
+  SAFETY_LAW("thi_stale", "THI reading stale", SAFETY_SIGNAL_TC, THI_SENSOR_INDEX, SAFETY_STALE,
+             false, 5.0f, NAN, 0, SAFETY_ACTION_VALVE_CLOSE, SAFETY_AUTO_RESET, 0.0f, 0),
+  SAFETY_LAW("vfd_current_high", "VFD current high", SAFETY_SIGNAL_VFD_CURRENT_A, 0, SAFETY_ABOVE,
+             false, VFD_CURRENT_HIGH_A, NAN, 2000, SAFETY_ACTION_PUMP_STOP, SAFETY_LATCH, 0.0f, 0),
+  SAFETY_LAW("rsv_mass_low", "Reservoir mass low", SAFETY_SIGNAL_RSV_MASS_KG, 0, SAFETY_BELOW,
+             false, RSV_MASS_LOW_KG, NAN, 5000,
+             SAFETY_ACTION_PUMP_STOP | SAFETY_ACTION_HEATERS_OFF, SAFETY_LATCH, 0.0f, 0),
 };
 
+static_assert(sizeof(g_safety_laws) / sizeof(g_safety_laws[0]) <= 8,
+              "safety report mask holds at most 8 laws");
+
 static bool          g_emergency_stop_latched = false;
 static unsigned long g_emergency_stop_ms = 0;
+static volatile uint8_t g_safety_actions = 0;        // union of actions held by tripped/active laws
+static volatile uint8_t g_safety_report_mask = 0;    // laws that changed in the tick, printed by loop()
+
+// ── Timer-driven control tick ────────────────────────────────────────────
+// Timer5 (CTC) runs the safety laws and valve decision at a fixed rate against the
+// latest cached inputs, so reaction time does not depend on Modbus or serial stalls.
+// Timer4 is the pump PWM; Timer0 is millis().
+constexpr uint16_t CONTROL_TICK_PRESCALER = 64;
+
+struct ControlCache {
+  float    temps[NUM_TCS];  // published per channel by the TC acquisition task
+  unsigned long tempsValidMs[NUM_TCS];
+  bool     tempsPublished;
+  float    polled[SAFETY_SIGNAL_POLLED_COUNT];  // VFD/flow/scale values published by loop()
+  unsigned long polledValidMs[SAFETY_SIGNAL_POLLED_COUNT];
+  float    pressureBeforeVolts;
+  float    pressureAfterVolts;
+  float    pressureTankVolts;
+  float    pressureBeforeBar;
+  float    pressureAfterBar;
+  float    pressureTankBar;
+  uint32_t ticks;
+  uint16_t overruns;  // ticks dropped because the previous tick was still running
+};
 
-// ── Helpers ──────────────────────────────────────────────────────────────
-static float readPressureVolts(uint8_t pin) {
-  int raw = analogRead(pin);
-  if (raw < 0 || raw > 1023) return NAN;
-  return raw * (ADC_REF_V / 1023.0f);
+static ControlCache  g_ctl = {};
+static volatile bool g_control_tick_busy = false;
+
+// ── HX711 reservoir scale reader ─────────────────────────────────────────
+// DOUT going low marks a conversion ready; the 25 clocks are issued with direct port
+// I/O and interrupts off (~20 us), so the scale runs at its full 10 or 80 SPS without
+// busy-waiting. DOUT pins with a pin-change interrupt are read from it; other pins
+// (the current D36 wiring) are polled from loop() between scheduler tasks, keeping the
+// clocking out of the ADC interrupt.
+struct Hx711Reader {
+  volatile uint8_t *dataIn;
+  uint8_t  dataMask;
+  volatile uint8_t *clockOut;
+  uint8_t  clockMask;
+  uint8_t  pcifrMask;         // 0 when polled from loop()
+  volatile long    ring[RSV_SCALE_RING_SIZE];
+  volatile uint8_t head;
+  volatile uint8_t tail;
+  volatile uint16_t overruns; // samples dropped because the ring was full
+  volatile unsigned long lastSampleMs;
+  volatile uint16_t irqOffUs; // last pin-change read, recorded into perf by the drain task
+};
+
+static Hx711Reader g_hx711 = {};
+
+static inline bool hx711Ready() {
+  return g_hx711.clockOut && !(*g_hx711.dataIn & g_hx711.dataMask);
+}
+
+// Clocks one sample into the ring. Interrupts must be off: a clock held high for
+// 60 us powers the HX711 down.
+static inline void hx711Read() {
+  uint32_t value = 0;
+  for (uint8_t i = 0; i < 25; ++i) {
+    *g_hx711.clockOut |= g_hx711.clockMask;
+    __asm__ __volatile__("nop\n\tnop\n\tnop\n\tnop\n\t");  // >= 0.2 us high, data valid after 0.1 us
+    if (i < 24) value = (value << 1) | ((*g_hx711.dataIn & g_hx711.dataMask) ? 1UL : 0UL);
+    *g_hx711.clockOut &= static_cast<uint8_t>(~g_hx711.clockMask);
+  }
+  // The 25th pulse selects channel A at gain 128 for the next conversion.
+  if (value & 0x800000UL) value |= 0xFF000000UL;
+
+  const uint8_t next = (g_hx711.head + 1) & (RSV_SCALE_RING_SIZE - 1);
+  if (next == g_hx711.tail) {
+    ++g_hx711.overruns;
+  } else {
+    g_hx711.ring[g_hx711.head] = static_cast<long>(value);
+    g_hx711.head = next;
+  }
+  g_hx711.lastSampleMs = millis();
+}
+
+static inline void hx711PinChangeIsr() {
+  if (!hx711Ready()) return;
+  const unsigned long startUs = micros();
+  hx711Read();
+  PCIFR = g_hx711.pcifrMask;  // DOUT toggled while clocking
+  g_hx711.irqOffUs = static_cast<uint16_t>(micros() - startUs);
+}
+
+ISR(PCINT0_vect) { hx711PinChangeIsr(); }
+ISR(PCINT1_vect) { hx711PinChangeIsr(); }
+ISR(PCINT2_vect) { hx711PinChangeIsr(); }
+
+// Polled DOUT: called from loop() between scheduler tasks.
+static void serviceRsvScaleReader() {
+  if (g_hx711.pcifrMask || !hx711Ready()) return;
+  const unsigned long startUs = micros();
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { hx711Read(); }
+  perfRecord(PERF_RSV_SCALE_IRQ_OFF, micros() - startUs);
+}
+
+static void setupRsvScaleReader() {
+  pinMode(RSV_SCALE_DATA_PIN, INPUT_PULLUP);
+  digitalWrite(RSV_SCALE_CLOCK_PIN, LOW);
+  pinMode(RSV_SCALE_CLOCK_PIN, OUTPUT);
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    g_hx711.dataIn = portInputRegister(digitalPinToPort(RSV_SCALE_DATA_PIN));
+    g_hx711.dataMask = digitalPinToBitMask(RSV_SCALE_DATA_PIN);
+    g_hx711.clockOut = portOutputRegister(digitalPinToPort(RSV_SCALE_CLOCK_PIN));
+    g_hx711.clockMask = digitalPinToBitMask(RSV_SCALE_CLOCK_PIN);
+
+    volatile uint8_t *pcicr = digitalPinToPCICR(RSV_SCALE_DATA_PIN);
+    if (pcicr) {
+      *digitalPinToPCMSK(RSV_SCALE_DATA_PIN) |= _BV(digitalPinToPCMSKbit(RSV_SCALE_DATA_PIN));
+      g_hx711.pcifrMask = _BV(digitalPinToPCICRbit(RSV_SCALE_DATA_PIN));
+      PCIFR = g_hx711.pcifrMask;
+      *pcicr |= g_hx711.pcifrMask;
+    } else {
+      g_hx711.pcifrMask = 0;
+    }
+  }
+}
+
+// ── Pressure ADC (free-running) ──────────────────────────────────────────
+// The ADC free-runs at prescaler 128 (~9.6 kHz) and the ISR round-robins the three
+// pressure inputs into per-channel rings (~3.2 kHz each). Each channel is also
+// oversampled and decimated: 4^k conversions are summed and shifted right by k for
+// 10 + k effective bits, which the control tick converts. The ISR itself runs the
+// pump delta-P limit on raw counts with a short persistence filter so a blocked line
+// stops the pump within a few ms.
+enum PressureChannel : uint8_t {
+  PRESSURE_CH_BEFORE = 0,
+  PRESSURE_CH_AFTER,
+  PRESSURE_CH_TANK,
+  PRESSURE_CH_COUNT,
+};
+
+static const uint8_t PRESSURE_CH_PINS[PRESSURE_CH_COUNT] = {
+  PRESSURE_PIN_BEFORE, PRESSURE_PIN_AFTER, PRESSURE_PIN_TANK,
+};
+
+constexpr uint8_t  PRESSURE_RING_SIZE   = 16;  // power of two
+constexpr uint8_t  PRESSURE_OVERSAMPLE_BITS_DEFAULT = 3;  // 64 conversions -> 13 bits, ~50 Hz per channel
+constexpr uint8_t  PRESSURE_OVERSAMPLE_BITS_MAX     = 4;
+constexpr uint32_t ADC_CONVERSION_HZ    = F_CPU / 128UL / 13UL;
+constexpr uint32_t PRESSURE_CH_SAMPLE_HZ = ADC_CONVERSION_HZ / PRESSURE_CH_COUNT;
+constexpr uint16_t PUMP_DELTA_P_FAST_PERSIST_SAMPLES =
+  static_cast<uint16_t>(PRESSURE_CH_SAMPLE_HZ * PUMP_DELTA_P_FAST_PERSIST_MS / 1000UL);
+
+constexpr float ADC_VOLTS_PER_COUNT = ADC_REF_V / 1023.0f;
+
+// Delta-P in Q16 bar straight from ADC counts (no deadbands), for the ISR.
+// Derived from the pressure calibration by applyPressureCalibration().
+struct DeltaPCoeffs {
+  int32_t beforeQ16;
+  int32_t afterQ16;
+  int32_t afterZeroQ16;
+};
+
+static DeltaPCoeffs g_dp_coeffs = {};
+
+struct PressureAdc {
+  uint16_t ring[PRESSURE_CH_COUNT][PRESSURE_RING_SIZE];
+  uint8_t  head[PRESSURE_CH_COUNT];
+  uint16_t latest[PRESSURE_CH_COUNT];
+  uint32_t accum[PRESSURE_CH_COUNT];
+  uint16_t accumCount[PRESSURE_CH_COUNT];
+  uint16_t decimated[PRESSURE_CH_COUNT];  // (10 + oversampleBits)-bit result
+  uint16_t outputs[PRESSURE_CH_COUNT];    // decimated results produced
+  uint8_t  oversampleBits;
+  uint32_t samples;           // conversions stored, all channels
+  uint8_t  runningCh;         // channel of the conversion in progress
+  uint8_t  nextCh;            // channel already loaded into ADMUX for the one after
+  int32_t  fastLimitQ16;      // 0 = fast delta-P path disabled
+  uint16_t fastAboveCount;
+  bool     fastTripPending;   // picked up by evaluateSafetyLaws()
+  int32_t  fastTripDeltaQ16;
+  uint16_t fastTrips;
+};
+
+static volatile PressureAdc g_padc = {};
+
+static void selectAdcChannel(uint8_t pin) {
+  const uint8_t ch = pin >= A0 ? pin - A0 : pin;
+  ADMUX  = _BV(REFS0) | (ch & 0x07);                      // AVcc reference
+  ADCSRB = (ch & 0x08) ? _BV(MUX5) : 0;                   // ADTS = 0: free running
+}
+
+static inline int32_t rawDeltaPQ16() {
+  return static_cast<int32_t>(g_padc.latest[PRESSURE_CH_AFTER]) * g_dp_coeffs.afterQ16 - g_dp_coeffs.afterZeroQ16
+         - static_cast<int32_t>(g_padc.latest[PRESSURE_CH_BEFORE]) * g_dp_coeffs.beforeQ16;
+}
+
+static inline void checkFastDeltaP() {
+  if (g_padc.fastLimitQ16 <= 0) return;
+  const int32_t deltaQ16 = rawDeltaPQ16();
+  if (deltaQ16 <= g_padc.fastLimitQ16) {
+    g_padc.fastAboveCount = 0;
+    return;
+  }
+  if (++g_padc.fastAboveCount < PUMP_DELTA_P_FAST_PERSIST_SAMPLES) return;
+  if (g_padc.fastTripPending || g_safety_laws[SAFETY_LAW_PUMP_DELTA_P_HIGH].tripped) return;
+
+  OCR4A = 0;  // pump PWM off now; the control tick latches the law and zeroes the command
+  g_pump_duty_half_pct = 0;
+  g_padc.fastTripPending = true;
+  g_padc.fastTripDeltaQ16 = deltaQ16;
+  ++g_padc.fastTrips;
+}
+
+// ── Transient capture ────────────────────────────────────────────────────
+// Static ring of raw pressure frames (one per `divider` ADC rounds) with pump duty and
+// valve/E-stop flags. While armed it records continuously; a trigger records the
+// post-trigger part and freezes it, then taskCaptureStream() sends it as
+// {"type":"capture"} chunks and re-arms.
+constexpr uint8_t CAPTURE_FRAMES           = 64;   // 512 B of SRAM
+constexpr uint8_t CAPTURE_CHUNK_FRAMES     = 8;
+constexpr uint8_t CAPTURE_DIVIDER_DEFAULT  = 8;    // ~400 Hz frames, ~160 ms window
+constexpr uint8_t CAPTURE_PRE_FRAMES_DEFAULT = 16;
+constexpr float   CAPTURE_DELTA_P_DEFAULT_BAR = 4.0f;
+
+enum CaptureTrigger : uint8_t {
+  CAPTURE_TRIG_ESTOP      = 0x01,
+  CAPTURE_TRIG_VALVE      = 0x02,
+  CAPTURE_TRIG_DELTA_P    = 0x04,
+  CAPTURE_TRIG_PUMP_START = 0x08,
+  CAPTURE_TRIG_MANUAL     = 0x10,
+};
+
+constexpr uint8_t CAPTURE_TRIGGER_COUNT = 5;
+static const char* const CAPTURE_TRIGGER_KEYS[CAPTURE_TRIGGER_COUNT] = {
+  "estop", "valve", "delta_p", "pump_start", "manual",
+};
+
+enum CaptureState : uint8_t { CAPTURE_ARMED = 0, CAPTURE_POST, CAPTURE_FROZEN };
+
+enum CaptureFlag : uint8_t {
+  CAPTURE_FLAG_VALVE_OPEN = 0x01,
+  CAPTURE_FLAG_ESTOP      = 0x02,
+};
+
+struct CaptureFrame {
+  uint16_t counts[PRESSURE_CH_COUNT];
+  uint8_t  pumpHalfPct;
+  uint8_t  flags;
+};
+
+struct TransientCapture {
+  CaptureFrame frames[CAPTURE_FRAMES];
+  uint8_t  head;             // next frame written
+  uint8_t  filled;
+  uint8_t  divider;
+  uint8_t  divCount;
+  uint8_t  preFrames;
+  uint8_t  postRemaining;
+  CaptureState state;
+  uint8_t  enabledTriggers;
+  uint8_t  pendingTrigger;   // requested outside the ADC ISR
+  uint8_t  trigger;          // causes of the frozen capture
+  uint8_t  lastFlags;
+  uint8_t  lastPump;
+  int32_t  deltaPLimitQ16;
+  unsigned long triggerMs;
+  uint16_t id;
+  uint16_t dropped;          // triggers seen while not armed
+  // Streaming, main loop only
+  uint8_t  streamFrames;
+  uint8_t  streamTriggerIndex;
+  uint8_t  streamSent;
+};
+
+static_assert(sizeof(CaptureFrame) * CAPTURE_FRAMES <= 512, "capture ring is budgeted at 512 B of SRAM");
+
+static volatile TransientCapture g_capture = {};
+
+static inline void captureRound() {
+  if (g_capture.state == CAPTURE_FROZEN) return;
+  if (++g_capture.divCount < g_capture.divider) return;
+  g_capture.divCount = 0;
+
+  uint8_t flags = (g_valve == OPEN) ? CAPTURE_FLAG_VALVE_OPEN : 0;
+  if (g_emergency_stop_latched || g_padc.fastTripPending) flags |= CAPTURE_FLAG_ESTOP;
+  const uint8_t pump = g_pump_duty_half_pct;
+
+  volatile CaptureFrame &frame = g_capture.frames[g_capture.head];
+  for (uint8_t ch = 0; ch < PRESSURE_CH_COUNT; ++ch) frame.counts[ch] = g_padc.latest[ch];
+  frame.pumpHalfPct = pump;
+  frame.flags = flags;
+  g_capture.head = (g_capture.head + 1 == CAPTURE_FRAMES) ? 0 : g_capture.head + 1;
+  if (g_capture.filled < CAPTURE_FRAMES) ++g_capture.filled;
+
+  uint8_t cause = g_capture.pendingTrigger;
+  g_capture.pendingTrigger = 0;
+  if ((flags ^ g_capture.lastFlags) & CAPTURE_FLAG_VALVE_OPEN) cause |= CAPTURE_TRIG_VALVE;
+  if (flags & ~g_capture.lastFlags & CAPTURE_FLAG_ESTOP)       cause |= CAPTURE_TRIG_ESTOP;
+  if (pump && !g_capture.lastPump)                             cause |= CAPTURE_TRIG_PUMP_START;
+  if (g_capture.deltaPLimitQ16 > 0 && rawDeltaPQ16() > g_capture.deltaPLimitQ16) cause |= CAPTURE_TRIG_DELTA_P;
+  cause &= g_capture.enabledTriggers;
+  g_capture.lastFlags = flags;
+  g_capture.lastPump = pump;
+
+  if (g_capture.state == CAPTURE_ARMED) {
+    if (cause) {
+      g_capture.state = CAPTURE_POST;
+      g_capture.trigger = cause;
+      g_capture.triggerMs = millis();
+      g_capture.postRemaining = CAPTURE_FRAMES - g_capture.preFrames - 1;
+    }
+  } else if (cause & ~CAPTURE_TRIG_DELTA_P) {
+    ++g_capture.dropped;  // delta-P stays high for a while; only count discrete events
+  }
+
+  if (g_capture.state == CAPTURE_POST) {
+    if (g_capture.postRemaining) {
+      --g_capture.postRemaining;
+    } else {
+      g_capture.state = CAPTURE_FROZEN;
+    }
+  }
+}
+
+ISR(ADC_vect) {
+  const uint16_t counts = ADC;
+  const uint8_t ch = g_padc.runningCh;
+
+  // The conversion now in progress latched ADMUX before this interrupt, so a mux
+  // write here takes effect one conversion later.
+  g_padc.runningCh = g_padc.nextCh;
+  g_padc.nextCh = (g_padc.nextCh + 1 == PRESSURE_CH_COUNT) ? 0 : g_padc.nextCh + 1;
+  selectAdcChannel(PRESSURE_CH_PINS[g_padc.nextCh]);
+
+  const uint8_t head = g_padc.head[ch];
+  g_padc.ring[ch][head] = counts;
+  g_padc.head[ch] = (head + 1) & (PRESSURE_RING_SIZE - 1);
+  g_padc.latest[ch] = counts;
+  ++g_padc.samples;
+
+  g_padc.accum[ch] += counts;
+  if (++g_padc.accumCount[ch] >= (1U << (2 * g_padc.oversampleBits))) {
+    g_padc.decimated[ch] = static_cast<uint16_t>(g_padc.accum[ch] >> g_padc.oversampleBits);
+    ++g_padc.outputs[ch];
+    g_padc.accum[ch] = 0;
+    g_padc.accumCount[ch] = 0;
+  }
+
+  if (ch == PRESSURE_CH_AFTER)     checkFastDeltaP();
+  else if (ch == PRESSURE_CH_TANK) captureRound();
+}
+
+static void setupPressureAdc() {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    DIDR0 = _BV(PRESSURE_PIN_AFTER - A0) | _BV(PRESSURE_PIN_TANK - A0);
+    DIDR2 = _BV(PRESSURE_PIN_BEFORE - A8);
+    g_padc.runningCh = PRESSURE_CH_BEFORE;
+    g_padc.nextCh = PRESSURE_CH_BEFORE;
+    g_padc.oversampleBits = PRESSURE_OVERSAMPLE_BITS_DEFAULT;
+    g_capture.divider = CAPTURE_DIVIDER_DEFAULT;
+    g_capture.preFrames = CAPTURE_PRE_FRAMES_DEFAULT;
+    g_capture.enabledTriggers = CAPTURE_TRIG_ESTOP | CAPTURE_TRIG_VALVE | CAPTURE_TRIG_DELTA_P |
+                                CAPTURE_TRIG_PUMP_START | CAPTURE_TRIG_MANUAL;
+    g_capture.deltaPLimitQ16 = static_cast<int32_t>(CAPTURE_DELTA_P_DEFAULT_BAR * 65536.0f);
+    selectAdcChannel(PRESSURE_CH_PINS[PRESSURE_CH_BEFORE]);
+    ADCSRA = _BV(ADEN) | _BV(ADSC) | _BV(ADATE) | _BV(ADIE) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);
+  }
+}
+
+static void applyPressureCalibration() {
+  const float beforeSlope = PRESSURE_FSO_BAR / g_params.pressureFsoV;
+  const float afterSlope = PRESSURE_FSO_BAR / (g_params.pressureFsoV - g_params.pressureAfterZeroV);
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    g_dp_coeffs.beforeQ16 = static_cast<int32_t>(beforeSlope * ADC_VOLTS_PER_COUNT * 65536.0f + 0.5f);
+    g_dp_coeffs.afterQ16 = static_cast<int32_t>(afterSlope * ADC_VOLTS_PER_COUNT * 65536.0f + 0.5f);
+    g_dp_coeffs.afterZeroQ16 = static_cast<int32_t>(afterSlope * g_params.pressureAfterZeroV * 65536.0f + 0.5f);
+  }
+}
+
+// Mirrors the delta-P law's enable flag and limit into the ISR fast path.
+static void updateFastDeltaPLimit() {
+  const SafetyLawState &law = g_safety_laws[SAFETY_LAW_PUMP_DELTA_P_HIGH];
+  const int32_t limitQ16 = (law.enabled && isfinite(law.limit) && law.limit > 0.0f && law.limit < PRESSURE_FSO_BAR)
+                             ? static_cast<int32_t>(law.limit * 65536.0f)
+                             : 0;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    g_padc.fastLimitQ16 = limitQ16;
+    g_padc.fastAboveCount = 0;
+  }
+}
+
+static bool setPressureOversampleBits(uint8_t bits) {
+  if (bits > PRESSURE_OVERSAMPLE_BITS_MAX) return false;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    g_padc.oversampleBits = bits;
+    for (uint8_t ch = 0; ch < PRESSURE_CH_COUNT; ++ch) {
+      g_padc.accum[ch] = 0;
+      g_padc.accumCount[ch] = 0;
+      g_padc.outputs[ch] = 0;
+    }
+  }
+  return true;
+}
+
+static float pressureOutputHz(uint8_t bits) {
+  return static_cast<float>(PRESSURE_CH_SAMPLE_HZ) / (1UL << (2 * bits));
+}
+
+// Volts per LSB of the decimated result; also sets the zero deadbands (2 LSB).
+static float pressureLsbVolts() {
+  return ADC_VOLTS_PER_COUNT / (1U << g_padc.oversampleBits);
+}
+
+// Latest decimated sample for one channel.
+static float readPressureVolts(uint8_t ch) {
+  uint16_t counts, outputs;
+  uint8_t bits;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    counts = g_padc.decimated[ch];
+    outputs = g_padc.outputs[ch];
+    bits = g_padc.oversampleBits;
+  }
+  if (!outputs) return NAN;  // first decimation window not complete yet
+  return counts * (ADC_VOLTS_PER_COUNT / (1U << bits));
 }
 
+// ── Helpers ──────────────────────────────────────────────────────────────
+
 static float voltsToBar(float volts) {
   if (!isfinite(volts)) return NAN;
-  float bar = volts * (PRESSURE_FSO_BAR / PRESSURE_FSO_V);
+  float bar = volts * (PRESSURE_FSO_BAR / g_params.pressureFsoV);
   if (!isfinite(bar)) return NAN;
-  if (bar < 0.02f) bar = 0.0f; // clamp small offsets/noise
+  const float deadbandBar = 2.0f * pressureLsbVolts() * (PRESSURE_FSO_BAR / g_params.pressureFsoV);
+  if (bar < deadbandBar) bar = 0.0f; // clamp small offsets/noise
   return bar;
 }
 
 static float voltsToBarAfter(float volts) {
   if (!isfinite(volts)) return NAN;
-  const float slope = PRESSURE_FSO_BAR / (PRESSURE_FSO_V - PRESSURE_AFTER_ZERO_V);
-  float bar = (volts - PRESSURE_AFTER_ZERO_V) * slope;
+  const float slope = PRESSURE_FSO_BAR / (g_params.pressureFsoV - g_params.pressureAfterZeroV);
+  float bar = (volts - g_params.pressureAfterZeroV) * slope;
   if (!isfinite(bar)) return NAN;
-  if (fabs(bar) < 0.02f) bar = 0.0f; // deadband around atmospheric for noise
+  if (fabs(bar) < 2.0f * pressureLsbVolts() * slope) bar = 0.0f; // deadband around atmospheric for noise
   return bar;
 }
 
@@ -267,14 +1139,22 @@ static void applyValve(ValveState v) {
   digitalWrite(VALVE_PIN, v == OPEN ? HIGH : LOW);
 }
 
-static void applyHeaterBottom(bool on) {
-  g_heater_bottom_on = on;
-  digitalWrite(HEATER_BOTTOM_PIN, on ? HIGH : LOW);
+static size_t heaterCount() {
+  return sizeof(g_heaters) / sizeof(g_heaters[0]);
 }
 
-static void applyHeaterExhaust(bool on) {
-  g_heater_exhaust_on = on;
-  digitalWrite(HEATER_EXHAUST_PIN, on ? HIGH : LOW);
+// The relay only closes while no law holds HEATERS_OFF, read in the same
+// atomic block as the switch, so a trip in the control tick between the
+// loop's decision and this write cannot be undone until the next tick.
+static void applyHeater(size_t idx, bool on, unsigned long nowMs) {
+  if (idx >= heaterCount()) return;
+  HeaterLoop &heater = g_heaters[idx];
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    if (g_safety_actions & SAFETY_ACTION_HEATERS_OFF) on = false;
+    if (on && !heater.on) heater.onSinceMs = nowMs;
+    heater.on = on;
+    digitalWrite(heater.pin, on ? HIGH : LOW);
+  }
 }
 
 static void setupPwm2kHz() {
@@ -292,16 +1172,24 @@ static void setDuty(float frac) {
   if (!isfinite(frac)) frac = 0.0f;
   if (frac < 0.0f) frac = 0.0f;
   if (frac > 1.0f) frac = 1.0f;
-  OCR4A = static_cast<uint16_t>(frac * PWM_TOP + 0.5f);
+  // 16-bit timer writes share the TEMP register with the control-tick ISR.
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    hal::pwmWrite(hal::PWM_PUMP, frac);
+    g_pump_duty_half_pct = static_cast<uint8_t>(frac * 200.0f + 0.5f);
+  }
 }
 
 static float setPumpCommandPct(float pct) {
   if (!isfinite(pct)) pct = 0.0f;
   if (pct < 0.0f) pct = 0.0f;
   if (pct > PUMP_CMD_MAX_PCT) pct = PUMP_CMD_MAX_PCT;
-  g_pump_cmd_pct = pct;
-  setDuty(pct / 100.0f);
-  return g_pump_cmd_pct;
+  // Command and duty change together; callers gating on a pump stop hold the
+  // same block around their check.
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    g_pump_cmd_pct = pct;
+    setDuty(pct / 100.0f);
+  }
+  return pct;
 }
 
 static size_t safetyLawCount() {
@@ -316,168 +1204,214 @@ static int firstSafetyLawIndexByState(bool wantActive) {
   return -1;
 }
 
-static bool canResetEmergencyStop() {
+static int findSafetyLaw(const CmdText& key) {
   for (size_t i = 0; i < safetyLawCount(); ++i) {
-    if (g_safety_laws[i].enabled && g_safety_laws[i].active) return false;
+    if (key.equalsIgnoreCase(g_safety_laws[i].key)) return static_cast<int>(i);
   }
-  return true;
+  return -1;
 }
 
-static void triggerEmergencyStop(size_t idx, unsigned long nowMs) {
-  if (idx >= safetyLawCount()) return;
-  SafetyLawState &law = g_safety_laws[idx];
-  if (!law.enabled) return;
-
-  setPumpCommandPct(0.0f);
-  g_emergency_stop_latched = true;
-  g_emergency_stop_ms = nowMs;
-
-  if (law.tripped) return;
-
-  law.tripped = true;
-  Serial.print(F("# Emergency stop tripped: "));
-  Serial.print(law.key);
-  if (isfinite(law.valueBar)) {
-    Serial.print(F(" ("));
-    Serial.print(law.valueBar, 3);
-    Serial.print(F(" bar > "));
-    Serial.print(law.limitBar, 3);
-    Serial.print(F(" bar)"));
+static bool canResetEmergencyStop() {
+  for (size_t i = 0; i < safetyLawCount(); ++i) {
+    const SafetyLawState &law = g_safety_laws[i];
+    if (law.latch == SAFETY_LATCH && law.enabled && law.active) return false;
   }
-  Serial.println();
+  return true;
 }
 
-static void updatePumpDeltaPSafety(float pressureBeforeBar, float pressureAfterBar, unsigned long nowMs) {
-  SafetyLawState &law = g_safety_laws[SAFETY_LAW_PUMP_DELTA_P_HIGH];
-  const float deltaPBar =
-    (isfinite(pressureBeforeBar) && isfinite(pressureAfterBar))
-      ? (pressureAfterBar - pressureBeforeBar)
-      : NAN;
-
-  law.valueBar = deltaPBar;
-  law.active = law.enabled && isfinite(deltaPBar) && (deltaPBar > law.limitBar);
+static const char* safetyLawUnits(const SafetyLawState &law) {
+  return law.compare == SAFETY_STALE ? "s" : SAFETY_SIGNAL_UNITS[law.signal];
+}
 
-  if (law.active) {
-    triggerEmergencyStop(SAFETY_LAW_PUMP_DELTA_P_HIGH, nowMs);
+static void printSafetyLawValue(const SafetyLawState &law) {
+  if (!isfinite(law.value)) return;
+  const char* units = safetyLawUnits(law);
+  Serial.print(F(" ("));
+  Serial.print(law.value, 3);
+  Serial.print(' ');
+  Serial.print(units);
+  Serial.print(law.compare == SAFETY_BELOW ? F(" < ") : F(" > "));
+  Serial.print(law.limit, 3);
+  Serial.print(' ');
+  Serial.print(units);
+  if (isfinite(law.ratePerS) && isfinite(law.rateLimitPerS)) {
+    Serial.print(F(", rate "));
+    Serial.print(law.ratePerS, 3);
+    Serial.print(F(" /s"));
   }
+  Serial.print(')');
 }
 
-static void resetEmergencyStopIfSafe() {
-  if (!g_emergency_stop_latched) {
-    Serial.println(F("# Emergency stop already cleared"));
-    return;
-  }
+// Runs from loop(): trips happen in the control tick, which must not print.
+static void reportSafetyEvents() {
+  if (!g_safety_report_mask) return;
 
-  if (!canResetEmergencyStop()) {
-    const int idx = firstSafetyLawIndexByState(true);
-    Serial.print(F("# Emergency stop reset blocked"));
-    if (idx >= 0) {
-      const SafetyLawState &law = g_safety_laws[idx];
-      Serial.print(F(": "));
-      Serial.print(law.key);
-      if (isfinite(law.valueBar)) {
-        Serial.print(F(" still at "));
-        Serial.print(law.valueBar, 3);
-        Serial.print(F(" bar"));
-      }
-    }
-    Serial.println();
-    return;
+  uint8_t mask;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    mask = g_safety_report_mask;
+    g_safety_report_mask = 0;
   }
 
   for (size_t i = 0; i < safetyLawCount(); ++i) {
-    g_safety_laws[i].tripped = false;
+    if (!(mask & (1U << i))) continue;
+    SafetyLawState law;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { law = g_safety_laws[i]; }
+
+    if (law.latch == SAFETY_LATCH)  Serial.print(F("# Emergency stop tripped: "));
+    else if (law.active)            Serial.print(F("# Safety law active: "));
+    else                            Serial.print(F("# Safety law cleared: "));
+    Serial.print(law.key);
+    if (law.active) printSafetyLawValue(law);
+    Serial.println();
   }
-  g_emergency_stop_latched = false;
-  g_emergency_stop_ms = 0;
-  Serial.println(F("# Emergency stop reset"));
 }
 
-// Modbus RTU CRC16
-static uint16_t modbusCRC(const uint8_t *data, size_t len) {
-  uint16_t crc = 0xFFFF;
-  for (size_t i = 0; i < len; ++i) {
-    crc ^= data[i];
-    for (uint8_t b = 0; b < 8; ++b) {
-      if (crc & 0x0001) {
-        crc >>= 1;
-        crc ^= 0xA001;
-      } else {
-        crc >>= 1;
-      }
+// Latest value of a law's signal and the time of its last valid sample (0 = never).
+static float safetySignalValue(const SafetyLawState &law, unsigned long nowMs, unsigned long *sampleMs) {
+  *sampleMs = nowMs;
+  switch (law.signal) {
+    case SAFETY_SIGNAL_TC:
+      if (law.channel >= NUM_TCS || !g_ctl.tempsPublished) { *sampleMs = 0; return NAN; }
+      *sampleMs = g_ctl.tempsValidMs[law.channel];
+      return g_ctl.temps[law.channel];
+    case SAFETY_SIGNAL_PRESSURE_BEFORE_BAR: return g_ctl.pressureBeforeBar;
+    case SAFETY_SIGNAL_PRESSURE_AFTER_BAR:  return g_ctl.pressureAfterBar;
+    case SAFETY_SIGNAL_PRESSURE_TANK_BAR:   return g_ctl.pressureTankBar;
+    case SAFETY_SIGNAL_DELTA_P_BAR:
+      return (isfinite(g_ctl.pressureBeforeBar) && isfinite(g_ctl.pressureAfterBar))
+               ? (g_ctl.pressureAfterBar - g_ctl.pressureBeforeBar)
+               : NAN;
+    default: {
+      const uint8_t slot = law.signal - SAFETY_SIGNAL_POLLED_FIRST;
+      if (slot >= SAFETY_SIGNAL_POLLED_COUNT) { *sampleMs = 0; return NAN; }
+      *sampleMs = g_ctl.polledValidMs[slot];
+      return *sampleMs ? g_ctl.polled[slot] : NAN;
     }
   }
-  return crc;
 }
 
-static float regsToFloatBE(const uint16_t *regs) {
-  // MFC400 C6.8.4 defaults to Big Endian for multi-register values.
-  union {
-    uint32_t u32;
-    float f32;
-  } value;
-  value.u32 = (static_cast<uint32_t>(regs[0]) << 16) | regs[1];
-  return value.f32;
+static void applySafetyActions(uint8_t actions, unsigned long nowMs) {
+  if ((actions & SAFETY_ACTION_PUMP_STOP) && g_pump_cmd_pct > 0.0f) {
+    setPumpCommandPct(0.0f);
+  }
+  if (actions & SAFETY_ACTION_HEATERS_OFF) {
+    for (size_t i = 0; i < heaterCount(); ++i) {
+      if (g_heaters[i].on) applyHeater(i, false, nowMs);
+    }
+  }
+  // SAFETY_ACTION_VALVE_CLOSE is enforced by applyValveMode().
 }
 
-// Read N_M_REG contiguous registers starting at M09 (FC=0x03)
-static bool vfdReadHoldingRegs(uint16_t startReg, uint8_t regCount, uint16_t *vals) {
-  uint8_t frame[8];
-
-  frame[0] = VFD_SLAVE_ADDR;
-  frame[1] = 0x03;             // Read Holding Registers
-  frame[2] = startReg >> 8;
-  frame[3] = startReg & 0xFF;
-  frame[4] = 0x00;
-  frame[5] = regCount;
-
-  uint16_t crc = modbusCRC(frame, 6);
-  frame[6] = crc & 0xFF;
-  frame[7] = crc >> 8;
-
-  while (VFD.available()) VFD.read(); // clear stale bytes
-
-  VFD.write(frame, 8);
-  VFD.flush();
-
-  // Expected reply: addr, func, byteCount (=2*N), data(2*N), CRC(2)
-  const uint8_t expectedLen = 3 + 2 * regCount + 2;
-  uint8_t buf[32];
-  uint8_t len = 0;
-  unsigned long start = millis();
-
-  while ((millis() - start) < 200 && len < expectedLen) {
-    if (VFD.available()) {
-      buf[len++] = static_cast<uint8_t>(VFD.read());
+// One pass over the law table; called from the control tick.
+static void evaluateSafetyLaws(unsigned long nowMs) {
+  PerfScope perf(PERF_SAFETY_LAWS);
+  uint8_t actions = 0;
+
+  bool fastTrip = false;
+  int32_t fastDeltaQ16 = 0;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    fastTrip = g_padc.fastTripPending;
+    fastDeltaQ16 = g_padc.fastTripDeltaQ16;
+    g_padc.fastTripPending = false;
+  }
+  if (fastTrip) {
+    SafetyLawState &law = g_safety_laws[SAFETY_LAW_PUMP_DELTA_P_HIGH];
+    if (!law.tripped) {
+      law.tripped = true;
+      law.value = fastDeltaQ16 / 65536.0f;
+      g_emergency_stop_latched = true;
+      g_emergency_stop_ms = nowMs;
+      g_safety_report_mask |= static_cast<uint8_t>(1U << SAFETY_LAW_PUMP_DELTA_P_HIGH);
     }
   }
 
-  if (len != expectedLen) {
-    return false;
+  for (size_t i = 0; i < safetyLawCount(); ++i) {
+    SafetyLawState &law = g_safety_laws[i];
+    unsigned long sampleMs = 0;
+    const float value = safetySignalValue(law, nowMs, &sampleMs);
+    const SafetyLawEvent event = safetyLawStep(law, safetyLawCondition(law, value, sampleMs, nowMs), nowMs, &actions);
+
+    if (event == SAFETY_EVENT_TRIPPED) {
+      g_emergency_stop_latched = true;
+      g_emergency_stop_ms = nowMs;
+    }
+    if (event != SAFETY_EVENT_NONE) g_safety_report_mask |= static_cast<uint8_t>(1U << i);
   }
 
-  uint16_t crcResp = (uint16_t)buf[len - 1] << 8 | buf[len - 2];
-  uint16_t crcCalc = modbusCRC(buf, len - 2);
-  if (crcResp != crcCalc) {
-    return false;
+  g_safety_actions = actions;
+  applySafetyActions(actions, nowMs);
+}
+
+// Hands a value polled by loop() (VFD, flow meter, scale) to the safety laws.
+static void publishSafetySignal(SafetySignal signal, float value, unsigned long nowMs) {
+  const uint8_t slot = signal - SAFETY_SIGNAL_POLLED_FIRST;
+  if (slot >= SAFETY_SIGNAL_POLLED_COUNT) return;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    g_ctl.polled[slot] = value;
+    if (isfinite(value)) g_ctl.polledValidMs[slot] = nowMs;
   }
+}
 
-  if (buf[0] != VFD_SLAVE_ADDR || buf[1] != 0x03) {
-    return false;
+static void resetEmergencyStopIfSafe() {
+  bool wasLatched = false;
+  bool blocked = false;
+  int blockedIdx = -1;
+  SafetyLawState blockedLaw = {};
+
+  // Check and clear in one step so the control tick cannot re-trip in between.
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    wasLatched = g_emergency_stop_latched;
+    if (wasLatched && !canResetEmergencyStop()) {
+      blocked = true;
+      for (size_t i = 0; i < safetyLawCount(); ++i) {
+        const SafetyLawState &law = g_safety_laws[i];
+        if (law.latch == SAFETY_LATCH && law.enabled && law.active) {
+          blockedIdx = static_cast<int>(i);
+          blockedLaw = law;
+          break;
+        }
+      }
+    } else if (wasLatched) {
+      uint8_t actions = 0;
+      for (size_t i = 0; i < safetyLawCount(); ++i) {
+        SafetyLawState &law = g_safety_laws[i];
+        law.tripped = false;
+        if (law.latch == SAFETY_AUTO_RESET && law.active) actions |= law.actions;
+      }
+      g_safety_actions = actions;
+      g_emergency_stop_latched = false;
+      g_emergency_stop_ms = 0;
+    }
   }
 
-  uint8_t byteCount = buf[2];
-  if (byteCount != 2 * regCount) {
-    return false;
+  if (!wasLatched) {
+    Serial.println(F("# Emergency stop already cleared"));
+    return;
   }
 
-  for (uint8_t i = 0; i < regCount; ++i) {
-    uint8_t hi = buf[3 + 2 * i];
-    uint8_t lo = buf[4 + 2 * i];
-    vals[i] = ((uint16_t)hi << 8) | lo;
+  if (blocked) {
+    Serial.print(F("# Emergency stop reset blocked"));
+    if (blockedIdx >= 0) {
+      Serial.print(F(": "));
+      Serial.print(blockedLaw.key);
+      if (isfinite(blockedLaw.value)) {
+        Serial.print(F(" still at "));
+        Serial.print(blockedLaw.value, 3);
+        Serial.print(' ');
+        Serial.print(safetyLawUnits(blockedLaw));
+      }
+    }
+    Serial.println();
+    return;
   }
 
-  return true;
+  Serial.println(F("# Emergency stop reset"));
+}
+
+// Read regCount contiguous holding registers (FC=0x03)
+static bool vfdReadHoldingRegs(uint16_t startReg, uint8_t regCount, uint16_t *vals) {
+  return modbusReadRegisters(hal::port(hal::PORT_VFD), VFD_SLAVE_ADDR, MODBUS_FC_READ_HOLDING,
+                             startReg, regCount, vals, VFD_REPLY_TIMEOUT_MS);
 }
 
 // Read N_M_REG contiguous registers starting at M09 (FC=0x03)
@@ -485,36 +1419,24 @@ static bool vfdReadM09toM12(uint16_t *vals) {
   return vfdReadHoldingRegs(REG_M09, N_M_REG, vals);
 }
 
-// RTU data format [19]: current value in engineering units.
-// For the small FRENIC-Mini used here, the minimum step is 0.01 A.
-static float vfdDecodeFormat19CurrentA(uint16_t raw) {
-  return raw / 100.0f;
-}
-
-// RTU data format [24]: 2-bit exponent + 14-bit mantissa floating point.
-// Exponent 0..3 maps to decimal shifts of 10^-2, 10^-1, 10^0, 10^1.
-static float vfdDecodeFormat24(uint16_t raw) {
-  const uint16_t exponent = (raw >> 14) & 0x0003;
-  const uint16_t mantissa = raw & 0x3FFF;
-  if (mantissa == 0) return 0.0f;
-
-  float value = static_cast<float>(mantissa);
-  switch (exponent) {
-    case 0: return value * 0.01f;
-    case 1: return value * 0.1f;
-    case 2: return value;
-    default: return value * 10.0f;
-  }
-}
-
 static bool pollVfd() {
   uint16_t mVals[N_M_REG];
   uint16_t wDriveVals[N_W_DRIVE_REG];
   uint16_t wPowerVal[1];
 
-  const bool okM = vfdReadM09toM12(mVals);
-  const bool okWDrive = vfdReadHoldingRegs(REG_W05, N_W_DRIVE_REG, wDriveVals);
-  const bool okWPower = vfdReadHoldingRegs(REG_W21, 1, wPowerVal);
+  bool okM, okWDrive, okWPower;
+  {
+    PerfScope perf(PERF_VFD_M09);
+    okM = vfdReadM09toM12(mVals);
+  }
+  {
+    PerfScope perf(PERF_VFD_W05);
+    okWDrive = vfdReadHoldingRegs(REG_W05, N_W_DRIVE_REG, wDriveVals);
+  }
+  {
+    PerfScope perf(PERF_VFD_W21);
+    okWPower = vfdReadHoldingRegs(REG_W21, 1, wPowerVal);
+  }
 
   g_vfd.lastPollMs = millis();
 
@@ -554,346 +1476,1766 @@ static bool pollVfd() {
     g_vfd.outputCurrentA = g_vfd.outputCurrentPct * 0.01f * VFD_RATED_CURRENT_A;
   }
 
-  if (okWPower) {
-    g_vfd.inputPowerKw = vfdDecodeFormat24(wPowerVal[0]);    // W21
-    g_vfd.inputPowerW = g_vfd.inputPowerKw * 1000.0f;
-    if (!okM && VFD_EST_RATED_INPUT_POWER_W > 0.0f) {
-      g_vfd.inputPowerPct = g_vfd.inputPowerW / VFD_EST_RATED_INPUT_POWER_W * 100.0f;
+  if (okWPower) {
+    g_vfd.inputPowerKw = vfdDecodeFormat24(wPowerVal[0]);    // W21
+    g_vfd.inputPowerW = g_vfd.inputPowerKw * 1000.0f;
+    if (!okM && VFD_EST_RATED_INPUT_POWER_W > 0.0f) {
+      g_vfd.inputPowerPct = g_vfd.inputPowerW / VFD_EST_RATED_INPUT_POWER_W * 100.0f;
+    }
+  } else if (okM && VFD_RATED_OUTPUT_POWER_W > 0.0f) {
+    g_vfd.inputPowerW = g_vfd.inputPowerPct * 0.01f * VFD_RATED_OUTPUT_POWER_W;
+    g_vfd.inputPowerKw = g_vfd.inputPowerW / 1000.0f;
+  }
+
+  return true;
+}
+
+static bool flowReadMeasurements(uint16_t *vals) {
+  return modbusReadRegisters(hal::port(hal::PORT_FLOW), FLOW_SLAVE_ADDR, MODBUS_FC_READ_INPUT,
+                             FLOW_REG_START, FLOW_REG_COUNT, vals, FLOW_REPLY_TIMEOUT_MS);
+}
+
+static bool pollFlowMeter() {
+  uint16_t regs[FLOW_REG_COUNT];
+  bool ok;
+  {
+    PerfScope perf(PERF_FLOW_MODBUS);
+    ok = flowReadMeasurements(regs);
+  }
+  g_flow.lastPollMs = millis();
+  if (!ok) {
+    g_flow.valid = false;
+    g_flow.flowVelocityMps = NAN;
+    g_flow.volumeFlowM3s = NAN;
+    g_flow.massFlowKgS = NAN;
+    g_flow.temperatureRaw = NAN;
+    g_flow.densityKgM3 = NAN;
+    return false;
+  }
+
+  g_flow.valid = true;
+  g_flow.flowVelocityMps = regsToFloatBE(&regs[0]);
+  g_flow.volumeFlowM3s   = regsToFloatBE(&regs[2]);
+  g_flow.massFlowKgS     = regsToFloatBE(&regs[4]);
+  g_flow.temperatureRaw  = regsToFloatBE(&regs[6]);
+  g_flow.densityKgM3     = regsToFloatBE(&regs[8]);
+  return true;
+}
+
+static const char* rsvScaleErrorKey(RsvScaleError error) {
+  switch (error) {
+    case RSV_SCALE_TIMEOUT: return "timeout";
+    case RSV_SCALE_INVALID_FRAME: return "invalid_frame";
+    default: return "none";
+  }
+}
+
+static bool rsvScaleFrameValid(long raw) {
+  // All-high/all-low frames come from a floating or stuck data line.
+  return raw != RSV_SCALE_RAW_ALL_HIGH && raw != RSV_SCALE_RAW_ALL_LOW;
+}
+
+static void resetRsvScaleFilter(unsigned long nowMs) {
+  memset(&g_rsv_filter, 0, sizeof(g_rsv_filter));
+  g_rsv_filter.filteredKg = NAN;
+  g_rsv_filter.rateKgH = NAN;
+  g_rsv_filter.rateSigmaKgH = NAN;
+  g_rsv_filter.binStartMs = nowMs;
+}
+
+static float medianOfWindow(const float *values, uint8_t count) {
+  float sorted[RSV_SCALE_MEDIAN_N];
+  for (uint8_t i = 0; i < count; ++i) {
+    float v = values[i];
+    uint8_t j = i;
+    for (; j > 0 && sorted[j - 1] > v; --j) sorted[j] = sorted[j - 1];
+    sorted[j] = v;
+  }
+  return (count & 1) ? sorted[count / 2] : 0.5f * (sorted[count / 2 - 1] + sorted[count / 2]);
+}
+
+// Least-squares slope over the bin means, with its standard error.
+static void updateRsvScaleRate() {
+  RsvScaleFilter &f = g_rsv_filter;
+  const uint8_t oldest = (f.binFilled < RSV_SCALE_RATE_BINS) ? 0 : f.binHead;
+  uint8_t n = 0;
+  float sumX = 0.0f, sumY = 0.0f;
+  for (uint8_t i = 0; i < f.binFilled; ++i) {
+    const float y = f.bins[(oldest + i) % RSV_SCALE_RATE_BINS];
+    if (!isfinite(y)) continue;
+    sumX += i;
+    sumY += y;
+    ++n;
+  }
+  f.ratePoints = n;
+  if (n < RSV_SCALE_RATE_MIN_BINS) {
+    f.rateKgH = NAN;
+    f.rateSigmaKgH = NAN;
+    return;
+  }
+
+  // Centre x and y first; float sums of ~5 kg masses would lose gram resolution.
+  const float meanX = sumX / n, meanY = sumY / n;
+  float sxx = 0.0f, sxy = 0.0f;
+  for (uint8_t i = 0; i < f.binFilled; ++i) {
+    const float y = f.bins[(oldest + i) % RSV_SCALE_RATE_BINS];
+    if (!isfinite(y)) continue;
+    sxx += (i - meanX) * (i - meanX);
+    sxy += (i - meanX) * (y - meanY);
+  }
+  const float slope = sxy / sxx;
+  float ssr = 0.0f;
+  for (uint8_t i = 0; i < f.binFilled; ++i) {
+    const float y = f.bins[(oldest + i) % RSV_SCALE_RATE_BINS];
+    if (!isfinite(y)) continue;
+    const float r = (y - meanY) - slope * (i - meanX);
+    ssr += r * r;
+  }
+  const float binsPerHour = 3600000.0f / RSV_SCALE_RATE_BIN_MS;
+  f.rateKgH = slope * binsPerHour;
+  f.rateSigmaKgH = sqrtf(ssr / (n - 2) / sxx) * binsPerHour;
+}
+
+static void closeRsvScaleBins(unsigned long nowMs) {
+  RsvScaleFilter &f = g_rsv_filter;
+  bool closed = false;
+  for (uint8_t guard = 0;
+       guard < RSV_SCALE_RATE_BINS && (unsigned long)(nowMs - f.binStartMs) >= RSV_SCALE_RATE_BIN_MS;
+       ++guard) {
+    f.bins[f.binHead] = f.binCount ? f.binSumKg / f.binCount : NAN;
+    f.binHead = (f.binHead + 1) % RSV_SCALE_RATE_BINS;
+    if (f.binFilled < RSV_SCALE_RATE_BINS) ++f.binFilled;
+    f.binSumKg = 0.0f;
+    f.binCount = 0;
+    f.binStartMs += RSV_SCALE_RATE_BIN_MS;
+    closed = true;
+  }
+  if ((unsigned long)(nowMs - f.binStartMs) >= RSV_SCALE_RATE_BIN_MS) f.binStartMs = nowMs;  // long gap
+  if (closed) updateRsvScaleRate();
+}
+
+static void filterRsvScaleSample(float massKg) {
+  RsvScaleFilter &f = g_rsv_filter;
+  f.window[f.windowHead] = massKg;
+  f.windowHead = (f.windowHead + 1) % RSV_SCALE_MEDIAN_N;
+  if (f.windowCount < RSV_SCALE_MEDIAN_N) ++f.windowCount;
+
+  const float median = medianOfWindow(f.window, f.windowCount);
+  if (fabs(massKg - median) > RSV_SCALE_SPIKE_KG) ++f.spikes;
+
+  // Per-sample EMA weight from the measured HX711 rate (10 SPS until measured).
+  const float rateHz = (isfinite(g_rsv_scale.rateHz) && g_rsv_scale.rateHz > 0.5f) ? g_rsv_scale.rateHz : 10.0f;
+  const float alpha = 1.0f / (1.0f + RSV_SCALE_EMA_TAU_S * rateHz);
+  f.filteredKg = isfinite(f.filteredKg) ? f.filteredKg + alpha * (median - f.filteredKg) : median;
+
+  f.binSumKg += median;
+  ++f.binCount;
+}
+
+// Drains samples queued by the HX711 reader.
+static void pollRsvScale(unsigned long nowMs) {
+  PerfScope perf(PERF_RSV_SCALE_DRAIN);
+  g_rsv_scale.lastReadMs = nowMs;
+
+  uint16_t irqOffUs = 0;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    irqOffUs = g_hx711.irqOffUs;
+    g_hx711.irqOffUs = 0;
+  }
+  if (irqOffUs) perfRecord(PERF_RSV_SCALE_IRQ_OFF, irqOffUs);
+
+  while (g_hx711.tail != g_hx711.head) {
+    const long raw = g_hx711.ring[g_hx711.tail];
+    g_hx711.tail = (g_hx711.tail + 1) & (RSV_SCALE_RING_SIZE - 1);
+    ++g_rsv_scale.samples;
+    g_rsv_scale.lastRawCandidate = raw;
+
+    if (!rsvScaleFrameValid(raw)) {
+      g_rsv_scale.valid = false;
+      g_rsv_scale.error = RSV_SCALE_INVALID_FRAME;
+      g_rsv_scale.massKg = NAN;
+      continue;
+    }
+    g_rsv_scale.valid = true;
+    g_rsv_scale.rawCounts = raw;
+    g_rsv_scale.error = RSV_SCALE_OK;
+    if (fabs(g_params.rsvScaleCountsPerKg) > 1.0e-9f) {
+      g_rsv_scale.massKg = (static_cast<float>(raw - g_params.rsvScaleTareCounts)) / g_params.rsvScaleCountsPerKg;
+      filterRsvScaleSample(g_rsv_scale.massKg);
+    } else {
+      g_rsv_scale.massKg = NAN;
+    }
+  }
+  closeRsvScaleBins(nowMs);
+
+  unsigned long lastSampleMs;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { lastSampleMs = g_hx711.lastSampleMs; }
+  g_rsv_scale.lastSampleMs = lastSampleMs;
+  if (lastSampleMs == 0 || (unsigned long)(nowMs - lastSampleMs) > RSV_SCALE_STALE_MS) {
+    g_rsv_scale.valid = false;
+    g_rsv_scale.rawCounts = 0L;
+    g_rsv_scale.error = RSV_SCALE_TIMEOUT;
+    g_rsv_scale.massKg = NAN;
+  }
+
+  static uint32_t s_rateSamples = 0;
+  static unsigned long s_rateMs = 0;
+  if ((unsigned long)(nowMs - s_rateMs) >= 1000UL) {
+    if (s_rateMs != 0) {
+      g_rsv_scale.rateHz = (g_rsv_scale.samples - s_rateSamples) * 1000.0f / (nowMs - s_rateMs);
+    }
+    s_rateSamples = g_rsv_scale.samples;
+    s_rateMs = nowMs;
+  }
+}
+
+static void printlnCmdText(const CmdText& text) {
+  Serial.write(text.data(), text.length());
+  Serial.println();
+}
+
+static bool tryParseFloat(const CmdText& text, float *out) {
+  return parseFloatText(text.data(), text.length(), out);
+}
+
+static bool parseFloatSuffix(const CmdText& cmd, size_t prefixLen, float *out) {
+  if (!out) return false;
+  CmdText rest = cmd.substring(prefixLen);
+  rest.trim();
+  return tryParseFloat(rest, out);
+}
+
+static bool parseFloatArgs(const CmdText& cmd, size_t prefixLen, float values[], size_t count) {
+  if (prefixLen > cmd.length()) return false;
+  return parseFloatList(cmd.data() + prefixLen, cmd.length() - prefixLen, values, count);
+}
+
+static AutoValveTargets autoValveTargets() {
+  return { g_params.hfeGoalC, g_params.hxLimitC, g_params.hxApproachC, g_params.lnAutoHysteresisC };
+}
+
+static void updateAutoValveStatus(const float temps[], size_t count) {
+  const float thiTemp =
+    (temps && count > THI_SENSOR_INDEX && isfinite(temps[THI_SENSOR_INDEX]))
+      ? temps[THI_SENSOR_INDEX]
+      : NAN;
+  const float hfeTempC =
+    (temps && count > HFE_AUTO_SENSOR_INDEX && isfinite(temps[HFE_AUTO_SENSOR_INDEX]))
+      ? temps[HFE_AUTO_SENSOR_INDEX]
+      : NAN;
+
+  updateAutoValveStatusFromValues(&g_auto_status, autoValveTargets(), thiTemp, hfeTempC);
+  g_auto_status_sampled = true;
+}
+
+static void runAutoValveControl() {
+  applyValve(autoValveDecide(g_auto_status, &g_auto_close_latched) ? OPEN : CLOSED);
+}
+
+static void refreshAutoStatusAfterTargetChange() {
+  updateAutoValveStatusFromValues(&g_auto_status, autoValveTargets(), g_auto_status.thiTempC, g_auto_status.hfeTempC);
+  if (g_mode == AUTO && g_auto_status_sampled) {
+    runAutoValveControl();
+  }
+}
+
+// Targets are shared with the control tick; update and re-evaluate atomically.
+static void setControlTarget(float *target, float value) {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    *target = value;
+    refreshAutoStatusAfterTargetChange();
+  }
+  markTargetsChanged();
+}
+
+static bool setAutoTargets(float hfeGoalC, float hxLimitC, float hxApproachC, float hysteresisC) {
+  if (!isfinite(hfeGoalC) || !isfinite(hxLimitC) ||
+      !isfinite(hxApproachC) || !isfinite(hysteresisC) ||
+      hxApproachC < 0.0f || hysteresisC < 0.0f) {
+    return false;
+  }
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    g_params.hfeGoalC = hfeGoalC;
+    g_params.hxLimitC = hxLimitC;
+    g_params.hxApproachC = hxApproachC;
+    g_params.lnAutoHysteresisC = hysteresisC;
+    refreshAutoStatusAfterTargetChange();
+  }
+  markTargetsChanged();
+  return true;
+}
+
+static void applyValveMode() {
+  if (g_safety_actions & SAFETY_ACTION_VALVE_CLOSE) {
+    applyValve(CLOSED);
+    return;
+  }
+  // Control: LN auto closes on THI/TMI cold limits and reopens once both recover by hysteresis.
+  if (g_mode == AUTO) {
+    if (g_auto_status_sampled) runAutoValveControl();
+  } else if (g_mode == FORCE_OPEN)  applyValve(OPEN);
+  else if (g_mode == FORCE_CLOSE)   applyValve(CLOSED);
+}
+
+static void runControlTick() {
+  PerfScope perf(PERF_CONTROL_TICK);
+  const unsigned long nowMs = millis();
+
+  {
+    PerfScope adcPerf(PERF_PRESSURE_ADC);
+    g_ctl.pressureBeforeVolts = readPressureVolts(PRESSURE_CH_BEFORE);
+    g_ctl.pressureAfterVolts  = readPressureVolts(PRESSURE_CH_AFTER);
+    g_ctl.pressureTankVolts   = readPressureVolts(PRESSURE_CH_TANK);
+  }
+  g_ctl.pressureBeforeBar = voltsToBar(g_ctl.pressureBeforeVolts);
+  g_ctl.pressureAfterBar  = voltsToBarAfter(g_ctl.pressureAfterVolts);
+  g_ctl.pressureTankBar   = voltsToBar(g_ctl.pressureTankVolts);
+
+  evaluateSafetyLaws(nowMs);
+
+  if (g_ctl.tempsPublished) {
+    updateAutoValveStatus(g_ctl.temps, NUM_TCS);
+  }
+  applyValveMode();
+  ++g_ctl.ticks;
+  g_wdt_checkin_ms[WDT_STAGE_CONTROL_TICK] = nowMs;
+}
+
+// Nested (ISR_NOBLOCK) so UART RX, millis() and ADC sampling keep running during the tick.
+ISR(TIMER5_COMPA_vect, ISR_NOBLOCK) {
+  if (g_control_tick_busy) {
+    ++g_ctl.overruns;
+    return;
+  }
+  g_control_tick_busy = true;
+  runControlTick();
+  g_control_tick_busy = false;
+}
+
+static void setupControlTick() {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    TCCR5A = 0;
+    TCCR5B = _BV(WGM52) | _BV(CS51) | _BV(CS50);  // CTC on OCR5A, prescaler 64
+    OCR5A  = static_cast<uint16_t>(F_CPU / CONTROL_TICK_PRESCALER / CONTROL_TICK_HZ - 1);
+    TCNT5  = 0;
+    TIMSK5 = _BV(OCIE5A);
+  }
+}
+
+// Applies the per-channel affine calibration; control, heaters and telemetry
+// temps[] all use the calibrated values.
+static float calibrateTemp(size_t ch, float raw) {
+  return (ch < NUM_TCS && isfinite(raw)) ? g_params.tcGain[ch] * raw + g_params.tcOffsetC[ch] : NAN;
+}
+
+static void calibrateTemps(const float raw[], float calibrated[], size_t count) {
+  for (size_t i = 0; i < count; ++i) calibrated[i] = calibrateTemp(i, raw[i]);
+}
+
+// Hands one fresh TC reading to the control tick.
+static void publishControlTemp(size_t ch, float tempC, unsigned long nowMs) {
+  if (ch >= NUM_TCS) return;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    g_ctl.temps[ch] = tempC;
+    if (isfinite(tempC)) g_ctl.tempsValidMs[ch] = nowMs;
+    g_ctl.tempsPublished = true;
+  }
+}
+
+static void recordLoopPass() {
+  const unsigned long nowUs = micros();
+  LoopProfile &prof = g_loop_profile;
+  if (prof.lastPassUs != 0 || prof.passes != 0) {
+    const uint32_t elapsedUs = nowUs - prof.lastPassUs;
+    if (elapsedUs > prof.windowMaxUs) prof.windowMaxUs = elapsedUs;
+    if (elapsedUs > prof.peakUs) prof.peakUs = elapsedUs;
+    prof.avgUs = prof.passes ? (prof.avgUs - (prof.avgUs >> 3) + (elapsedUs >> 3)) : elapsedUs;
+
+    uint8_t bucket = 0;
+    uint32_t edgeUs = 256UL;
+    while (bucket + 1 < PERF_LOOP_BUCKETS && elapsedUs >= edgeUs) {
+      ++bucket;
+      edgeUs <<= 2;
+    }
+    ++prof.hist[bucket];
+    ++prof.passes;
+  }
+  prof.lastPassUs = nowUs;
+}
+
+static void resetPerfStats() {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { memset(g_perf, 0, sizeof(g_perf)); }
+  const unsigned long lastPassUs = g_loop_profile.lastPassUs;
+  memset(&g_loop_profile, 0, sizeof(g_loop_profile));
+  g_loop_profile.lastPassUs = lastPassUs;
+}
+
+// Compact frames carry [count,last,window_max,peak,avg] arrays; verbose frames name each field.
+static void emitPerfFrame(unsigned long nowMs, bool verbose) {
+  const LoopProfile &prof = g_loop_profile;
+  Serial.print(F("{\"type\":\"perf\",\"t\":"));
+  Serial.print(nowMs / 1000.0f, 3);
+  Serial.print(F(",\"loop\":{\"passes\":"));
+  Serial.print(prof.passes);
+  Serial.print(F(",\"max_us\":"));
+  Serial.print(prof.windowMaxUs);
+  Serial.print(F(",\"peak_us\":"));
+  Serial.print(prof.peakUs);
+  Serial.print(F(",\"avg_us\":"));
+  Serial.print(prof.avgUs);
+  Serial.print(F(",\"hist\":["));
+  for (uint8_t b = 0; b < PERF_LOOP_BUCKETS; ++b) {
+    if (b) Serial.print(',');
+    Serial.print(prof.hist[b]);
+  }
+  Serial.print(F("]}"));
+  if (verbose) {
+    Serial.print(F(",\"hist_edges_us\":[256,1024,4096,16384,65536,262144,1048576]"));
+  }
+  Serial.print(F(",\"sections\":{"));
+  for (uint8_t i = 0; i < PERF_SECTION_COUNT; ++i) {
+    // The control tick records its sections from its ISR; copy and roll the
+    // window over together so neither a torn field nor a new max is lost.
+    PerfStat stat;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+      stat = g_perf[i];
+      if (!verbose) g_perf[i].windowMaxUs = 0;
+    }
+    if (i) Serial.print(',');
+    Serial.print('"');
+    Serial.print(PERF_SECTION_KEYS[i]);
+    if (verbose) {
+      Serial.print(F("\":{\"count\":"));
+      Serial.print(stat.count);
+      Serial.print(F(",\"last_us\":"));
+      Serial.print(stat.lastUs);
+      Serial.print(F(",\"max_us\":"));
+      Serial.print(stat.windowMaxUs);
+      Serial.print(F(",\"peak_us\":"));
+      Serial.print(stat.peakUs);
+      Serial.print(F(",\"avg_us\":"));
+      Serial.print(stat.avgUs);
+      Serial.print('}');
+    } else {
+      Serial.print(F("\":["));
+      Serial.print(stat.count);
+      Serial.print(',');
+      Serial.print(stat.lastUs);
+      Serial.print(',');
+      Serial.print(stat.windowMaxUs);
+      Serial.print(',');
+      Serial.print(stat.peakUs);
+      Serial.print(',');
+      Serial.print(stat.avgUs);
+      Serial.print(']');
+    }
+  }
+  Serial.println(F("}}"));
+
+  // Window maxima roll over with each periodic frame (sections above); peaks persist.
+  if (!verbose) g_loop_profile.windowMaxUs = 0;
+}
+
+// {"type":"sched"}: every task's configuration and timing, at boot and on SCHED.
+// The 1 Hz line carries only [max_us, max_late_ms, missed, overruns] per task.
+static void emitSchedFrame(unsigned long nowMs) {
+  Serial.print(F("{\"type\":\"sched\",\"t\":"));
+  Serial.print(nowMs / 1000.0f, 3);
+  Serial.print(F(",\"tasks\":{"));
+  for (size_t i = 0; i < sizeof(g_sched_tasks) / sizeof(g_sched_tasks[0]); ++i) {
+    const SchedTask &task = g_sched_tasks[i];
+    if (i) Serial.print(',');
+    Serial.print('"');
+    Serial.print(task.key);
+    Serial.print(F("\":{\"period_ms\":"));
+    Serial.print(task.periodMs);
+    Serial.print(F(",\"priority\":"));
+    Serial.print(task.priority);
+    Serial.print(F(",\"budget_us\":"));
+    Serial.print(task.budgetUs);
+    Serial.print(F(",\"last_us\":"));
+    Serial.print(task.lastUs);
+    Serial.print(F(",\"max_us\":"));
+    Serial.print(task.maxUs);
+    Serial.print(F(",\"avg_us\":"));
+    Serial.print(task.avgUs);
+    Serial.print(F(",\"late_ms\":"));
+    Serial.print(task.lastLateMs);
+    Serial.print(F(",\"max_late_ms\":"));
+    Serial.print(task.maxLateMs);
+    Serial.print(F(",\"runs\":"));
+    Serial.print(task.runs);
+    Serial.print(F(",\"missed\":"));
+    Serial.print(task.missed);
+    Serial.print(F(",\"overruns\":"));
+    Serial.print(task.overruns);
+    Serial.print('}');
+  }
+  Serial.println(F("}}"));
+}
+
+// ── SRAM headroom ────────────────────────────────────────────────────────
+// .data/.bss/.noinit sit at the bottom of the 8 KB, the heap grows up from
+// __heap_start and the stack down from RAMEND. Everything between is painted
+// before the C runtime starts, so the bytes still painted are the closest
+// heap and stack have come to each other since reset.
+constexpr uint8_t STACK_PAINT = 0xC5;
+
+extern "C" {
+extern char __data_start;
+extern char __heap_start;
+extern char *__brkval;
+struct __freelist {
+  size_t sz;
+  struct __freelist *nx;
+};
+extern struct __freelist *__flp;
+
+// .init1 runs before the stack pointer or __zero_reg__ are set up, so this
+// stays in assembly and touches nothing but r24/r25/Z.
+void paintStack() __attribute__((naked, used, section(".init1")));
+void paintStack() {
+  asm volatile(
+    "    ldi r30, lo8(__heap_start)\n"
+    "    ldi r31, hi8(__heap_start)\n"
+    "    ldi r24, %0\n"
+    "    ldi r25, hi8(__stack)\n"
+    "    rjmp 2f\n"
+    "1:  st Z+, r24\n"
+    "2:  cpi r30, lo8(__stack)\n"
+    "    cpc r31, r25\n"
+    "    brlo 1b\n"
+    "    breq 1b\n"
+    :: "M"(STACK_PAINT));
+}
+}
+
+struct MemStats {
+  uint16_t staticBytes;      // .data + .bss + .noinit
+  uint16_t heapBytes;        // __heap_start .. __brkval, free-list blocks included
+  uint16_t heapFreeBytes;    // on malloc's free list
+  uint16_t heapLargestFree;  // largest free-list block
+  uint16_t stackBytes;       // in use now
+  uint16_t stackPeakBytes;   // deepest since reset (paint scan)
+  uint16_t freeBytes;        // heap top to stack pointer now
+  uint16_t minFreeBytes;     // still painted: never reached by heap or stack
+};
+
+static MemStats readMemStats() {
+  MemStats m = {};
+  char *heapTop;
+  uint16_t sp;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    heapTop = __brkval ? __brkval : &__heap_start;
+    for (const struct __freelist *block = __flp; block; block = block->nx) {
+      const uint16_t size = block->sz + sizeof(size_t);
+      m.heapFreeBytes += size;
+      if (size > m.heapLargestFree) m.heapLargestFree = size;
+    }
+    sp = SP;
+  }
+  const uintptr_t top = reinterpret_cast<uintptr_t>(heapTop);
+  m.staticBytes = &__heap_start - &__data_start;
+  m.heapBytes   = heapTop - &__heap_start;
+  m.stackBytes  = RAMEND - sp;
+  m.freeBytes   = sp - top;
+
+  // A block freed at the top of the heap lowers __brkval but keeps its
+  // bytes, so the scan can only under-report the margin.
+  uintptr_t addr = top;
+  while (addr < sp && *reinterpret_cast<const uint8_t*>(addr) == STACK_PAINT) ++addr;
+  m.minFreeBytes   = addr - top;
+  m.stackPeakBytes = RAMEND - addr + 1;
+  return m;
+}
+
+static void emitMemFrame(unsigned long nowMs) {
+  const MemStats m = readMemStats();
+  // Share of the free SRAM (free list plus the heap/stack gap) that the
+  // largest single allocation could not use.
+  const uint16_t freeTotal = m.heapFreeBytes + m.freeBytes;
+  const uint16_t largest = m.heapLargestFree > m.freeBytes ? m.heapLargestFree : m.freeBytes;
+  const float fragPct = freeTotal ? 100.0f * (freeTotal - largest) / freeTotal : 0.0f;
+
+  Serial.print(F("{\"type\":\"mem\",\"t\":"));
+  Serial.print(nowMs / 1000.0f, 3);
+  Serial.print(F(",\"sram\":"));
+  Serial.print(RAMEND - RAMSTART + 1);
+  Serial.print(F(",\"static\":"));
+  Serial.print(m.staticBytes);
+  Serial.print(F(",\"heap\":"));
+  Serial.print(m.heapBytes);
+  Serial.print(F(",\"heap_free\":"));
+  Serial.print(m.heapFreeBytes);
+  Serial.print(F(",\"heap_largest_free\":"));
+  Serial.print(m.heapLargestFree);
+  Serial.print(F(",\"frag_pct\":"));
+  Serial.print(fragPct, 1);
+  Serial.print(F(",\"stack\":"));
+  Serial.print(m.stackBytes);
+  Serial.print(F(",\"stack_peak\":"));
+  Serial.print(m.stackPeakBytes);
+  Serial.print(F(",\"free\":"));
+  Serial.print(m.freeBytes);
+  Serial.print(F(",\"min_free\":"));
+  Serial.print(m.minFreeBytes);
+  Serial.println('}');
+}
+
+static const char* heaterModeKey(HeaterMode mode) {
+  return mode == HEATER_AUTO ? "auto" : "manual";
+}
+
+static const char* heaterLawKey(HeaterLaw law) {
+  return law == HEATER_LAW_PI ? "pi" : "hysteresis";
+}
+
+static const char* heaterInterlockKey(HeaterInterlock interlock) {
+  switch (interlock) {
+    case HEATER_INTERLOCK_SAFETY: return "safety_law";
+    case HEATER_INTERLOCK_SENSOR_INVALID: return "sensor_invalid";
+    case HEATER_INTERLOCK_MAX_ON_TIME: return "max_on_time";
+    default: return "none";
+  }
+}
+
+static void setHeaterManual(size_t idx, bool on, unsigned long nowMs) {
+  if (idx >= heaterCount()) return;
+  HeaterLoop &heater = g_heaters[idx];
+  heater.mode = HEATER_MANUAL;
+  heater.interlock = HEATER_INTERLOCK_NONE;
+  heater.maxOnLatched = false;
+  heater.integral = 0.0f;
+  heater.duty = 0.0f;
+  applyHeater(idx, on, nowMs);
+}
+
+// Arms the thermostatic loop; the relay is switched on the next control pass.
+static void armHeaterAuto(size_t idx, unsigned long nowMs) {
+  if (idx >= heaterCount()) return;
+  HeaterLoop &heater = g_heaters[idx];
+  heater.mode = HEATER_AUTO;
+  heater.interlock = HEATER_INTERLOCK_NONE;
+  heater.maxOnLatched = false;
+  heater.integral = 0.0f;
+  heater.duty = 0.0f;
+  heater.windowStartMs = nowMs;
+  heater.lastUpdateMs = nowMs;
+  heater.onSinceMs = nowMs;
+}
+
+static bool heaterDemand(HeaterLoop &heater, unsigned long nowMs) {
+  const float errorC = heater.setpointC - heater.tempC;
+
+  if (heater.law == HEATER_LAW_PI) {
+    const float dtS = (nowMs - heater.lastUpdateMs) / 1000.0f;
+    // Clamp the integral to the duty range so a long cold soak cannot wind it up.
+    heater.integral += heater.kiPerCS * errorC * dtS;
+    if (heater.integral < 0.0f) heater.integral = 0.0f;
+    if (heater.integral > 1.0f) heater.integral = 1.0f;
+
+    float duty = heater.kpPerC * errorC + heater.integral;
+    if (!isfinite(duty) || duty < 0.0f) duty = 0.0f;
+    if (duty > 1.0f) duty = 1.0f;
+    heater.duty = duty;
+
+    if ((unsigned long)(nowMs - heater.windowStartMs) >= heater.windowMs) {
+      heater.windowStartMs = nowMs;
+    }
+    const unsigned long onMs = static_cast<unsigned long>(duty * heater.windowMs + 0.5f);
+    return (unsigned long)(nowMs - heater.windowStartMs) < onMs;
+  }
+
+  // Hysteresis: turn on below setpoint - band, off once the setpoint is reached.
+  if (heater.tempC <= heater.setpointC - heater.bandC) return true;
+  if (heater.tempC >= heater.setpointC) return false;
+  return heater.on;
+}
+
+static void updateHeaterControl(const float temps[], size_t count, unsigned long nowMs) {
+  for (size_t i = 0; i < heaterCount(); ++i) {
+    HeaterLoop &heater = g_heaters[i];
+    heater.tempC =
+      (temps && heater.sensorIndex < count && isfinite(temps[heater.sensorIndex]))
+        ? temps[heater.sensorIndex]
+        : NAN;
+
+    const bool safetyOff = (g_safety_actions & SAFETY_ACTION_HEATERS_OFF) != 0;
+    if (heater.mode != HEATER_AUTO) {
+      heater.interlock = safetyOff ? HEATER_INTERLOCK_SAFETY : HEATER_INTERLOCK_NONE;
+      if (safetyOff && heater.on) applyHeater(i, false, nowMs);
+      heater.lastUpdateMs = nowMs;
+      continue;
+    }
+
+    if (heater.on && heater.maxOnMs > 0 &&
+        (unsigned long)(nowMs - heater.onSinceMs) >= heater.maxOnMs && !heater.maxOnLatched) {
+      heater.maxOnLatched = true;
+      Serial.print(F("# Heater "));
+      Serial.print(heater.key);
+      Serial.println(F(" max on-time reached; send HEATER <name> AUTO to re-arm"));
+    }
+
+    if (safetyOff)                     heater.interlock = HEATER_INTERLOCK_SAFETY;
+    else if (!isfinite(heater.tempC))  heater.interlock = HEATER_INTERLOCK_SENSOR_INVALID;
+    else if (heater.maxOnLatched)      heater.interlock = HEATER_INTERLOCK_MAX_ON_TIME;
+    else                               heater.interlock = HEATER_INTERLOCK_NONE;
+
+    if (heater.interlock != HEATER_INTERLOCK_NONE) {
+      heater.integral = 0.0f;
+      heater.duty = 0.0f;
+      applyHeater(i, false, nowMs);
+    } else {
+      applyHeater(i, heaterDemand(heater, nowMs), nowMs);
+    }
+    heater.lastUpdateMs = nowMs;
+  }
+}
+
+static bool parseHeaterSensorIndex(float value, uint8_t *out) {
+  if (!out || !isfinite(value) || value < 0.0f || value >= static_cast<float>(NUM_TCS)) return false;
+  if (value != floorf(value)) return false;
+  *out = static_cast<uint8_t>(value);
+  return true;
+}
+
+// Seconds from a command into ms, rejected (NaN, inf, 1e30, ...) outside
+// minMs..maxMs before the cast.
+static bool parseHeaterSeconds(float seconds, unsigned long minMs, unsigned long maxMs, unsigned long *out) {
+  if (!out || !isfinite(seconds)) return false;
+  const float ms = seconds * 1000.0f;
+  if (ms < static_cast<float>(minMs) || ms > static_cast<float>(maxMs)) return false;
+  *out = static_cast<unsigned long>(ms);
+  return true;
+}
+
+static void printHeaterConfig(const HeaterLoop &heater) {
+  Serial.print(F("# Heater "));
+  Serial.print(heater.key);
+  Serial.print(F(" "));
+  Serial.print(heaterModeKey(heater.mode));
+  Serial.print(F(" ("));
+  Serial.print(heaterLawKey(heater.law));
+  Serial.print(F("): setpoint "));
+  Serial.print(heater.setpointC, 2);
+  Serial.print(F(" C on temps["));
+  Serial.print(heater.sensorIndex);
+  if (heater.law == HEATER_LAW_PI) {
+    Serial.print(F("], kp "));
+    Serial.print(heater.kpPerC, 4);
+    Serial.print(F(", ki "));
+    Serial.print(heater.kiPerCS, 5);
+    Serial.print(F(", window "));
+    Serial.print(heater.windowMs / 1000UL);
+    Serial.print(F(" s"));
+  } else {
+    Serial.print(F("], band "));
+    Serial.print(heater.bandC, 2);
+    Serial.print(F(" C"));
+  }
+  Serial.print(F(", max on "));
+  Serial.print(heater.maxOnMs / 1000UL);
+  Serial.println(F(" s"));
+}
+
+// HEATER <name> ON|OFF|AUTO
+// HEATER <name> HYSTERESIS <setpoint_c> <sensor> <band_c> <max_on_s>
+// HEATER <name> PI <setpoint_c> <sensor> <kp> <ki> <window_s> <max_on_s>
+static void handleHeaterCommand(size_t idx, const CmdText& cmd, const CmdText& upper, size_t prefixLen) {
+  HeaterLoop &heater = g_heaters[idx];
+  const unsigned long nowMs = millis();
+  CmdText rest = upper.substring(prefixLen);
+  rest.trim();
+
+  if (rest == "ON") {
+    if (g_safety_actions & SAFETY_ACTION_HEATERS_OFF) {
+      Serial.println(F("# Heater command blocked by safety law"));
+      return;
+    }
+    setHeaterManual(idx, true, nowMs);
+  }
+  else if (rest == "OFF")  { setHeaterManual(idx, false, nowMs); }
+  else if (rest == "AUTO") {
+    armHeaterAuto(idx, nowMs);
+    printHeaterConfig(heater);
+  }
+  else if (rest.startsWith("HYSTERESIS")) {
+    float values[4] = { NAN, NAN, NAN, NAN };
+    uint8_t sensor = 0;
+    unsigned long maxOnMs = 0;
+    const size_t argsAt = cmd.length() - rest.length() + 10;
+    if (!parseFloatArgs(cmd, argsAt, values, 4) ||
+        !parseHeaterSensorIndex(values[1], &sensor) ||
+        values[2] < 0.0f ||
+        !parseHeaterSeconds(values[3], HEATER_MIN_MAX_ON_MS, HEATER_MAX_MAX_ON_MS, &maxOnMs)) {
+      Serial.println(F("# Invalid HEATER HYSTERESIS command (max_on_s 1..14400)"));
+      return;
+    }
+    heater.law = HEATER_LAW_HYSTERESIS;
+    heater.setpointC = values[0];
+    heater.sensorIndex = sensor;
+    heater.bandC = values[2];
+    heater.maxOnMs = maxOnMs;
+    printHeaterConfig(heater);
+  }
+  else if (rest.startsWith("PI")) {
+    float values[6] = { NAN, NAN, NAN, NAN, NAN, NAN };
+    uint8_t sensor = 0;
+    unsigned long windowMs = 0, maxOnMs = 0;
+    const size_t argsAt = cmd.length() - rest.length() + 2;
+    if (!parseFloatArgs(cmd, argsAt, values, 6) ||
+        !parseHeaterSensorIndex(values[1], &sensor) ||
+        values[2] < 0.0f || values[3] < 0.0f ||
+        !parseHeaterSeconds(values[4], HEATER_MIN_WINDOW_MS, HEATER_MAX_WINDOW_MS, &windowMs) ||
+        !parseHeaterSeconds(values[5], HEATER_MIN_MAX_ON_MS, HEATER_MAX_MAX_ON_MS, &maxOnMs)) {
+      Serial.println(F("# Invalid HEATER PI command (window_s 5..600, max_on_s 1..14400)"));
+      return;
+    }
+    heater.law = HEATER_LAW_PI;
+    heater.setpointC = values[0];
+    heater.sensorIndex = sensor;
+    heater.kpPerC = values[2];
+    heater.kiPerCS = values[3];
+    heater.windowMs = windowMs;
+    heater.maxOnMs = maxOnMs;
+    heater.integral = 0.0f;
+    heater.windowStartMs = nowMs;
+    printHeaterConfig(heater);
+  }
+  else {
+    Serial.println(F("# Invalid HEATER command"));
+  }
+}
+
+// Pump stopped, LN valve closed, heaters off. Used at boot and when the watchdog fires.
+static void applySafeOutputs() {
+  g_mode = FORCE_CLOSE;
+  setPumpCommandPct(0.0f);
+  applyValve(CLOSED);
+  for (size_t i = 0; i < heaterCount(); ++i) {
+    setHeaterManual(i, false, millis());
+  }
+}
+
+ISR(WDT_vect) {
+  g_wdt_expired = true;
+  if (g_wdt_noinit.missedStage == WDT_STAGE_NONE) {
+    g_wdt_noinit.missedStage = g_wdt_noinit.activeStage;
+  }
+  applySafeOutputs();
+}
+
+static const char* resetCauseKey(uint8_t mcusr) {
+  if (mcusr & _BV(WDRF))  return "watchdog";
+  if (mcusr & _BV(BORF))  return "brown_out";
+  if (mcusr & _BV(EXTRF)) return "external";
+  if (mcusr & _BV(JTRF))  return "jtag";
+  if (mcusr & _BV(PORF))  return "power_on";
+  return "unknown";
+}
+
+static void recordResetCause() {
+  EEPROM.get(EEPROM_RESET_RECORD_ADDR, g_reset_record);
+  if (g_reset_record.magic != RESET_RECORD_MAGIC || g_reset_record.version != RESET_RECORD_VERSION) {
+    g_reset_record = {};
+    g_reset_record.magic = RESET_RECORD_MAGIC;
+    g_reset_record.version = RESET_RECORD_VERSION;
+  }
+
+  const bool noinitValid = g_wdt_noinit.magic == WDT_NOINIT_MAGIC && !(g_mcusr_at_boot & _BV(PORF));
+  uint8_t stage = WDT_STAGE_NONE;
+  if ((g_mcusr_at_boot & _BV(WDRF)) && noinitValid) {
+    stage = g_wdt_noinit.missedStage != WDT_STAGE_NONE ? g_wdt_noinit.missedStage : g_wdt_noinit.activeStage;
+    if (stage >= WDT_STAGE_COUNT) stage = WDT_STAGE_NONE;
+  }
+
+  g_reset_record.mcusr = g_mcusr_at_boot;
+  g_reset_record.stage = stage;
+  ++g_reset_record.bootCount;
+  if (g_mcusr_at_boot & _BV(WDRF)) ++g_reset_record.watchdogResets;
+  EEPROM.put(EEPROM_RESET_RECORD_ADDR, g_reset_record);
+
+  g_wdt_noinit.magic = WDT_NOINIT_MAGIC;
+  g_wdt_noinit.activeStage = WDT_STAGE_NONE;
+  g_wdt_noinit.missedStage = WDT_STAGE_NONE;
+
+  Serial.print(F("# Reset cause: "));
+  Serial.print(resetCauseKey(g_reset_record.mcusr));
+  Serial.print(F(" (MCUSR 0x"));
+  Serial.print(g_reset_record.mcusr, HEX);
+  Serial.print(F("), stage "));
+  Serial.println(WDT_STAGE_KEYS[g_reset_record.stage]);
+}
+
+static void enableWatchdog() {
+  const unsigned long nowMs = millis();
+  for (uint8_t i = 0; i < WDT_STAGE_COUNT; ++i) g_wdt_checkin_ms[i] = nowMs;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    wdt_reset();
+    WDTCSR = _BV(WDCE) | _BV(WDE);
+    WDTCSR = _BV(WDIE) | _BV(WDE) | _BV(WDP2) | _BV(WDP1);  // WDT_TIMEOUT_MS, interrupt then reset
+  }
+  g_wdt_enabled = true;
+}
+
+static void superviseWatchdog() {
+  if (!g_wdt_enabled || g_wdt_expired) return;
+
+  const unsigned long nowMs = millis();
+  for (uint8_t i = WDT_STAGE_NONE + 1; i < WDT_STAGE_COUNT; ++i) {
+    unsigned long lastMs;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+      lastMs = g_wdt_checkin_ms[i];
+    }
+    if ((unsigned long)(nowMs - lastMs) > WDT_STAGE_DEADLINE_MS[i]) {
+      // Stop kicking; the WDT interrupt makes outputs safe, then the MCU resets.
+      if (g_wdt_noinit.missedStage == WDT_STAGE_NONE) g_wdt_noinit.missedStage = i;
+      return;
+    }
+  }
+  wdt_reset();
+}
+
+static void captureArm() {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    g_capture.head = 0;
+    g_capture.filled = 0;
+    g_capture.divCount = 0;
+    g_capture.pendingTrigger = 0;
+    g_capture.streamSent = 0;
+    g_capture.state = CAPTURE_ARMED;
+  }
+}
+
+static void printCaptureTriggers(uint8_t mask) {
+  Serial.print('[');
+  bool first = true;
+  for (uint8_t i = 0; i < CAPTURE_TRIGGER_COUNT; ++i) {
+    if (!(mask & (1U << i))) continue;
+    if (!first) Serial.print(',');
+    Serial.print('"');
+    Serial.print(CAPTURE_TRIGGER_KEYS[i]);
+    Serial.print('"');
+    first = false;
+  }
+  Serial.print(']');
+}
+
+static float captureFramePeriodUs(uint8_t divider) {
+  return 1.0e6f * PRESSURE_CH_COUNT * divider / ADC_CONVERSION_HZ;
+}
+
+static void printCaptureStatus() {
+  Serial.print(F("# Capture: "));
+  Serial.print(g_capture.state == CAPTURE_ARMED ? F("armed") :
+               (g_capture.state == CAPTURE_POST ? F("recording") : F("streaming")));
+  Serial.print(F(", "));
+  Serial.print(CAPTURE_FRAMES);
+  Serial.print(F(" frames @ "));
+  Serial.print(captureFramePeriodUs(g_capture.divider), 0);
+  Serial.print(F(" us, pre "));
+  Serial.print(g_capture.preFrames);
+  Serial.print(F(", delta-P trigger "));
+  Serial.print(g_capture.deltaPLimitQ16 / 65536.0f, 2);
+  Serial.print(F(" bar, triggers "));
+  printCaptureTriggers(g_capture.enabledTriggers);
+  Serial.print(F(", dropped "));
+  Serial.println(g_capture.dropped);
+}
+
+// One chunk per release so a capture never holds the loop for more than a line.
+static void taskCaptureStream(unsigned long nowMs) {
+  (void)nowMs;
+  if (g_capture.state != CAPTURE_FROZEN) return;
+
+  if (g_capture.streamSent == 0) {
+    ++g_capture.id;
+    g_capture.streamFrames = g_capture.filled;
+    g_capture.streamTriggerIndex = g_capture.filled - (CAPTURE_FRAMES - g_capture.preFrames);
+  }
+  const uint8_t total = g_capture.streamFrames;
+  const uint8_t oldest = (total < CAPTURE_FRAMES) ? 0 : g_capture.head;
+  const uint8_t chunks = (total + CAPTURE_CHUNK_FRAMES - 1) / CAPTURE_CHUNK_FRAMES;
+  const uint8_t chunk = g_capture.streamSent / CAPTURE_CHUNK_FRAMES;
+
+  Serial.print(F("{\"type\":\"capture\",\"id\":"));
+  Serial.print(g_capture.id);
+  Serial.print(F(",\"chunk\":"));
+  Serial.print(chunk);
+  Serial.print(F(",\"chunks\":"));
+  Serial.print(chunks);
+  if (chunk == 0) {
+    Serial.print(F(",\"trigger\":"));
+    printCaptureTriggers(g_capture.trigger);
+    Serial.print(F(",\"trigger_ms\":"));
+    Serial.print(g_capture.triggerMs);
+    Serial.print(F(",\"frames\":"));
+    Serial.print(total);
+    Serial.print(F(",\"trigger_index\":"));
+    Serial.print(g_capture.streamTriggerIndex);
+    Serial.print(F(",\"period_us\":"));
+    Serial.print(captureFramePeriodUs(g_capture.divider), 1);
+    Serial.print(F(",\"volts_per_count\":"));
+    Serial.print(ADC_VOLTS_PER_COUNT, 6);
+    Serial.print(F(",\"fields\":[\"before\",\"after\",\"tank\",\"pump_half_pct\",\"flags\"]"));
+  }
+  Serial.print(F(",\"data\":["));
+  for (uint8_t n = 0; n < CAPTURE_CHUNK_FRAMES && g_capture.streamSent < total; ++n) {
+    const uint8_t idx = static_cast<uint8_t>((oldest + g_capture.streamSent) % CAPTURE_FRAMES);
+    const volatile CaptureFrame &frame = g_capture.frames[idx];
+    if (n) Serial.print(',');
+    Serial.print('[');
+    for (uint8_t ch = 0; ch < PRESSURE_CH_COUNT; ++ch) {
+      Serial.print(frame.counts[ch]);
+      Serial.print(',');
+    }
+    Serial.print(frame.pumpHalfPct);
+    Serial.print(',');
+    Serial.print(frame.flags);
+    Serial.print(']');
+    ++g_capture.streamSent;
+  }
+  Serial.println(F("]}"));
+
+  if (g_capture.streamSent >= total) captureArm();
+}
+
+static bool parseCaptureTrigger(const CmdText& name, uint8_t *mask) {
+  for (uint8_t i = 0; i < CAPTURE_TRIGGER_COUNT; ++i) {
+    if (name.equalsIgnoreCase(CAPTURE_TRIGGER_KEYS[i])) {
+      *mask = static_cast<uint8_t>(1U << i);
+      return true;
+    }
+  }
+  return false;
+}
+
+// CAPTURE [STATUS], CAPTURE TRIGGER, CAPTURE ARM, CAPTURE ON|OFF <trigger>,
+// CAPTURE PRE <frames>, CAPTURE DIV <adc rounds>, CAPTURE DP <bar>
+static void handleCaptureCommand(const CmdText& cmd, const CmdText& upper) {
+  CmdText rest = upper.substring(7);
+  rest.trim();
+  CmdText arg = cmd.substring(cmd.length() - rest.length());
+  const int space = arg.indexOf(' ');
+  arg = space < 0 ? CmdText() : arg.substring(space + 1);
+  arg.trim();
+
+  float value = NAN;
+  uint8_t mask = 0;
+  if (!rest.length() || rest == "STATUS") {
+    // status only
+  } else if (rest == "TRIGGER") {
+    if (g_capture.state != CAPTURE_ARMED) {
+      Serial.println(F("# Capture busy; send CAPTURE ARM to discard it"));
+      return;
+    }
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { g_capture.pendingTrigger |= CAPTURE_TRIG_MANUAL; }
+  } else if (rest == "ARM") {
+    captureArm();
+  } else if ((rest.startsWith("ON ") || rest.startsWith("OFF ")) && parseCaptureTrigger(arg, &mask)) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+      if (rest.startsWith("ON ")) g_capture.enabledTriggers |= mask;
+      else                        g_capture.enabledTriggers &= static_cast<uint8_t>(~mask);
+    }
+  } else if (rest.startsWith("PRE ") && tryParseFloat(arg, &value) &&
+             value >= 0.0f && value < CAPTURE_FRAMES) {
+    captureArm();
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { g_capture.preFrames = static_cast<uint8_t>(value); }
+  } else if (rest.startsWith("DIV ") && tryParseFloat(arg, &value) &&
+             value >= 1.0f && value <= 255.0f) {
+    captureArm();
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { g_capture.divider = static_cast<uint8_t>(value); }
+  } else if (rest.startsWith("DP ") && tryParseFloat(arg, &value) &&
+             value >= 0.0f && value < PRESSURE_FSO_BAR) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+      g_capture.deltaPLimitQ16 = static_cast<int32_t>(value * 65536.0f);  // 0 disables
+    }
+  } else {
+    Serial.println(F("# Invalid CAPTURE command"));
+    return;
+  }
+  printCaptureStatus();
+}
+
+static void printSafetyLawConfig(const SafetyLawState &law) {
+  Serial.print(F("# Safety law "));
+  Serial.print(law.key);
+  Serial.print(law.enabled ? F(": enabled, ") : F(": disabled, "));
+  Serial.print(SAFETY_SIGNAL_KEYS[law.signal]);
+  Serial.print(law.compare == SAFETY_ABOVE ? F(" > ") : (law.compare == SAFETY_BELOW ? F(" < ") : F(" stale > ")));
+  Serial.print(law.limit, 3);
+  Serial.print(' ');
+  Serial.print(safetyLawUnits(law));
+  if (isfinite(law.rateLimitPerS)) {
+    Serial.print(F(", rate "));
+    Serial.print(law.rateLimitPerS, 3);
+    Serial.print(F(" /s"));
+  }
+  Serial.print(F(", persist "));
+  Serial.print(law.persistMs);
+  Serial.print(F(" ms"));
+  if (law.latch == SAFETY_AUTO_RESET) {
+    Serial.print(F(", clear band "));
+    Serial.print(law.clearBand, 3);
+    Serial.print(F(", hold "));
+    Serial.print(law.holdMs);
+    Serial.print(F(" ms"));
+  }
+  Serial.println();
+}
+
+// {"type":"safety_laws"}: the law table's configuration, at boot and on SAFETY.
+// Telemetry carries only each law's state.
+static void emitSafetyLawsFrame(unsigned long nowMs) {
+  Serial.print(F("{\"type\":\"safety_laws\",\"t\":"));
+  Serial.print(nowMs / 1000.0f, 3);
+  Serial.print(F(",\"laws\":{"));
+  for (size_t i = 0; i < safetyLawCount(); ++i) {
+    SafetyLawState law;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { law = g_safety_laws[i]; }
+    Serial.print('"');
+    Serial.print(law.key);
+    Serial.print(F("\":{\"label\":\""));
+    Serial.print(law.label);
+    Serial.print(F("\",\"signal\":\""));
+    Serial.print(SAFETY_SIGNAL_KEYS[law.signal]);
+    Serial.print('"');
+    if (law.signal == SAFETY_SIGNAL_TC) {
+      Serial.print(F(",\"channel\":"));
+      Serial.print(law.channel);
+    }
+    Serial.print(F(",\"compare\":\""));
+    Serial.print(law.compare == SAFETY_ABOVE ? F("above") : (law.compare == SAFETY_BELOW ? F("below") : F("stale")));
+    Serial.print(F("\",\"latch\":"));
+    Serial.print(law.latch == SAFETY_LATCH ? F("true") : F("false"));
+    Serial.print(F(",\"actions\":"));
+    Serial.print(law.actions);
+    Serial.print(F(",\"enabled\":"));
+    Serial.print(law.enabled ? F("true") : F("false"));
+    Serial.print(F(",\"limit\":"));
+    Serial.print(law.limit, 3);
+    if (isfinite(law.rateLimitPerS)) {
+      Serial.print(F(",\"rate_limit_per_s\":"));
+      Serial.print(law.rateLimitPerS, 3);
+    }
+    Serial.print(F(",\"persist_ms\":"));
+    Serial.print(law.persistMs);
+    if (law.latch == SAFETY_AUTO_RESET) {
+      Serial.print(F(",\"clear_band\":"));
+      Serial.print(law.clearBand, 3);
+      Serial.print(F(",\"hold_ms\":"));
+      Serial.print(law.holdMs);
+    }
+    Serial.print(F(",\"units\":\""));
+    Serial.print(safetyLawUnits(law));
+    Serial.print(F("\"}"));
+    if (i + 1 < safetyLawCount()) Serial.print(',');
+  }
+  Serial.println(F("}}"));
+}
+
+constexpr float SAFETY_MAX_TIME_MS = 600000.0f;  // PERSIST/HOLD bound, 10 min
+
+// SAFETY ENABLE|DISABLE <law>, SAFETY LIMIT <law> <value>,
+// SAFETY RATE <law> <per_s|OFF>, SAFETY PERSIST <law> <ms>,
+// SAFETY BAND <law> <value>, SAFETY HOLD <law> <ms> (the last two auto-reset laws only)
+static void handleSafetyCommand(const CmdText& cmd, const CmdText& upper) {
+  CmdText rest = upper.substring(7);
+  rest.trim();
+  const int verbEnd = rest.indexOf(' ');
+  if (verbEnd < 0) {
+    Serial.println(F("# Invalid SAFETY command"));
+    return;
+  }
+  const CmdText verb = rest.substring(0, verbEnd);
+  CmdText args = cmd.substring(cmd.length() - rest.length() + verbEnd);
+  args.trim();
+  const int keyEnd = args.indexOf(' ');
+  const CmdText key = keyEnd < 0 ? args : args.substring(0, keyEnd);
+  CmdText value = keyEnd < 0 ? CmdText() : args.substring(keyEnd + 1);
+  value.trim();
+
+  const int idx = findSafetyLaw(key);
+  if (idx < 0) {
+    Serial.print(F("# Unknown safety law: "));
+    printlnCmdText(key);
+    return;
+  }
+  SafetyLawState &law = g_safety_laws[idx];
+
+  float number = NAN;
+  bool ok = true;
+  if (verb == "ENABLE" || verb == "DISABLE") {
+    ok = !value.length();
+    if (ok) ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { law.enabled = (verb == "ENABLE"); }
+  } else if (verb == "LIMIT") {
+    ok = tryParseFloat(value, &number);
+    if (ok) ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { law.limit = number; }
+  } else if (verb == "RATE") {
+    if (value.equalsIgnoreCase("OFF")) number = NAN;
+    else ok = tryParseFloat(value, &number) && number > 0.0f;
+    if (ok) {
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        law.rateLimitPerS = number;
+        law.ratePerS = NAN;
+        law.rateRefValue = NAN;
+      }
     }
-  } else if (okM && VFD_RATED_OUTPUT_POWER_W > 0.0f) {
-    g_vfd.inputPowerW = g_vfd.inputPowerPct * 0.01f * VFD_RATED_OUTPUT_POWER_W;
-    g_vfd.inputPowerKw = g_vfd.inputPowerW / 1000.0f;
+  } else if (verb == "PERSIST") {
+    ok = tryParseFloat(value, &number) && number >= 0.0f && number <= SAFETY_MAX_TIME_MS;
+    if (ok) ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { law.persistMs = static_cast<uint32_t>(number); }
+  } else if (verb == "BAND") {
+    ok = law.latch == SAFETY_AUTO_RESET && tryParseFloat(value, &number) && number >= 0.0f;
+    if (ok) ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { law.clearBand = number; }
+  } else if (verb == "HOLD") {
+    ok = law.latch == SAFETY_AUTO_RESET && tryParseFloat(value, &number) &&
+         number >= 0.0f && number <= SAFETY_MAX_TIME_MS;
+    if (ok) ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { law.holdMs = static_cast<uint32_t>(number); }
+  } else {
+    ok = false;
   }
 
-  return true;
+  if (!ok) {
+    Serial.println(F("# Invalid SAFETY command"));
+    return;
+  }
+  if (idx == SAFETY_LAW_PUMP_DELTA_P_HIGH) updateFastDeltaPLimit();
+  SafetyLawState snapshot;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { snapshot = law; }
+  printSafetyLawConfig(snapshot);
 }
 
-static bool flowReadMeasurements(uint16_t *vals) {
-  uint8_t frame[8];
-
-  frame[0] = FLOW_SLAVE_ADDR;
-  frame[1] = 0x04;                  // Read Input Registers
-  frame[2] = FLOW_REG_START >> 8;
-  frame[3] = FLOW_REG_START & 0xFF;
-  frame[4] = 0x00;
-  frame[5] = FLOW_REG_COUNT;
+// ── Thermocouple acquisition ─────────────────────────────────────────────
+// Disabled channels are left with auto-conversion off.
+static void configureTcChannel(uint8_t ch, unsigned long nowMs) {
+  hal::ThermocoupleDevice *dev = g_tc.device(ch);
+  if (!dev) return;
+  const hal::ThermocoupleConfig config = {
+    g_params.tcTypes[ch], g_params.tcAvg[ch], g_params.tcFilterHz[ch] == 50, g_params.tcPeriodMs[ch] != 0,
+  };
+  dev->configure(config);
+  g_tc.schedule(ch, tcEffectivePeriodMs(ch), nowMs + tcConversionMs(ch));  // first conversion
+  publishControlTemp(ch, NAN, nowMs);
+}
 
-  uint16_t crc = modbusCRC(frame, 6);
-  frame[6] = crc & 0xFF;
-  frame[7] = crc >> 8;
+// Latest reading per channel for the 1 Hz line and heaters; disabled or
+// no-longer-refreshed channels report NAN.
+static void latestTcTemps(float raw[], unsigned long nowMs) {
+  for (uint8_t i = 0; i < NUM_TCS; ++i) raw[i] = g_tc.latest(i, nowMs, TC_POLL_MS);
+}
 
-  while (FLOW.available()) FLOW.read();
+// ── Parameter store ──────────────────────────────────────────────────────
+enum ParamType : uint8_t { PARAM_LONG, PARAM_FLOAT, PARAM_U16, PARAM_TC_TYPE, PARAM_TC_AVG, PARAM_TC_FILTER };
 
-  FLOW.write(frame, 8);
-  FLOW.flush();
+enum ParamEffect : uint8_t {
+  PARAM_EFFECT_RSV_SCALE,  // restart the reservoir filter
+  PARAM_EFFECT_PRESSURE,   // recompute the ISR delta-P coefficients
+  PARAM_EFFECT_TC_TYPE,    // reprogram the MAX31856
+  PARAM_EFFECT_TARGET,     // re-evaluate LN auto status
+  PARAM_EFFECT_TC_CAL,     // picked up by the next TC read
+  PARAM_EFFECT_TC_ACQ,     // reprogram the MAX31856 and reschedule the channel
+};
 
-  const uint8_t expectedLen = 3 + 2 * FLOW_REG_COUNT + 2;
-  uint8_t buf[32];
-  uint8_t len = 0;
-  unsigned long start = millis();
+struct ParamDesc {
+  const char  *key;
+  ParamType    type;
+  uint8_t      offset;
+  uint8_t      count;
+  float        minValue;
+  float        maxValue;
+  ParamEffect  effect;
+};
 
-  while ((millis() - start) < 250 && len < expectedLen) {
-    if (FLOW.available()) {
-      buf[len++] = static_cast<uint8_t>(FLOW.read());
-    }
-  }
+static const char TC_TYPE_LETTERS[] = "BEJKNRST";  // MAX31856_TCTYPE_B .. _T
+
+static const ParamDesc PARAM_DESCS[] = {
+  { "rsv_tare_counts",       PARAM_LONG,    offsetof(ParamBlock, rsvScaleTareCounts),  1,           -8388608.0f, 8388607.0f, PARAM_EFFECT_RSV_SCALE },
+  { "rsv_counts_per_kg",     PARAM_FLOAT,   offsetof(ParamBlock, rsvScaleCountsPerKg), 1,           -1.0e7f,     1.0e7f,     PARAM_EFFECT_RSV_SCALE },
+  { "pressure_after_zero_v", PARAM_FLOAT,   offsetof(ParamBlock, pressureAfterZeroV),  1,           0.0f,        1.0f,       PARAM_EFFECT_PRESSURE },
+  { "pressure_fso_v",        PARAM_FLOAT,   offsetof(ParamBlock, pressureFsoV),        1,           2.0f,        ADC_REF_V,  PARAM_EFFECT_PRESSURE },
+  { "tc_type",               PARAM_TC_TYPE, offsetof(ParamBlock, tcTypes),             NUM_TCS, 0.0f,        7.0f,       PARAM_EFFECT_TC_TYPE },
+  { "hfe_goal_c",            PARAM_FLOAT,   offsetof(ParamBlock, hfeGoalC),            1,           -273.15f,    500.0f,     PARAM_EFFECT_TARGET },
+  { "hx_limit_c",            PARAM_FLOAT,   offsetof(ParamBlock, hxLimitC),            1,           -273.15f,    500.0f,     PARAM_EFFECT_TARGET },
+  { "hx_approach_c",         PARAM_FLOAT,   offsetof(ParamBlock, hxApproachC),         1,           0.0f,        500.0f,     PARAM_EFFECT_TARGET },
+  { "ln_auto_hysteresis_c",  PARAM_FLOAT,   offsetof(ParamBlock, lnAutoHysteresisC),   1,           0.0f,        500.0f,     PARAM_EFFECT_TARGET },
+  { "tc_gain",               PARAM_FLOAT,   offsetof(ParamBlock, tcGain),              NUM_TCS, 0.5f,        2.0f,       PARAM_EFFECT_TC_CAL },
+  { "tc_offset_c",           PARAM_FLOAT,   offsetof(ParamBlock, tcOffsetC),           NUM_TCS, -50.0f,      50.0f,      PARAM_EFFECT_TC_CAL },
+  { "tc_avg",                PARAM_TC_AVG,  offsetof(ParamBlock, tcAvg),               NUM_TCS, 1.0f,        16.0f,      PARAM_EFFECT_TC_ACQ },
+  { "tc_filter_hz",          PARAM_TC_FILTER, offsetof(ParamBlock, tcFilterHz),        NUM_TCS, 50.0f,       60.0f,      PARAM_EFFECT_TC_ACQ },
+  { "tc_period_ms",          PARAM_U16,     offsetof(ParamBlock, tcPeriodMs),          NUM_TCS, 0.0f,        60000.0f,   PARAM_EFFECT_TC_ACQ },
+};
 
-  if (len != expectedLen) {
-    return false;
+constexpr size_t PARAM_DESC_COUNT = sizeof(PARAM_DESCS) / sizeof(PARAM_DESCS[0]);
+
+static uint8_t     g_param_slot = 1;  // slot holding the newest commit; the next commit uses the other
+static const char *g_params_source = "defaults";
+static uint8_t     g_params_defaulted = 0;  // stored fields rejected at load
+
+static void setParamDefaults(ParamBlock *block) {
+  *block = {};
+  block->magic = PARAM_MAGIC;
+  block->version = PARAM_VERSION;
+  block->length = static_cast<uint8_t>(offsetof(ParamBlock, crc) + sizeof(block->crc));
+  block->channelMap = TC_CHANNEL_MAP_CRC;
+  block->rsvScaleTareCounts = DEFAULT_RSV_SCALE_TARE_COUNTS;
+  block->rsvScaleCountsPerKg = DEFAULT_RSV_SCALE_COUNTS_PER_KG;
+  block->pressureAfterZeroV = DEFAULT_PRESSURE_AFTER_ZERO_V;
+  block->pressureFsoV = DEFAULT_PRESSURE_FSO_V;
+  for (size_t i = 0; i < NUM_TCS; ++i) {
+    const TcChannelDef &def = TC_CHANNELS[i];
+    block->tcTypes[i] = def.tcType;
+    block->tcGain[i] = def.gain;
+    block->tcOffsetC[i] = def.offsetC;
+    block->tcAvg[i] = def.avg;
+    block->tcFilterHz[i] = DEFAULT_TC_FILTER_HZ;
+    block->tcPeriodMs[i] = def.periodMs;
   }
+  block->hfeGoalC = DEFAULT_HFE_GOAL_C;
+  block->hxLimitC = DEFAULT_HX_LIMIT_C;
+  block->hxApproachC = DEFAULT_HX_APPROACH_C;
+  block->lnAutoHysteresisC = DEFAULT_LN_AUTO_HYSTERESIS_C;
+}
 
-  uint16_t crcResp = (uint16_t)buf[len - 1] << 8 | buf[len - 2];
-  uint16_t crcCalc = modbusCRC(buf, len - 2);
-  if (crcResp != crcCalc) {
-    return false;
+static int findParam(const CmdText& key) {
+  for (size_t i = 0; i < PARAM_DESC_COUNT; ++i) {
+    if (key.equalsIgnoreCase(PARAM_DESCS[i].key)) return static_cast<int>(i);
   }
+  return -1;
+}
 
-  if (buf[0] != FLOW_SLAVE_ADDR || buf[1] != 0x04) {
-    return false;
+static size_t paramTypeBytes(ParamType type) {
+  switch (type) {
+    case PARAM_LONG:  return sizeof(long);
+    case PARAM_FLOAT: return sizeof(float);
+    case PARAM_U16:   return sizeof(uint16_t);
+    default:          return 1;
   }
+}
 
-  if (buf[2] != 2 * FLOW_REG_COUNT) {
-    return false;
+static float readParamField(const ParamBlock& block, const ParamDesc& desc, uint8_t idx) {
+  const uint8_t *field = reinterpret_cast<const uint8_t*>(&block) + desc.offset + idx * paramTypeBytes(desc.type);
+  if (paramTypeBytes(desc.type) == 1) return *field;
+  if (desc.type == PARAM_U16) {
+    uint16_t value;
+    memcpy(&value, field, sizeof(value));
+    return value;
   }
-
-  for (uint8_t i = 0; i < FLOW_REG_COUNT; ++i) {
-    vals[i] = ((uint16_t)buf[3 + 2 * i] << 8) | buf[4 + 2 * i];
+  if (desc.type == PARAM_LONG) {
+    long value;
+    memcpy(&value, field, sizeof(value));
+    return static_cast<float>(value);
   }
-
-  return true;
+  float value;
+  memcpy(&value, field, sizeof(value));
+  return value;
 }
 
-static bool pollFlowMeter() {
-  uint16_t regs[FLOW_REG_COUNT];
-  const bool ok = flowReadMeasurements(regs);
-  g_flow.lastPollMs = millis();
-  if (!ok) {
-    g_flow.valid = false;
-    g_flow.flowVelocityMps = NAN;
-    g_flow.volumeFlowM3s = NAN;
-    g_flow.massFlowKgS = NAN;
-    g_flow.temperatureRaw = NAN;
-    g_flow.densityKgM3 = NAN;
-    return false;
+static void writeParamField(ParamBlock *block, const ParamDesc& desc, uint8_t idx, float value) {
+  uint8_t *field = reinterpret_cast<uint8_t*>(block) + desc.offset + idx * paramTypeBytes(desc.type);
+  if (paramTypeBytes(desc.type) == 1) {
+    *field = static_cast<uint8_t>(value);
+  } else if (desc.type == PARAM_U16) {
+    const uint16_t rounded = static_cast<uint16_t>(lroundf(value));
+    memcpy(field, &rounded, sizeof(rounded));
+  } else if (desc.type == PARAM_LONG) {
+    const long rounded = lroundf(value);
+    memcpy(field, &rounded, sizeof(rounded));
+  } else {
+    memcpy(field, &value, sizeof(value));
   }
-
-  g_flow.valid = true;
-  g_flow.flowVelocityMps = regsToFloatBE(&regs[0]);
-  g_flow.volumeFlowM3s   = regsToFloatBE(&regs[2]);
-  g_flow.massFlowKgS     = regsToFloatBE(&regs[4]);
-  g_flow.temperatureRaw  = regsToFloatBE(&regs[6]);
-  g_flow.densityKgM3     = regsToFloatBE(&regs[8]);
-  return true;
 }
 
-static const char* rsvScaleErrorKey(RsvScaleError error) {
-  switch (error) {
-    case RSV_SCALE_TIMEOUT: return "timeout";
-    case RSV_SCALE_INVALID_FRAME: return "invalid_frame";
-    default: return "none";
+static bool paramValueValid(const ParamDesc& desc, float value) {
+  if (!isfinite(value) || value < desc.minValue || value > desc.maxValue) return false;
+  if (desc.type == PARAM_FLOAT) return true;
+  if (value != floorf(value)) return false;
+  if (desc.type == PARAM_TC_AVG) {
+    const uint8_t n = static_cast<uint8_t>(value);
+    return (n & (n - 1)) == 0;  // 1, 2, 4, 8, 16
   }
+  return desc.type != PARAM_TC_FILTER || value == 50.0f || value == 60.0f;
 }
 
-static bool readRsvScaleRaw(long *out, long *rawCandidate, RsvScaleError *error) {
-  if (!out) return false;
-  if (rawCandidate) *rawCandidate = 0L;
-  if (error) *error = RSV_SCALE_OK;
-
-  const unsigned long startUs = micros();
-  while (digitalRead(RSV_SCALE_DATA_PIN) == HIGH) {
-    if ((unsigned long)(micros() - startUs) >= RSV_SCALE_TIMEOUT_US) {
-      if (error) *error = RSV_SCALE_TIMEOUT;
-      return false;
+// Accepts a number, or a type letter (B/E/J/K/N/R/S/T) for tc_type.
+static bool parseParamValue(const ParamDesc& desc, const CmdText& text, float *out) {
+  if (desc.type == PARAM_TC_TYPE && text.length() == 1) {
+    const char *letter = strchr(TC_TYPE_LETTERS, toupper(text[0]));
+    if (letter && *letter) {
+      *out = static_cast<float>(letter - TC_TYPE_LETTERS);
+      return true;
     }
   }
+  return tryParseFloat(text, out) && paramValueValid(desc, *out);
+}
 
-  unsigned long value = 0;
-  noInterrupts();
-  for (uint8_t i = 0; i < 24; ++i) {
-    digitalWrite(RSV_SCALE_CLOCK_PIN, HIGH);
-    delayMicroseconds(1);
-    value = (value << 1) | (digitalRead(RSV_SCALE_DATA_PIN) ? 1UL : 0UL);
-    digitalWrite(RSV_SCALE_CLOCK_PIN, LOW);
-    delayMicroseconds(1);
+static void printParamValue(const ParamBlock& block, const ParamDesc& desc, uint8_t idx) {
+  const float value = readParamField(block, desc, idx);
+  if (desc.type == PARAM_TC_TYPE) {
+    Serial.print('"');
+    Serial.print(value < 8.0f ? TC_TYPE_LETTERS[static_cast<uint8_t>(value)] : '?');
+    Serial.print('"');
+  } else if (desc.type == PARAM_FLOAT) {
+    Serial.print(value, 4);
+  } else {
+    Serial.print(lroundf(value));
   }
+}
 
-  // One extra clock pulse selects channel A at gain 128 for the next HX711 conversion.
-  digitalWrite(RSV_SCALE_CLOCK_PIN, HIGH);
-  delayMicroseconds(1);
-  digitalWrite(RSV_SCALE_CLOCK_PIN, LOW);
-  interrupts();
+static int eepromParamSlotAddr(uint8_t slot) {
+  return EEPROM_PARAM_ADDR + slot * EEPROM_PARAM_SLOT_BYTES;
+}
 
-  if (value & 0x800000UL) {
-    value |= 0xFF000000UL;
+// Loads one slot over the defaults. A block from older firmware carries fewer
+// fields and a newer one more; only the common prefix is used. Fields out of
+// range fall back to their default and are counted in *defaulted.
+static bool readParamSlot(uint8_t slot, ParamBlock *out, uint8_t *defaulted) {
+  uint8_t buf[EEPROM_PARAM_SLOT_BYTES];
+  const int addr = eepromParamSlotAddr(slot);
+  for (size_t i = 0; i < offsetof(ParamBlock, rsvScaleTareCounts); ++i) buf[i] = EEPROM.read(addr + i);
+
+  ParamBlock header;
+  memcpy(&header, buf, offsetof(ParamBlock, rsvScaleTareCounts));
+  const size_t minLength = offsetof(ParamBlock, rsvScaleTareCounts) + sizeof(header.crc);
+  if (header.magic != PARAM_MAGIC || header.version != PARAM_VERSION ||
+      header.channelMap != TC_CHANNEL_MAP_CRC ||
+      header.length < minLength || header.length > EEPROM_PARAM_SLOT_BYTES) {
+    return false;
+  }
+  for (size_t i = 0; i < header.length; ++i) buf[i] = EEPROM.read(addr + i);
+  uint16_t crc;
+  memcpy(&crc, buf + header.length - sizeof(crc), sizeof(crc));
+  if (modbusCRC(buf, header.length - sizeof(crc)) != crc) return false;
+
+  ParamBlock defaults;
+  setParamDefaults(&defaults);
+  *out = defaults;
+  const size_t stored = header.length - sizeof(crc);
+  memcpy(out, buf, stored < offsetof(ParamBlock, crc) ? stored : offsetof(ParamBlock, crc));
+  out->length = defaults.length;
+
+  *defaulted = 0;
+  for (size_t i = 0; i < PARAM_DESC_COUNT; ++i) {
+    const ParamDesc& desc = PARAM_DESCS[i];
+    for (uint8_t idx = 0; idx < desc.count; ++idx) {
+      if (!paramValueValid(desc, readParamField(*out, desc, idx))) {
+        writeParamField(out, desc, idx, readParamField(defaults, desc, idx));
+        ++*defaulted;
+      }
+    }
   }
-
-  const long signedValue = static_cast<long>(value);
-  if (rawCandidate) *rawCandidate = signedValue;
-  
-
-  *out = signedValue;
   return true;
 }
 
-static void pollRsvScale(unsigned long nowMs) {
-  long raw = 0L;
-  long rawCandidate = 0L;
-  RsvScaleError error = RSV_SCALE_OK;
-  g_rsv_scale.lastReadMs = nowMs;
-
-  if (!readRsvScaleRaw(&raw, &rawCandidate, &error)) {
-    g_rsv_scale.valid = false;
-    g_rsv_scale.rawCounts = 0L;
-    g_rsv_scale.lastRawCandidate = rawCandidate;
-    g_rsv_scale.error = error;
-    g_rsv_scale.massKg = NAN;
+static void loadParams() {
+  ParamBlock slots[2];
+  uint8_t defaulted[2] = { 0, 0 };
+  bool valid[2];
+  for (uint8_t slot = 0; slot < 2; ++slot) valid[slot] = readParamSlot(slot, &slots[slot], &defaulted[slot]);
+
+  int chosen = -1;
+  if (valid[0] && valid[1]) chosen = static_cast<int16_t>(slots[1].seq - slots[0].seq) > 0 ? 1 : 0;
+  else if (valid[0]) chosen = 0;
+  else if (valid[1]) chosen = 1;
+
+  if (chosen < 0) {
+    setParamDefaults(&g_params);
+    g_param_slot = 1;
+    g_params_source = "defaults";
+    g_params_defaulted = 0;
+  } else {
+    g_params = slots[chosen];
+    g_param_slot = static_cast<uint8_t>(chosen);
+    g_params_source = "eeprom";
+    g_params_defaulted = defaulted[chosen];
+  }
+  g_params_targets_dirty = false;
+  g_params_cal_dirty = false;
+  g_params_autosave_ms = 0;
+  applyPressureCalibration();
+
+  Serial.print(F("# Params: "));
+  if (chosen < 0) {
+    Serial.println(F("defaults (no valid EEPROM block for channel map " TC_CHANNEL_MAP_ID ")"));
     return;
   }
-
-  g_rsv_scale.valid = true;
-  g_rsv_scale.rawCounts = raw;
-  g_rsv_scale.lastRawCandidate = raw;
-  g_rsv_scale.error = RSV_SCALE_OK;
-  if (fabs(RSV_SCALE_COUNTS_PER_KG) > 1.0e-9f) {
-    g_rsv_scale.massKg = (static_cast<float>(raw - RSV_SCALE_TARE_COUNTS)) / RSV_SCALE_COUNTS_PER_KG;
-  } else {
-    g_rsv_scale.massKg = NAN;
+  Serial.print(F("EEPROM slot "));
+  Serial.print(g_param_slot);
+  Serial.print(F(", seq "));
+  Serial.print(g_params.seq);
+  if (g_params_defaulted) {
+    Serial.print(F(", "));
+    Serial.print(g_params_defaulted);
+    Serial.print(F(" field(s) out of range, using defaults"));
   }
+  Serial.println();
 }
 
-static bool tryParseFloat(const String& text, float *out) {
-  if (!out) return false;
-  String trimmed = text;
-  trimmed.trim();
-  if (!trimmed.length()) return false;
-  if (trimmed.length() >= 32) return false;
-
-  char buf[32];
-  trimmed.toCharArray(buf, sizeof(buf));
-
-  char *endPtr = nullptr;
-  const double value = strtod(buf, &endPtr);
-  if (endPtr == buf || (endPtr && *endPtr != '\0') || !isfinite(value)) return false;
-
-  *out = static_cast<float>(value);
-  return true;
+// Writes a block to the slot not holding the newest commit. EEPROM.put only
+// rewrites bytes that changed, typically the targets, seq and CRC.
+static void writeParamBlock(ParamBlock block) {
+  block.magic = PARAM_MAGIC;
+  block.version = PARAM_VERSION;
+  block.length = static_cast<uint8_t>(offsetof(ParamBlock, crc) + sizeof(block.crc));
+  block.channelMap = TC_CHANNEL_MAP_CRC;
+  block.seq = g_params.seq + 1;
+  block.crc = modbusCRC(reinterpret_cast<const uint8_t*>(&block), offsetof(ParamBlock, crc));
+
+  const uint8_t slot = g_param_slot ^ 1U;
+  EEPROM.put(eepromParamSlotAddr(slot), block);
+  g_param_slot = slot;
+  g_params.seq = block.seq;
+  g_params_source = "eeprom";
 }
 
-static bool parseFloatSuffix(const String& cmd, size_t prefixLen, float *out) {
-  if (!out) return false;
-  String rest = cmd.substring(prefixLen);
-  rest.trim();
-  return tryParseFloat(rest, out);
+static void commitParams() {
+  ParamBlock block;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { block = g_params; }
+  writeParamBlock(block);
+  g_params_targets_dirty = false;
+  g_params_cal_dirty = false;
+  g_params_autosave_ms = 0;
 }
 
-static bool parseFloatArgs(const String& cmd, size_t prefixLen, float values[], size_t count) {
-  if (!values || count == 0) return false;
-  String rest = cmd.substring(prefixLen);
-  rest.trim();
-  if (!rest.length() || rest.length() >= 80) return false;
-
-  char buf[80];
-  rest.toCharArray(buf, sizeof(buf));
-  char *cursor = buf;
-
-  for (size_t i = 0; i < count; ++i) {
-    while (*cursor == ' ' || *cursor == '\t' || *cursor == ',') ++cursor;
-    if (*cursor == '\0') return false;
+// Commits after PARAM_AUTOSAVE_MS without further target changes, so a run of
+// SETPOINT nudges costs one EEPROM write. Only the target fields are written:
+// with other changes pending they go on top of the last committed block, and
+// the rest still waits for PARAM COMMIT.
+static void persistParamsIfDue(unsigned long nowMs) {
+  if (!g_params_autosave_ms || nowMs - g_params_autosave_ms < PARAM_AUTOSAVE_MS) return;
+  g_params_autosave_ms = 0;
+  if (!g_params_cal_dirty) {
+    commitParams();
+  } else {
+    ParamBlock block;
+    uint8_t defaulted = 0;
+    if (!readParamSlot(g_param_slot, &block, &defaulted)) {
+      if (strcmp(g_params_source, "defaults") != 0) {
+        Serial.println(F("# Auto targets not saved: committed block unreadable (send PARAM COMMIT)"));
+        return;
+      }
+      setParamDefaults(&block);  // nothing committed yet: boot would load the defaults
+    }
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+      for (size_t i = 0; i < PARAM_DESC_COUNT; ++i) {
+        const ParamDesc& desc = PARAM_DESCS[i];
+        if (desc.effect != PARAM_EFFECT_TARGET) continue;
+        for (uint8_t idx = 0; idx < desc.count; ++idx) writeParamField(&block, desc, idx, readParamField(g_params, desc, idx));
+      }
+    }
+    writeParamBlock(block);
+    g_params_targets_dirty = false;
+  }
+  Serial.print(F("# Auto targets saved to EEPROM (seq "));
+  Serial.print(g_params.seq);
+  Serial.println(g_params_cal_dirty ? F("; other changes still need PARAM COMMIT)") : F(")"));
+}
 
-    char *endPtr = nullptr;
-    const double value = strtod(cursor, &endPtr);
-    if (endPtr == cursor || !isfinite(value)) return false;
-    values[i] = static_cast<float>(value);
-    cursor = endPtr;
+static void applyParamEffect(const ParamDesc& desc, uint8_t idx) {
+  switch (desc.effect) {
+    case PARAM_EFFECT_RSV_SCALE:
+      resetRsvScaleFilter(millis());
+      break;
+    case PARAM_EFFECT_PRESSURE:
+      applyPressureCalibration();
+      updateFastDeltaPLimit();
+      break;
+    case PARAM_EFFECT_TC_TYPE:
+    case PARAM_EFFECT_TC_ACQ:
+      configureTcChannel(idx, millis());
+      break;
+    case PARAM_EFFECT_TARGET:
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { refreshAutoStatusAfterTargetChange(); }
+      markTargetsChanged();
+      break;
+    case PARAM_EFFECT_TC_CAL:
+      break;
   }
+}
 
-  while (*cursor == ' ' || *cursor == '\t' || *cursor == ',') ++cursor;
-  return *cursor == '\0';
+static void printParamList() {
+  ParamBlock snapshot;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { snapshot = g_params; }
+  Serial.print(F("{\"type\":\"params\",\"source\":\""));
+  Serial.print(g_params_source);
+  Serial.print(F("\",\"version\":"));
+  Serial.print(PARAM_VERSION);
+  Serial.print(F(",\"channel_map\":\"" TC_CHANNEL_MAP_ID "\",\"slot\":"));
+  Serial.print(g_param_slot);
+  Serial.print(F(",\"seq\":"));
+  Serial.print(snapshot.seq);
+  Serial.print(F(",\"dirty\":"));
+  Serial.print(g_params_targets_dirty || g_params_cal_dirty ? F("true") : F("false"));
+  Serial.print(F(",\"targets_dirty\":"));
+  Serial.print(g_params_targets_dirty ? F("true") : F("false"));
+  Serial.print(F(",\"cal_dirty\":"));
+  Serial.print(g_params_cal_dirty ? F("true") : F("false"));
+  Serial.print(F(",\"defaulted\":"));
+  Serial.print(g_params_defaulted);
+  Serial.print(F(",\"values\":{"));
+  for (size_t i = 0; i < PARAM_DESC_COUNT; ++i) {
+    const ParamDesc& desc = PARAM_DESCS[i];
+    if (i) Serial.print(',');
+    Serial.print('"');
+    Serial.print(desc.key);
+    Serial.print(F("\":"));
+    if (desc.count > 1) Serial.print('[');
+    for (uint8_t idx = 0; idx < desc.count; ++idx) {
+      if (idx) Serial.print(',');
+      printParamValue(snapshot, desc, idx);
+    }
+    if (desc.count > 1) Serial.print(']');
+  }
+  Serial.println(F("}}"));
 }
 
-static const char* autoCloseReasonKey(AutoCloseReason reason) {
-  switch (reason) {
-    case AUTO_CLOSE_MISSING_THI: return "missing_thi";
-    case AUTO_CLOSE_MISSING_HFE_TEMP: return "missing_hfe_temp";
-    case AUTO_CLOSE_THI_LIMIT: return "thi_limit";
-    case AUTO_CLOSE_HFE_GOAL: return "hfe_goal";
-    default: return "none";
+static void printParamAck(const char *prefix, const ParamDesc& desc, uint8_t idx, const char *suffix) {
+  ParamBlock snapshot;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { snapshot = g_params; }
+  Serial.print(prefix);
+  Serial.print(desc.key);
+  if (desc.count > 1) {
+    Serial.print('[');
+    Serial.print(idx);
+    Serial.print(']');
   }
+  Serial.print(F(" = "));
+  printParamValue(snapshot, desc, idx);
+  Serial.println(suffix);
 }
 
-static void updateAutoValveStatusFromValues(float thiTemp, float hfeTempC) {
-  g_auto_status.thiTempC = thiTemp;
-  g_auto_status.hfeTempC = hfeTempC;
-  g_auto_status.thiValid = isfinite(thiTemp);
-  g_auto_status.hfeValid = isfinite(hfeTempC);
-  g_auto_status.thiCloseThresholdC = g_hx_limit_c;
-  g_auto_status.hfeCloseThresholdC = g_hfe_goal_c;
-  // THI reopens when it approaches TMI within g_hx_approach_c; HFE reopen keeps hysteresis.
-  g_auto_status.thiReopenThresholdC = isfinite(hfeTempC) ? (hfeTempC - g_hx_approach_c) : NAN;
-  g_auto_status.hfeReopenThresholdC = g_hfe_goal_c + g_ln_auto_hysteresis_c;
-  g_auto_status.closeRequested = false;
-  g_auto_status.readyToOpen = false;
-  g_auto_status.reason = AUTO_CLOSE_NONE;
-
-  if (!g_auto_status.thiValid) {
-    g_auto_status.closeRequested = true;
-    g_auto_status.reason = AUTO_CLOSE_MISSING_THI;
+// PARAM LIST | GET <key> [idx] | SET <key> [idx] <value> | COMMIT | DEFAULTS
+static void handleParamCommand(const CmdText& cmd, const CmdText& upper) {
+  CmdText rest = upper.substring(5);
+  rest.trim();
+  if (rest == "LIST" || !rest.length()) {
+    printParamList();
     return;
   }
-
-  if (!g_auto_status.hfeValid) {
-    g_auto_status.closeRequested = true;
-    g_auto_status.reason = AUTO_CLOSE_MISSING_HFE_TEMP;
+  if (rest == "COMMIT") {
+    commitParams();
+    Serial.print(F("# Params committed to EEPROM slot "));
+    Serial.print(g_param_slot);
+    Serial.print(F(" (seq "));
+    Serial.print(g_params.seq);
+    Serial.println(F(")"));
     return;
   }
-
-  if (thiTemp <= g_hx_limit_c) {
-    g_auto_status.closeRequested = true;
-    g_auto_status.reason = AUTO_CLOSE_THI_LIMIT;
+  if (rest == "DEFAULTS") {
+    ParamBlock defaults;
+    setParamDefaults(&defaults);
+    defaults.seq = g_params.seq;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { g_params = defaults; }
+    for (size_t i = 0; i < PARAM_DESC_COUNT; ++i) {
+      for (uint8_t idx = 0; idx < PARAM_DESCS[i].count; ++idx) applyParamEffect(PARAM_DESCS[i], idx);
+    }
+    g_params_cal_dirty = true;  // the whole reset waits for PARAM COMMIT, targets included
+    g_params_targets_dirty = false;
+    g_params_autosave_ms = 0;
+    Serial.println(F("# Params reset to defaults (send PARAM COMMIT to store)"));
     return;
   }
 
-  if (hfeTempC <= g_hfe_goal_c) {
-    g_auto_status.closeRequested = true;
-    g_auto_status.reason = AUTO_CLOSE_HFE_GOAL;
+  const bool isSet = rest.startsWith("SET ");
+  if (!isSet && !rest.startsWith("GET ")) {
+    Serial.println(F("# Invalid PARAM command"));
     return;
   }
-
-  g_auto_status.readyToOpen =
-    isfinite(g_auto_status.thiReopenThresholdC) &&
-    thiTemp >= g_auto_status.thiReopenThresholdC &&
-    hfeTempC >= g_auto_status.hfeReopenThresholdC;
-}
-
-static void updateAutoValveStatus(const float temps[], size_t count) {
-  const float thiTemp =
-    (temps && count > THI_SENSOR_INDEX && isfinite(temps[THI_SENSOR_INDEX]))
-      ? temps[THI_SENSOR_INDEX]
-      : NAN;
-  const float hfeTempC =
-    (temps && count > HFE_AUTO_SENSOR_INDEX && isfinite(temps[HFE_AUTO_SENSOR_INDEX]))
-      ? temps[HFE_AUTO_SENSOR_INDEX]
-      : NAN;
-
-  updateAutoValveStatusFromValues(thiTemp, hfeTempC);
-  g_auto_status_sampled = true;
-}
-
-static void runAutoValveControl() {
-  if (g_auto_status.closeRequested) {
-    g_auto_close_latched = true;
-    applyValve(CLOSED);
+  CmdText args = cmd.substring(cmd.length() - rest.length() + 4);
+  args.trim();
+  const int keyEnd = args.indexOf(' ');
+  const CmdText key = keyEnd < 0 ? args : args.substring(0, keyEnd);
+  args = keyEnd < 0 ? CmdText() : args.substring(keyEnd + 1);
+  args.trim();
+
+  const int descIdx = findParam(key);
+  if (descIdx < 0) {
+    Serial.print(F("# Unknown param: "));
+    printlnCmdText(key);
     return;
   }
+  const ParamDesc& desc = PARAM_DESCS[descIdx];
+
+  uint8_t idx = 0;
+  if (desc.count > 1) {
+    const int idxEnd = args.indexOf(' ');
+    const CmdText idxText = idxEnd < 0 ? args : args.substring(0, idxEnd);
+    float idxValue = NAN;
+    if (!tryParseFloat(idxText, &idxValue) || idxValue < 0.0f || idxValue >= desc.count ||
+        idxValue != floorf(idxValue)) {
+      Serial.println(F("# Invalid PARAM index"));
+      return;
+    }
+    idx = static_cast<uint8_t>(idxValue);
+    args = idxEnd < 0 ? CmdText() : args.substring(idxEnd + 1);
+    args.trim();
+  }
 
-  if (g_auto_close_latched && !g_auto_status.readyToOpen) {
-    applyValve(CLOSED);
+  if (!isSet) {
+    if (args.length()) {
+      Serial.println(F("# Invalid PARAM command"));
+      return;
+    }
+    printParamAck("# Param ", desc, idx, g_params_cal_dirty ? " (uncommitted changes pending)" : "");
     return;
   }
 
-  g_auto_close_latched = false;
-  applyValve(OPEN);
-}
-
-static void refreshAutoStatusAfterTargetChange() {
-  updateAutoValveStatusFromValues(g_auto_status.thiTempC, g_auto_status.hfeTempC);
-  if (g_mode == AUTO && g_auto_status_sampled) {
-    runAutoValveControl();
+  float value = NAN;
+  if (!parseParamValue(desc, args, &value)) {
+    Serial.print(F("# Invalid value for "));
+    Serial.println(desc.key);
+    return;
   }
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { writeParamField(&g_params, desc, idx, value); }
+  if (desc.effect != PARAM_EFFECT_TARGET) g_params_cal_dirty = true;
+  applyParamEffect(desc, idx);
+  printParamAck("# Param set: ", desc, idx,
+                desc.effect == PARAM_EFFECT_TARGET ? " (autosaves)" : " (send PARAM COMMIT to store)");
 }
 
-static bool setAutoTargets(float hfeGoalC, float hxLimitC, float hxApproachC, float hysteresisC) {
-  if (!isfinite(hfeGoalC) || !isfinite(hxLimitC) ||
-      !isfinite(hxApproachC) || !isfinite(hysteresisC) ||
-      hxApproachC < 0.0f || hysteresisC < 0.0f) {
-    return false;
-  }
+constexpr uint8_t CMD_LINE_MAX = 64;  // longest command line, excluding the terminator
 
-  g_hfe_goal_c = hfeGoalC;
-  g_hx_limit_c = hxLimitC;
-  g_hx_approach_c = hxApproachC;
-  g_ln_auto_hysteresis_c = hysteresisC;
-  refreshAutoStatusAfterTargetChange();
-  return true;
-}
+// Upper-case copy of the command being handled; views into it line up with
+// views into the command text at the same offsets.
+static char g_cmd_upper[CMD_LINE_MAX];
 
-static void handleCommand(const String& s) {
-  String cmd = s; cmd.trim();
-  if (!cmd.length()) return;
+static void handleCommand(const CmdText& s) {
+  CmdText cmd = s; cmd.trim();
+  if (!cmd.length() || cmd.length() > sizeof(g_cmd_upper)) return;
 
-  String upper = cmd; upper.toUpperCase();
+  for (size_t i = 0; i < cmd.length(); ++i) g_cmd_upper[i] = static_cast<char>(toupper(cmd[i]));
+  const CmdText upper(g_cmd_upper, cmd.length());
   if (upper == "ESTOP RESET" || upper == "EMERGENCY STOP RESET" || upper == "SAFETY RESET") {
     resetEmergencyStopIfSafe();
   }
-  else if (upper == "VALVE OPEN")       { g_mode = FORCE_OPEN;  applyValve(OPEN);   }
-  else if (upper == "VALVE CLOSE") { g_mode = FORCE_CLOSE; applyValve(CLOSED); }
-  else if (upper == "VALVE AUTO")  {
-    if (g_mode != AUTO) {
-      g_auto_close_latched = false;
+  else if (upper == "SAFETY") {
+    emitSafetyLawsFrame(millis());
+  }
+  else if (upper.startsWith("SAFETY ")) {
+    handleSafetyCommand(cmd, upper);
+  }
+  else if (upper == "PARAM" || upper.startsWith("PARAM ")) {
+    handleParamCommand(cmd, upper);
+  }
+  else if (upper == "CAPTURE" || upper.startsWith("CAPTURE ")) {
+    handleCaptureCommand(cmd, upper);
+  }
+  else if (upper == "VALVE OPEN") {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { g_mode = FORCE_OPEN;  applyValveMode(); }
+    if (g_safety_actions & SAFETY_ACTION_VALVE_CLOSE) {
+      Serial.println(F("# Valve held closed by safety law"));
     }
-    g_mode = AUTO;
-    if (g_auto_status_sampled) {
-      runAutoValveControl();
+  }
+  else if (upper == "VALVE CLOSE") {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { g_mode = FORCE_CLOSE; applyValve(CLOSED); }
+  }
+  else if (upper == "VALVE AUTO")  {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+      if (g_mode != AUTO) {
+        g_auto_close_latched = false;
+      }
+      g_mode = AUTO;
+      applyValveMode();
     }
   }
   else if (upper.startsWith("AUTO TARGETS")) {
@@ -905,13 +3247,13 @@ static void handleCommand(const String& s) {
     }
 
     Serial.print(F("# Auto targets set: HFE goal "));
-    Serial.print(g_hfe_goal_c, 2);
+    Serial.print(g_params.hfeGoalC, 2);
     Serial.print(F(" C, HX limit "));
-    Serial.print(g_hx_limit_c, 2);
+    Serial.print(g_params.hxLimitC, 2);
     Serial.print(F(" C, HX approach "));
-    Serial.print(g_hx_approach_c, 2);
+    Serial.print(g_params.hxApproachC, 2);
     Serial.print(F(" C, hysteresis "));
-    Serial.print(g_ln_auto_hysteresis_c, 2);
+    Serial.print(g_params.lnAutoHysteresisC, 2);
     Serial.println(F(" C"));
   }
   else if (upper.startsWith("SETPOINT")) {
@@ -921,10 +3263,9 @@ static void handleCommand(const String& s) {
       return;
     }
 
-    g_hfe_goal_c = nextGoal;
-    refreshAutoStatusAfterTargetChange();
+    setControlTarget(&g_params.hfeGoalC, nextGoal);
     Serial.print(F("# HFE goal set to "));
-    Serial.print(g_hfe_goal_c, 2);
+    Serial.print(g_params.hfeGoalC, 2);
     Serial.println(F(" C"));
   }
   else if (upper.startsWith("HFE GOAL")) {
@@ -934,10 +3275,9 @@ static void handleCommand(const String& s) {
       return;
     }
 
-    g_hfe_goal_c = nextGoal;
-    refreshAutoStatusAfterTargetChange();
+    setControlTarget(&g_params.hfeGoalC, nextGoal);
     Serial.print(F("# HFE goal set to "));
-    Serial.print(g_hfe_goal_c, 2);
+    Serial.print(g_params.hfeGoalC, 2);
     Serial.println(F(" C"));
   }
   else if (upper.startsWith("HX APPROACH")) {
@@ -947,10 +3287,9 @@ static void handleCommand(const String& s) {
       return;
     }
 
-    g_hx_approach_c = nextApproach;
-    refreshAutoStatusAfterTargetChange();
+    setControlTarget(&g_params.hxApproachC, nextApproach);
     Serial.print(F("# HX approach set to "));
-    Serial.print(g_hx_approach_c, 2);
+    Serial.print(g_params.hxApproachC, 2);
     Serial.println(F(" C"));
   }
   else if (upper.startsWith("HX LIMIT")) {
@@ -960,10 +3299,9 @@ static void handleCommand(const String& s) {
       return;
     }
 
-    g_hx_limit_c = nextHxLimit;
-    refreshAutoStatusAfterTargetChange();
+    setControlTarget(&g_params.hxLimitC, nextHxLimit);
     Serial.print(F("# HX limit set to "));
-    Serial.print(g_hx_limit_c, 2);
+    Serial.print(g_params.hxLimitC, 2);
     Serial.println(F(" C"));
   }
   else if (upper.startsWith("THI LIMIT")) {
@@ -973,10 +3311,9 @@ static void handleCommand(const String& s) {
       return;
     }
 
-    g_hx_limit_c = nextHxLimit;
-    refreshAutoStatusAfterTargetChange();
+    setControlTarget(&g_params.hxLimitC, nextHxLimit);
     Serial.print(F("# HX limit set to "));
-    Serial.print(g_hx_limit_c, 2);
+    Serial.print(g_params.hxLimitC, 2);
     Serial.println(F(" C"));
   }
   else if (upper.startsWith("HYSTERESIS")) {
@@ -986,20 +3323,42 @@ static void handleCommand(const String& s) {
       return;
     }
 
-    g_ln_auto_hysteresis_c = nextHysteresis;
-    refreshAutoStatusAfterTargetChange();
+    setControlTarget(&g_params.lnAutoHysteresisC, nextHysteresis);
     Serial.print(F("# Hysteresis set to "));
-    Serial.print(g_ln_auto_hysteresis_c, 2);
+    Serial.print(g_params.lnAutoHysteresisC, 2);
     Serial.println(F(" C"));
   }
-  else if (upper == "HEATER BOTTOM ON")    { applyHeaterBottom(true); }
-  else if (upper == "HEATER BOTTOM OFF")   { applyHeaterBottom(false); }
-  else if (upper == "HEATER EXHAUST ON")   { applyHeaterExhaust(true); }
-  else if (upper == "HEATER EXHAUST OFF")  { applyHeaterExhaust(false); }
+  else if (upper.startsWith("ADC OVERSAMPLE")) {
+    float bits = NAN;
+    if (!parseFloatSuffix(cmd, 14, &bits) || bits < 0.0f || bits != floorf(bits) ||
+        !setPressureOversampleBits(static_cast<uint8_t>(bits))) {
+      Serial.println(F("# Invalid ADC OVERSAMPLE command (extra bits 0-4)"));
+      return;
+    }
+    Serial.print(F("# Pressure ADC: "));
+    Serial.print(10 + static_cast<int>(bits));
+    Serial.print(F("-bit, "));
+    Serial.print(1UL << (2 * static_cast<int>(bits)));
+    Serial.print(F(" samples/output, "));
+    Serial.print(pressureOutputHz(static_cast<uint8_t>(bits)), 1);
+    Serial.println(F(" Hz per channel"));
+  }
+  else if (upper == "RSV RATE RESET") {
+    resetRsvScaleFilter(millis());
+    Serial.println(F("# RSV scale filter and mass-rate window reset"));
+  }
+  else if (upper == "PERF")       { emitPerfFrame(millis(), true); }
+  else if (upper == "TC DIAG")    { emitTcDiagFrame(millis()); }
+  else if (upper == "MEM")        { emitMemFrame(millis()); }
+  else if (upper == "SCHED")      { emitSchedFrame(millis()); }
+  else if (upper == "PERF RESET") { resetPerfStats(); Serial.println(F("# Perf counters reset")); }
+  else if (upper.startsWith("HEATER BOTTOM"))  { handleHeaterCommand(HEATER_BOTTOM, cmd, upper, 13); }
+  else if (upper.startsWith("HEATER EXHAUST")) { handleHeaterCommand(HEATER_EXHAUST, cmd, upper, 14); }
   else if (upper.startsWith("PUMP")) {
-    String rest = cmd.substring(4);
+    CmdText rest = cmd.substring(4);
     rest.trim();
-    String restUpper = rest; restUpper.toUpperCase();
+    CmdText restUpper = upper.substring(4);
+    restUpper.trim();
 
     float pct = NAN;
     if (restUpper.startsWith("HZ")) {
@@ -1014,11 +3373,21 @@ static void handleCommand(const String& s) {
     }
 
     if (isfinite(pct)) {
-      if (g_emergency_stop_latched && pct > 0.0f) {
-        Serial.println(F("# Pump command blocked by emergency stop; send ESTOP RESET once safe"));
+      bool blocked = false;
+      float applied = NAN;
+      // Atomic with the E-stop latch so a trip in the control tick cannot be overridden.
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        blocked = ((g_safety_actions & SAFETY_ACTION_PUMP_STOP) || g_padc.fastTripPending) && pct > 0.0f;
+        if (!blocked) applied = setPumpCommandPct(pct);
+      }
+      if (blocked) {
+        if (g_emergency_stop_latched) {
+          Serial.println(F("# Pump command blocked by emergency stop; send ESTOP RESET once safe"));
+        } else {
+          Serial.println(F("# Pump command blocked by active safety law"));
+        }
         return;
       }
-      float applied = setPumpCommandPct(pct);
       Serial.print(F("# Pump cmd set to "));
       Serial.print(applied, 3);
       Serial.println(F(" % of full-scale (analog)"));
@@ -1026,35 +3395,50 @@ static void handleCommand(const String& s) {
   }
 }
 
-// Returns NAN if faulted/missing; otherwise °C
-static float safeReadCelsius(Adafruit_MAX31856* dev) {
-  if (!dev) return NAN;
-  float t = dev->readThermocoupleTemperature();
-  uint8_t f = dev->readFault();
-  if (f) return NAN; // OPEN/other faults
-  if (!isfinite(t) || t < -200.0f || t > 1370.0f) return NAN; // sanity
-  return t;
-}
-
-static void emitTelemetry(const float temps[], size_t count, unsigned long nowMs,
+static void emitTelemetry(const float temps[], const float tempsRaw[], size_t count, unsigned long nowMs,
                           float pressureBeforeBar, float pressureAfterBar, float pressureTankBar,
                           float pressureAfterVolts) {
   const float t_s = nowMs / 1000.0f;
   const char modeChar = (g_mode == AUTO) ? 'A' : (g_mode == FORCE_OPEN ? 'O' : 'C');
-  const int trippedLawIdx = firstSafetyLawIndexByState(false);
+
+  // Snapshot state owned by the control tick so a line never mixes two ticks.
+  AutoValveStatus autoStatus;
+  bool emergencyStopLatched, autoCloseLatched;
+  uint8_t safetyActions;
+  uint32_t safetyEvalUs, safetyEvalPeakUs;
+  unsigned long emergencyStopMs;
+  uint32_t controlTicks;
+  uint16_t controlOverruns;
+  uint32_t adcSamples;
+  uint16_t fastDeltaPTrips;
+  uint8_t  adcOversampleBits;
+  int trippedLawIdx;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    autoStatus = g_auto_status;
+    emergencyStopLatched = g_emergency_stop_latched;
+    safetyActions = g_safety_actions;
+    safetyEvalUs = g_perf[PERF_SAFETY_LAWS].lastUs;
+    safetyEvalPeakUs = g_perf[PERF_SAFETY_LAWS].peakUs;
+    emergencyStopMs = g_emergency_stop_ms;
+    autoCloseLatched = g_auto_close_latched;
+    controlTicks = g_ctl.ticks;
+    controlOverruns = g_ctl.overruns;
+    adcSamples = g_padc.samples;
+    fastDeltaPTrips = g_padc.fastTrips;
+    adcOversampleBits = g_padc.oversampleBits;
+    trippedLawIdx = firstSafetyLawIndexByState(false);
+  }
 
   Serial.print(F("{\"type\":\"telemetry\""));
   Serial.print(F(",\"t\":"));
   Serial.print(t_s, 3);
 
-  Serial.print(F(",\"temps\":["));
-  for (size_t i = 0; i < count; ++i) {
-    const float v = (temps && isfinite(temps[i])) ? temps[i] : NAN;
-    if (isfinite(v)) Serial.print(v, 2);
-    else             Serial.print(F("null"));
-    if (i + 1 < count) Serial.print(',');
-  }
-  Serial.print(']');
+  hal::SerialPort &out = hal::port(hal::PORT_CONSOLE);
+  Serial.print(F(",\"temps\":"));
+  printJsonFloatArray(out, temps, count, 2);
+  Serial.print(F(",\"temps_raw\":"));
+  printJsonFloatArray(out, tempsRaw, count, 2);
+  Serial.print(F(",\"tc_calibrated\":true"));
 
   Serial.print(F(",\"valve\":"));
   Serial.print((int)g_valve);
@@ -1064,7 +3448,8 @@ static void emitTelemetry(const float temps[], size_t count, unsigned long nowMs
   Serial.print('"');
 
   Serial.print(F(",\"pump\":{"));
-  const float cmdPct  = g_pump_cmd_pct;
+  float cmdPct = 0.0f;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { cmdPct = g_pump_cmd_pct; }
   const float cmdFrac = cmdPct / 100.0f;
   const float tgtHz   = PUMP_MAX_FREQ_HZ * cmdFrac;
 
@@ -1142,11 +3527,11 @@ static void emitTelemetry(const float temps[], size_t count, unsigned long nowMs
   Serial.print('}');
   Serial.print(F(",\"safety\":{"));
   Serial.print(F("\"emergency_stop\":"));
-  Serial.print(g_emergency_stop_latched ? F("true") : F("false"));
+  Serial.print(emergencyStopLatched ? F("true") : F("false"));
   Serial.print(F(",\"reset_required\":"));
-  Serial.print(g_emergency_stop_latched ? F("true") : F("false"));
+  Serial.print(emergencyStopLatched ? F("true") : F("false"));
   Serial.print(F(",\"tripped_ms\":"));
-  if (g_emergency_stop_latched) Serial.print(g_emergency_stop_ms);
+  if (emergencyStopLatched) Serial.print(emergencyStopMs);
   else                          Serial.print(F("null"));
   Serial.print(F(",\"active_reason\":"));
   if (trippedLawIdx >= 0) {
@@ -1164,26 +3549,40 @@ static void emitTelemetry(const float temps[], size_t count, unsigned long nowMs
   } else {
     Serial.print(F("null"));
   }
+  Serial.print(F(",\"actions\":["));
+  bool firstAction = true;
+  if (safetyActions & SAFETY_ACTION_PUMP_STOP)   { Serial.print(F("\"pump_stop\"")); firstAction = false; }
+  if (safetyActions & SAFETY_ACTION_VALVE_CLOSE) { if (!firstAction) Serial.print(','); Serial.print(F("\"valve_close\"")); firstAction = false; }
+  if (safetyActions & SAFETY_ACTION_HEATERS_OFF) { if (!firstAction) Serial.print(','); Serial.print(F("\"heaters_off\"")); }
+  Serial.print(F("],\"eval_us\":"));
+  Serial.print(safetyEvalUs);
+  Serial.print(F(",\"eval_peak_us\":"));
+  Serial.print(safetyEvalPeakUs);
+  // Per-law state; signal, compare, actions, latch and timing are in the
+  // {"type":"safety_laws"} frame (boot and SAFETY).
   Serial.print(F(",\"laws\":{"));
   for (size_t i = 0; i < safetyLawCount(); ++i) {
-    const SafetyLawState &law = g_safety_laws[i];
+    SafetyLawState law;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { law = g_safety_laws[i]; }
     Serial.print('"');
     Serial.print(law.key);
-    Serial.print(F("\":{"));
-    Serial.print(F("\"label\":\""));
-    Serial.print(law.label);
-    Serial.print(F("\",\"enabled\":"));
+    Serial.print(F("\":{\"enabled\":"));
     Serial.print(law.enabled ? F("true") : F("false"));
     Serial.print(F(",\"active\":"));
     Serial.print(law.active ? F("true") : F("false"));
     Serial.print(F(",\"tripped\":"));
     Serial.print(law.tripped ? F("true") : F("false"));
-    Serial.print(F(",\"limit_bar\":"));
-    Serial.print(law.limitBar, 3);
-    Serial.print(F(",\"value_bar\":"));
-    if (isfinite(law.valueBar)) Serial.print(law.valueBar, 3);
-    else                        Serial.print(F("null"));
-    Serial.print(F(",\"units\":\"bar\"}"));
+    Serial.print(F(",\"limit\":"));
+    Serial.print(law.limit, 3);
+    Serial.print(F(",\"value\":"));
+    if (isfinite(law.value)) Serial.print(law.value, 3);
+    else                     Serial.print(F("null"));
+    if (isfinite(law.rateLimitPerS)) {
+      Serial.print(F(",\"rate_per_s\":"));
+      if (isfinite(law.ratePerS)) Serial.print(law.ratePerS, 3);
+      else                        Serial.print(F("null"));
+    }
+    Serial.print('}');
     if (i + 1 < safetyLawCount()) Serial.print(',');
   }
   Serial.print(F("}"));
@@ -1212,7 +3611,7 @@ static void emitTelemetry(const float temps[], size_t count, unsigned long nowMs
   }
   Serial.print('}');
   Serial.print(F(",\"rsv_scale\":{"));
-  const bool rsvScaleCalibrated = fabs(RSV_SCALE_COUNTS_PER_KG) > 1.0e-9f;
+  const bool rsvScaleCalibrated = fabs(g_params.rsvScaleCountsPerKg) > 1.0e-9f;
   Serial.print(F("\"valid\":"));
   Serial.print(g_rsv_scale.valid ? F("true") : F("false"));
   Serial.print(F(",\"raw_counts\":"));
@@ -1226,172 +3625,414 @@ static void emitTelemetry(const float temps[], size_t count, unsigned long nowMs
   Serial.print(digitalRead(RSV_SCALE_DATA_PIN));
   Serial.print(F(",\"mass_kg\":"));
   if (g_rsv_scale.valid && isfinite(g_rsv_scale.massKg)) Serial.print(g_rsv_scale.massKg, 3); else Serial.print(F("null"));
+  Serial.print(F(",\"mass_filtered_kg\":"));
+  if (g_rsv_scale.valid && isfinite(g_rsv_filter.filteredKg)) Serial.print(g_rsv_filter.filteredKg, 4); else Serial.print(F("null"));
+  Serial.print(F(",\"spikes\":"));
+  Serial.print(g_rsv_filter.spikes);
+  Serial.print(F(",\"rate_kg_h\":"));
+  if (isfinite(g_rsv_filter.rateKgH)) Serial.print(g_rsv_filter.rateKgH, 5); else Serial.print(F("null"));
+  Serial.print(F(",\"rate_sigma_kg_h\":"));
+  if (isfinite(g_rsv_filter.rateSigmaKgH)) Serial.print(g_rsv_filter.rateSigmaKgH, 5); else Serial.print(F("null"));
+  Serial.print(F(",\"rate_window_s\":"));
+  Serial.print(g_rsv_filter.binFilled * (RSV_SCALE_RATE_BIN_MS / 1000UL));
+  Serial.print(F(",\"rate_points\":"));
+  Serial.print(g_rsv_filter.ratePoints);
   Serial.print(F(",\"calibrated\":"));
   Serial.print(rsvScaleCalibrated ? F("true") : F("false"));
   Serial.print(F(",\"tare_counts\":"));
-  Serial.print(RSV_SCALE_TARE_COUNTS);
+  Serial.print(g_params.rsvScaleTareCounts);
   Serial.print(F(",\"counts_per_kg\":"));
-  if (rsvScaleCalibrated) Serial.print(RSV_SCALE_COUNTS_PER_KG, 3); else Serial.print(F("null"));
+  if (rsvScaleCalibrated) Serial.print(g_params.rsvScaleCountsPerKg, 3); else Serial.print(F("null"));
   Serial.print(F(",\"last_read_ms\":"));
   Serial.print(g_rsv_scale.lastReadMs);
-  Serial.print('}');
+  Serial.print(F(",\"last_sample_ms\":"));
+  Serial.print(g_rsv_scale.lastSampleMs);
+  Serial.print(F(",\"samples\":"));
+  Serial.print(g_rsv_scale.samples);
+  Serial.print(F(",\"rate_hz\":"));
+  if (isfinite(g_rsv_scale.rateHz)) Serial.print(g_rsv_scale.rateHz, 1); else Serial.print(F("null"));
+  Serial.print(F(",\"overruns\":"));
+  Serial.print(g_hx711.overruns);
+  Serial.print(F(",\"reader\":\""));
+  Serial.print(g_hx711.pcifrMask ? F("pcint") : F("loop_poll"));
+  Serial.print(F("\"}"));
   Serial.print(F(",\"control\":{"));
   Serial.print(F("\"hfe_goal_c\":"));
-  Serial.print(g_hfe_goal_c, 2);
+  Serial.print(g_params.hfeGoalC, 2);
   Serial.print(F(",\"setpoint_c\":"));
-  Serial.print(g_hfe_goal_c, 2);
+  Serial.print(g_params.hfeGoalC, 2);
   Serial.print(F(",\"hx_limit_c\":"));
-  Serial.print(g_hx_limit_c, 2);
+  Serial.print(g_params.hxLimitC, 2);
   Serial.print(F(",\"thi_limit_c\":"));
-  Serial.print(g_hx_limit_c, 2);
+  Serial.print(g_params.hxLimitC, 2);
   Serial.print(F(",\"ln_hysteresis_c\":"));
-  Serial.print(g_ln_auto_hysteresis_c, 2);
+  Serial.print(g_params.lnAutoHysteresisC, 2);
   Serial.print(F(",\"hx_approach_c\":"));
-  Serial.print(g_hx_approach_c, 2);
+  Serial.print(g_params.hxApproachC, 2);
   Serial.print(F(",\"thi_temp_c\":"));
-  if (g_auto_status.thiValid) Serial.print(g_auto_status.thiTempC, 2); else Serial.print(F("null"));
+  if (autoStatus.thiValid) Serial.print(autoStatus.thiTempC, 2); else Serial.print(F("null"));
   Serial.print(F(",\"hfe_temp_c\":"));
-  if (g_auto_status.hfeValid) Serial.print(g_auto_status.hfeTempC, 2); else Serial.print(F("null"));
+  if (autoStatus.hfeValid) Serial.print(autoStatus.hfeTempC, 2); else Serial.print(F("null"));
   Serial.print(F(",\"tmi_temp_c\":"));
-  if (g_auto_status.hfeValid) Serial.print(g_auto_status.hfeTempC, 2); else Serial.print(F("null"));
+  if (autoStatus.hfeValid) Serial.print(autoStatus.hfeTempC, 2); else Serial.print(F("null"));
   Serial.print(F(",\"flow_temp_c\":"));
-  if (g_auto_status.hfeValid) Serial.print(g_auto_status.hfeTempC, 2); else Serial.print(F("null"));
+  if (autoStatus.hfeValid) Serial.print(autoStatus.hfeTempC, 2); else Serial.print(F("null"));
   Serial.print(F(",\"thi_valid\":"));
-  Serial.print(g_auto_status.thiValid ? F("true") : F("false"));
+  Serial.print(autoStatus.thiValid ? F("true") : F("false"));
   Serial.print(F(",\"hfe_valid\":"));
-  Serial.print(g_auto_status.hfeValid ? F("true") : F("false"));
+  Serial.print(autoStatus.hfeValid ? F("true") : F("false"));
   Serial.print(F(",\"tmi_valid\":"));
-  Serial.print(g_auto_status.hfeValid ? F("true") : F("false"));
+  Serial.print(autoStatus.hfeValid ? F("true") : F("false"));
   Serial.print(F(",\"flow_valid\":"));
-  Serial.print(g_auto_status.hfeValid ? F("true") : F("false"));
+  Serial.print(autoStatus.hfeValid ? F("true") : F("false"));
   Serial.print(F(",\"thi_reopen_c\":"));
-  if (isfinite(g_auto_status.thiReopenThresholdC)) Serial.print(g_auto_status.thiReopenThresholdC, 2);
+  if (isfinite(autoStatus.thiReopenThresholdC)) Serial.print(autoStatus.thiReopenThresholdC, 2);
   else Serial.print(F("null"));
   Serial.print(F(",\"hfe_reopen_c\":"));
-  Serial.print(g_auto_status.hfeReopenThresholdC, 2);
+  Serial.print(autoStatus.hfeReopenThresholdC, 2);
   Serial.print(F(",\"tmi_reopen_c\":"));
-  Serial.print(g_auto_status.hfeReopenThresholdC, 2);
+  Serial.print(autoStatus.hfeReopenThresholdC, 2);
   Serial.print(F(",\"flow_reopen_c\":"));
-  Serial.print(g_auto_status.hfeReopenThresholdC, 2);
+  Serial.print(autoStatus.hfeReopenThresholdC, 2);
   Serial.print(F(",\"close_requested\":"));
-  Serial.print(g_auto_status.closeRequested ? F("true") : F("false"));
+  Serial.print(autoStatus.closeRequested ? F("true") : F("false"));
   Serial.print(F(",\"ready_to_open\":"));
-  Serial.print(g_auto_status.readyToOpen ? F("true") : F("false"));
+  Serial.print(autoStatus.readyToOpen ? F("true") : F("false"));
   Serial.print(F(",\"auto_close_latched\":"));
-  Serial.print(g_auto_close_latched ? F("true") : F("false"));
+  Serial.print(autoCloseLatched ? F("true") : F("false"));
   Serial.print(F(",\"within_hysteresis_band\":"));
-  Serial.print((g_auto_close_latched && !g_auto_status.closeRequested && !g_auto_status.readyToOpen) ? F("true") : F("false"));
+  Serial.print((autoCloseLatched && !autoStatus.closeRequested && !autoStatus.readyToOpen) ? F("true") : F("false"));
   Serial.print(F(",\"auto_close_reason\":\""));
-  Serial.print(autoCloseReasonKey(g_auto_status.reason));
+  Serial.print(autoCloseReasonKey(autoStatus.reason));
   Serial.print('"');
   Serial.print(F(",\"telemetry_interval_ms\":"));
   Serial.print(SAMPLE_INTERVAL_MS);
+  Serial.print(F(",\"control_tick_hz\":"));
+  Serial.print(CONTROL_TICK_HZ);
+  Serial.print(F(",\"control_ticks\":"));
+  Serial.print(controlTicks);
+  Serial.print(F(",\"control_tick_overruns\":"));
+  Serial.print(controlOverruns);
+
+  // Measured per-channel pressure sample rate since the previous line.
+  static uint32_t s_lastAdcSamples = 0;
+  static unsigned long s_lastAdcMs = 0;
+  Serial.print(F(",\"pressure_adc_hz\":"));
+  if (s_lastAdcMs != 0 && nowMs != s_lastAdcMs) {
+    Serial.print((adcSamples - s_lastAdcSamples) * 1000.0f / PRESSURE_CH_COUNT / (nowMs - s_lastAdcMs), 1);
+  } else {
+    Serial.print(F("null"));
+  }
+  s_lastAdcSamples = adcSamples;
+  s_lastAdcMs = nowMs;
+  Serial.print(F(",\"pressure_adc_bits\":"));
+  Serial.print(10 + adcOversampleBits);
+  Serial.print(F(",\"pressure_oversample\":"));
+  Serial.print(1UL << (2 * adcOversampleBits));
+  Serial.print(F(",\"pressure_output_hz\":"));
+  Serial.print(pressureOutputHz(adcOversampleBits), 1);
+  Serial.print(F(",\"pressure_lsb_bar\":"));
+  Serial.print(ADC_VOLTS_PER_COUNT / (1U << adcOversampleBits) * (PRESSURE_FSO_BAR / g_params.pressureFsoV), 5);
+  Serial.print(F(",\"delta_p_fast_persist_ms\":"));
+  Serial.print(PUMP_DELTA_P_FAST_PERSIST_MS);
+  Serial.print(F(",\"delta_p_fast_trips\":"));
+  Serial.print(fastDeltaPTrips);
   Serial.print('}');
   Serial.print(F(",\"heaters\":{"));
-  Serial.print(F("\"bottom\":"));
-  Serial.print(g_heater_bottom_on ? 1 : 0);
-  Serial.print(F(",\"exhaust\":"));
-  Serial.print(g_heater_exhaust_on ? 1 : 0);
+  for (size_t i = 0; i < heaterCount(); ++i) {
+    const HeaterLoop &heater = g_heaters[i];
+    Serial.print('"');
+    Serial.print(heater.key);
+    Serial.print(F("\":"));
+    Serial.print(heater.on ? 1 : 0);
+    Serial.print(F(",\""));
+    Serial.print(heater.key);
+    Serial.print(F("_mode\":\""));
+    Serial.print(heaterModeKey(heater.mode));
+    Serial.print(F("\","));
+  }
+  Serial.print(F("\"loops\":{"));
+  for (size_t i = 0; i < heaterCount(); ++i) {
+    const HeaterLoop &heater = g_heaters[i];
+    Serial.print('"');
+    Serial.print(heater.key);
+    Serial.print(F("\":{\"mode\":\""));
+    Serial.print(heaterModeKey(heater.mode));
+    Serial.print(F("\",\"law\":\""));
+    Serial.print(heaterLawKey(heater.law));
+    Serial.print(F("\",\"sensor_index\":"));
+    Serial.print(heater.sensorIndex);
+    Serial.print(F(",\"temp_c\":"));
+    if (isfinite(heater.tempC)) Serial.print(heater.tempC, 2); else Serial.print(F("null"));
+    Serial.print(F(",\"setpoint_c\":"));
+    Serial.print(heater.setpointC, 2);
+    Serial.print(F(",\"band_c\":"));
+    Serial.print(heater.bandC, 2);
+    Serial.print(F(",\"kp\":"));
+    Serial.print(heater.kpPerC, 4);
+    Serial.print(F(",\"ki\":"));
+    Serial.print(heater.kiPerCS, 5);
+    Serial.print(F(",\"window_s\":"));
+    Serial.print(heater.windowMs / 1000.0f, 1);
+    Serial.print(F(",\"duty\":"));
+    Serial.print(heater.duty, 3);
+    Serial.print(F(",\"max_on_s\":"));
+    Serial.print(heater.maxOnMs / 1000UL);
+    Serial.print(F(",\"on_s\":"));
+    if (heater.on) Serial.print((nowMs - heater.onSinceMs) / 1000UL); else Serial.print(0);
+    Serial.print(F(",\"interlock\":\""));
+    Serial.print(heaterInterlockKey(heater.interlock));
+    Serial.print(F("\"}"));
+    if (i + 1 < heaterCount()) Serial.print(',');
+  }
+  Serial.print(F("}}"));
+  // Runtime counters only; periods, priorities and budgets are in the
+  // {"type":"sched"} frame (boot and SCHED).
+  Serial.print(F(",\"sched\":{"));
+  for (size_t i = 0; i < sizeof(g_sched_tasks) / sizeof(g_sched_tasks[0]); ++i) {
+    const SchedTask &task = g_sched_tasks[i];
+    if (i) Serial.print(',');
+    Serial.print('"');
+    Serial.print(task.key);
+    Serial.print(F("\":["));
+    Serial.print(task.maxUs);
+    Serial.print(',');
+    Serial.print(task.maxLateMs);
+    Serial.print(',');
+    Serial.print(task.missed);
+    Serial.print(',');
+    Serial.print(task.overruns);
+    Serial.print(']');
+  }
   Serial.print('}');
+  if (!g_reset_reported) {
+    Serial.print(F(",\"channel_map\":\"" TC_CHANNEL_MAP_ID "\""));
+    Serial.print(F(",\"reset\":{\"cause\":\""));
+    Serial.print(resetCauseKey(g_reset_record.mcusr));
+    Serial.print(F("\",\"mcusr\":"));
+    Serial.print(g_reset_record.mcusr);
+    Serial.print(F(",\"stage\":\""));
+    Serial.print(WDT_STAGE_KEYS[g_reset_record.stage]);
+    Serial.print(F("\",\"boot_count\":"));
+    Serial.print(g_reset_record.bootCount);
+    Serial.print(F(",\"watchdog_resets\":"));
+    Serial.print(g_reset_record.watchdogResets);
+    Serial.print('}');
+    g_reset_reported = true;
+  }
   Serial.println('}');
 }
 
-void setup() {
-  Serial.begin(115200);
-  VFD.begin(VFD_BAUD, SERIAL_8E1);
-  FLOW.begin(FLOW_BAUD, SERIAL_8E1);
-  analogReference(DEFAULT);
-
-  setupPwm2kHz();
-  setPumpCommandPct(0.0f);  // start at 0% analog
+static size_t schedTaskCount() {
+  return sizeof(g_sched_tasks) / sizeof(g_sched_tasks[0]);
+}
 
-  g_mode = DEFAULT_VALVE_MODE;
-  digitalWrite(VALVE_PIN, LOW);
-  pinMode(VALVE_PIN, OUTPUT);
-  applyValve(CLOSED);
-  pinMode(HEATER_BOTTOM_PIN, OUTPUT);
-  pinMode(HEATER_EXHAUST_PIN, OUTPUT);
-  applyHeaterBottom(false);
-  applyHeaterExhaust(false);
+// Dispatch order by descending priority; filled once in schedInit().
+static uint8_t g_sched_order[sizeof(g_sched_tasks) / sizeof(g_sched_tasks[0])];
 
-  pinMode(PRESSURE_PIN_BEFORE, INPUT);
-  pinMode(PRESSURE_PIN_AFTER, INPUT);
-  pinMode(PRESSURE_PIN_TANK, INPUT);
+static void schedInit(unsigned long nowMs) {
+  for (size_t i = 0; i < schedTaskCount(); ++i) {
+    g_sched_order[i] = static_cast<uint8_t>(i);
+    g_sched_tasks[i].releaseMs = nowMs + g_sched_tasks[i].phaseMs;
+  }
+  // Insertion sort: the table is a handful of entries.
+  for (size_t i = 1; i < schedTaskCount(); ++i) {
+    const uint8_t idx = g_sched_order[i];
+    size_t j = i;
+    while (j > 0 && g_sched_tasks[g_sched_order[j - 1]].priority < g_sched_tasks[idx].priority) {
+      g_sched_order[j] = g_sched_order[j - 1];
+      --j;
+    }
+    g_sched_order[j] = idx;
+  }
+}
 
-  pinMode(RSV_SCALE_DATA_PIN, INPUT_PULLUP);
-  digitalWrite(RSV_SCALE_CLOCK_PIN, LOW);
-  pinMode(RSV_SCALE_CLOCK_PIN, OUTPUT);
+// Returns false when the task was not due.
+static bool schedRunTask(SchedTask &task) {
+  const unsigned long nowMs = millis();
+  if (task.periodMs > 0) {
+    if ((long)(nowMs - task.releaseMs) < 0) return false;
 
-  pinMode(SCK_PIN,  OUTPUT);
-  pinMode(MOSI_PIN, OUTPUT);
-  pinMode(MISO_PIN, INPUT);
+    task.lastLateMs = nowMs - task.releaseMs;
+    if (task.lastLateMs > task.maxLateMs) task.maxLateMs = task.lastLateMs;
 
-  for (size_t i = 0; i < NUM_TCS; ++i) {
-    pinMode(CS_PINS[i], OUTPUT);
-    digitalWrite(CS_PINS[i], HIGH); // deselect
-    tc[i] = new Adafruit_MAX31856(CS_PINS[i], MOSI_PIN, MISO_PIN, SCK_PIN);
-    tc[i]->begin();
-    tc[i]->setThermocoupleType(TC_TYPES[i]);
-    tc[i]->setNoiseFilter(MAX31856_NOISE_FILTER_60HZ); // correct enum
+    // Fixed-rate releases; whole periods that slipped by are counted as missed deadlines.
+    task.releaseMs += task.periodMs;
+    while ((long)(nowMs - task.releaseMs) >= 0) {
+      task.releaseMs += task.periodMs;
+      ++task.missed;
+    }
   }
 
-  // JSON line telemetry: temps[0..9] (°C), valve (0/1), mode (A/O/C), pump{}, safety{}, fluid{}, rsv_scale{}, control{}, heaters{}
-  Serial.println(F("# Telemetry keys: temps[0..9] (°C), valve (0/1), mode (A/O/C), pump{} (VFD + pressures), safety{} (latched interlocks), fluid{} (MFC400), rsv_scale{} (reservoir scale), control{} (HFE goal + HX limit + hysteresis + HX approach + LN auto status), heaters{bottom,exhaust}"));
+  const unsigned long startUs = micros();
+  task.run(nowMs);
+  const unsigned long elapsedUs = micros() - startUs;
+
+  task.lastUs = elapsedUs;
+  if (elapsedUs > task.maxUs) task.maxUs = elapsedUs;
+  task.avgUs = task.runs ? (task.avgUs - (task.avgUs >> 3) + (elapsedUs >> 3)) : elapsedUs;
+  if (task.budgetUs > 0 && elapsedUs > task.budgetUs) ++task.overruns;
+  ++task.runs;
+  return true;
+}
+
+// The watchdog is supervised and the HX711 serviced after every task, not once
+// per pass: with the VFD and flow meter offline, telemetry and both Modbus
+// timeouts add up to ~1.4 s, past WDT_TIMEOUT_MS, while the longest single
+// task stays under it.
+static void schedRunPass() {
+  for (size_t i = 0; i < schedTaskCount(); ++i) {
+    if (!schedRunTask(g_sched_tasks[g_sched_order[i]])) continue;
+    serviceRsvScaleReader();
+    superviseWatchdog();
+  }
 }
 
-void loop() {
-  // ── Serial command parser (non-blocking) ───────────────────────────────
-  static String line;
+// ── Scheduler tasks ──────────────────────────────────────────────────────
+static void taskSerialCommands(unsigned long nowMs) {
+  persistParamsIfDue(nowMs);
+  if (!Serial.available()) return;
+  PerfScope perf(PERF_COMMANDS);
+  // A line longer than the buffer is dropped whole, up to its terminator.
+  static char line[CMD_LINE_MAX];
+  static uint8_t len = 0;
+  static bool overflow = false;
   while (Serial.available()) {
     char c = (char)Serial.read();
-    if (c == '\n' || c == '\r') { if (line.length()) handleCommand(line); line = ""; }
-    else { line += c; if (line.length() > 64) line = ""; }
+    if (c == '\n' || c == '\r') {
+      if (len && !overflow) handleCommand(CmdText(line, len));
+      len = 0;
+      overflow = false;
+    }
+    else if (len < sizeof(line)) { line[len++] = c; }
+    else { overflow = true; }
   }
+}
+
+// ── Poll VFD (non-blocking 200 ms timeout inside) ──────────────────────
+static void taskPollVfd(unsigned long nowMs) {
+  (void)nowMs;
+  WdtStageScope wdt(WDT_STAGE_VFD);
+  pollVfd();
+  publishSafetySignal(SAFETY_SIGNAL_VFD_CURRENT_A, g_vfd.outputCurrentA, g_vfd.lastPollMs);
+  publishSafetySignal(SAFETY_SIGNAL_VFD_POWER_W, g_vfd.inputPowerW, g_vfd.lastPollMs);
+}
 
-  unsigned long now = millis();
+static void taskPollFlow(unsigned long nowMs) {
+  (void)nowMs;
+  WdtStageScope wdt(WDT_STAGE_FLOW);
+  pollFlowMeter();
+  publishSafetySignal(SAFETY_SIGNAL_FLOW_MASS_KGS, g_flow.massFlowKgS, g_flow.lastPollMs);
+}
 
-  // ── Poll VFD (non-blocking 200 ms timeout inside) ──────────────────────
-  if (now - lastVfdPoll >= VFD_POLL_MS) {
-    lastVfdPoll = now;
-    pollVfd();
+// ── 1 Hz sampling ──────────────────────────────────────────────────────
+// Reads the most overdue enabled channels; each reading goes straight to the
+// control tick, so control channels are not held to the 1 Hz telemetry rate.
+static void taskTcAcquire(unsigned long nowMs) {
+  PerfScope perf(PERF_TC_SWEEP);
+  WdtStageScope wdt(WDT_STAGE_TC_SWEEP);
+  for (uint8_t n = 0; n < TC_READS_PER_PASS; ++n) {
+    const int pick = g_tc.nextDue(nowMs);
+    if (pick < 0) return;
+    const float rawC = g_tc.read(pick, nowMs);
+    publishControlTemp(pick, calibrateTemp(pick, rawC), nowMs);
   }
+}
 
-  if (now - lastFlowPoll >= FLOW_POLL_MS) {
-    lastFlowPoll = now;
-    pollFlowMeter();
+static void taskSample(unsigned long now) {
+  g_tc.readNextColdJunction(now);
+  float temps_raw[NUM_TCS];
+  latestTcTemps(temps_raw, now);
+  float temps_out[NUM_TCS];
+  calibrateTemps(temps_raw, temps_out, NUM_TCS);
+
+  float pressureBeforeBar, pressureAfterBar, pressureTankBar, pressureAfterVolts;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    pressureBeforeBar  = g_ctl.pressureBeforeBar;
+    pressureAfterBar   = g_ctl.pressureAfterBar;
+    pressureTankBar    = g_ctl.pressureTankBar;
+    pressureAfterVolts = g_ctl.pressureAfterVolts;
   }
 
-  // ── 1 Hz sampling ──────────────────────────────────────────────────────
-  if (now - lastSample >= SAMPLE_INTERVAL_MS) {
-    lastSample = now;
+  updateHeaterControl(temps_out, NUM_TCS, now);
 
-    // Read sensors into a fixed-size array
-    float temps_out[MAX_TCS_OUT];
-    for (size_t i = 0; i < MAX_TCS_OUT; ++i) {
-      temps_out[i] = (i < NUM_TCS) ? safeReadCelsius(tc[i]) : NAN;
-    }
+  PerfScope perf(PERF_TELEMETRY);
+  WdtStageScope wdt(WDT_STAGE_TELEMETRY);
+  emitTelemetry(temps_out, temps_raw, NUM_TCS, now,
+                pressureBeforeBar, pressureAfterBar, pressureTankBar,
+                pressureAfterVolts);
+}
 
-    updateAutoValveStatus(temps_out, MAX_TCS_OUT);
+static void taskRsvScale(unsigned long nowMs) {
+  pollRsvScale(nowMs);
+  publishSafetySignal(SAFETY_SIGNAL_RSV_MASS_KG,
+                      g_rsv_scale.valid ? g_rsv_filter.filteredKg : NAN, nowMs);
+}
+
+static void taskTcDiagReport(unsigned long nowMs) {
+  emitTcDiagFrame(nowMs);
+}
+
+static void taskPerfReport(unsigned long nowMs) {
+  emitPerfFrame(nowMs, false);
+}
+
+static void taskMemReport(unsigned long nowMs) {
+  emitMemFrame(nowMs);
+}
 
-    // Control: LN auto closes on THI/TMI cold limits and reopens once both recover by hysteresis.
-    if (g_mode == AUTO) {
-      runAutoValveControl();
-    } else if (g_mode == FORCE_OPEN)  applyValve(OPEN);
-    else if (g_mode == FORCE_CLOSE)   applyValve(CLOSED);
+void setup() {
+  // Outputs first: after any reset (including the watchdog) the pump is at 0 %,
+  // the LN valve is closed and heaters are off before anything else runs.
+  setupPwm2kHz();
+  digitalWrite(VALVE_PIN, LOW);
+  pinMode(VALVE_PIN, OUTPUT);
+  for (size_t i = 0; i < heaterCount(); ++i) {
+    digitalWrite(g_heaters[i].pin, LOW);
+    pinMode(g_heaters[i].pin, OUTPUT);
+  }
+  applySafeOutputs();
+  g_mode = DEFAULT_VALVE_MODE;
 
-    float pressureBeforeVolts = readPressureVolts(PRESSURE_PIN_BEFORE);
-    float pressureAfterVolts  = readPressureVolts(PRESSURE_PIN_AFTER);
-    float pressureTankVolts   = readPressureVolts(PRESSURE_PIN_TANK);
+  Serial.begin(115200);
+  VFD.begin(VFD_BAUD, SERIAL_8E1);
+  FLOW.begin(FLOW_BAUD, SERIAL_8E1);
+  analogReference(DEFAULT);
+  recordResetCause();
+  loadParams();
 
-    float pressureBeforeBar = voltsToBar(pressureBeforeVolts);
-    float pressureAfterBar  = voltsToBarAfter(pressureAfterVolts);
-    float pressureTankBar   = voltsToBar(pressureTankVolts);
+  pinMode(PRESSURE_PIN_BEFORE, INPUT);
+  pinMode(PRESSURE_PIN_AFTER, INPUT);
+  pinMode(PRESSURE_PIN_TANK, INPUT);
 
-    updatePumpDeltaPSafety(pressureBeforeBar, pressureAfterBar, now);
-    pollRsvScale(now);
+  setupRsvScaleReader();
+  resetRsvScaleFilter(millis());
 
-    emitTelemetry(temps_out, MAX_TCS_OUT, now,
-                  pressureBeforeBar, pressureAfterBar, pressureTankBar,
-                  pressureAfterVolts);
+  hal::thermocoupleBus(SCK_PIN, MOSI_PIN, MISO_PIN, TC_CS_PINS, NUM_TCS);
+  for (uint8_t i = 0; i < NUM_TCS; ++i) {
+    g_tc.attach(i, hal::thermocouple(i));
+    if (g_tc.device(i)) g_tc.device(i)->begin();
+    configureTcChannel(i, millis());
   }
+
+  // JSON line telemetry: temps[0..NUM_TCS-1] (°C, calibrated), temps_raw[], valve (0/1), mode (A/O/C), pump{}, safety{}, fluid{}, rsv_scale{}, control{}, heaters{}, sched{}, reset{}
+  Serial.print(F("# Telemetry keys: temps[0.."));
+  Serial.print(NUM_TCS - 1);
+  Serial.println(F("] (°C, calibrated), temps_raw[] (°C), valve (0/1), mode (A/O/C), pump{} (VFD + pressures), safety{} (latched interlocks), fluid{} (MFC400), rsv_scale{} (reservoir scale), control{} (HFE goal + HX limit + hysteresis + HX approach + LN auto status), heaters{bottom,exhaust,*_mode,loops{}}, sched{} ([max_us,max_late_ms,missed,overruns] per task), reset{} + channel_map (first line after boot); {\"type\":\"sched\"} and {\"type\":\"safety_laws\"} (configuration) at boot or on SCHED / SAFETY; {\"type\":\"perf\"} every 10 s or on PERF; {\"type\":\"tc_diag\"} every 10 s or on TC DIAG; {\"type\":\"mem\"} every 10 s or on MEM"));
+
+  schedInit(millis());
+  emitSchedFrame(millis());
+  emitSafetyLawsFrame(millis());
+  setupPressureAdc();
+  updateFastDeltaPLimit();
+  setupControlTick();
+  enableWatchdog();
+}
+
+void loop() {
+  recordLoopPass();
+  reportSafetyEvents();
+  serviceRsvScaleReader();
+  schedRunPass();
+  superviseWatchdog();
 }
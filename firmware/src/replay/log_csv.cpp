@@ -0,0 +1,91 @@
+#include "log_csv.h"
+
+#include "cmd_parse.h"
+
+#include <errno.h>
+#include <math.h>
+#include <string.h>
+
+LogCsv::~LogCsv() {
+  if (file_) fclose(file_);
+}
+
+bool LogCsv::open(const std::string& path, std::string *error) {
+  file_ = fopen(path.c_str(), "r");
+  if (!file_) {
+    *error = std::string("cannot open: ") + strerror(errno);
+    return false;
+  }
+  while (readLine()) {
+    if (buf_.empty() || buf_[0] == '#') continue;
+    split();
+    header_ = cells_;
+    return true;
+  }
+  *error = "no header row";
+  return false;
+}
+
+int LogCsv::column(const char *name) const {
+  for (size_t i = 0; i < header_.size(); ++i) {
+    if (header_[i] == name) return static_cast<int>(i);
+  }
+  return -1;
+}
+
+bool LogCsv::next() {
+  while (readLine()) {
+    if (buf_.empty() || buf_[0] == '#') continue;
+    split();
+    return true;
+  }
+  return false;
+}
+
+float LogCsv::number(int column) const {
+  if (column < 0 || static_cast<size_t>(column) >= cells_.size()) return NAN;
+  const std::string& cell = cells_[column];
+  float value = NAN;
+  if (cell.empty() || !parseFloatText(cell.c_str(), cell.size(), &value)) return NAN;
+  return value;
+}
+
+const std::string& LogCsv::text(int column) const {
+  static const std::string empty;
+  if (column < 0 || static_cast<size_t>(column) >= cells_.size()) return empty;
+  return cells_[column];
+}
+
+bool LogCsv::readLine() {
+  buf_.clear();
+  int c;
+  while ((c = fgetc(file_)) != EOF && c != '\n') {
+    if (c != '\r') buf_.push_back(static_cast<char>(c));
+  }
+  if (c == EOF && buf_.empty()) return false;
+  ++line_;
+  return true;
+}
+
+// Processed exports quote cells that contain commas ("-100°C, bypass closed").
+void LogCsv::split() {
+  cells_.clear();
+  std::string cell;
+  bool quoted = false;
+  for (size_t i = 0; i < buf_.size(); ++i) {
+    const char c = buf_[i];
+    if (quoted) {
+      if (c != '"') cell.push_back(c);
+      else if (i + 1 < buf_.size() && buf_[i + 1] == '"') cell.push_back(buf_[++i]);
+      else quoted = false;
+    } else if (c == '"') {
+      quoted = true;
+    } else if (c == ',') {
+      cells_.push_back(cell);
+      cell.clear();
+    } else {
+      cell.push_back(c);
+    }
+  }
+  cells_.push_back(cell);
+}
@@ -0,0 +1,38 @@
+// Reader for supervisor CSV logs (data/raw/..., data/processed/...): leading
+// `# key=value` comment lines, one header row, then one row per telemetry
+// line. Empty cells read as NAN.
+#pragma once
+
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+class LogCsv {
+ public:
+  ~LogCsv();
+
+  // Opens the file and reads up to and including the header row.
+  bool open(const std::string& path, std::string *error);
+
+  // -1 when the header has no such column.
+  int column(const char *name) const;
+  const std::vector<std::string>& header() const { return header_; }
+
+  // Advances to the next data row; false at end of file.
+  bool next();
+  size_t lineNumber() const { return line_; }
+
+  float number(int column) const;
+  const std::string& text(int column) const;
+
+ private:
+  FILE *file_ = nullptr;
+  size_t line_ = 0;
+  std::string buf_;
+  std::vector<std::string> header_;
+  std::vector<std::string> cells_;
+
+  bool readLine();
+  void split();
+};
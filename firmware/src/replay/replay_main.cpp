@@ -0,0 +1,317 @@
+// [env:replay] log replay: streams recorded supervisor logs through the
+// firmware's LN auto valve decisions (lib/orca_core auto_valve) and diffs
+// them against the logged `valve` column.
+//
+//   program [-j N] [--thi COL] [--hfe COL] [--target KEY=VALUE]... [--lag ROWS] [--show N] PATH...
+//
+// PATH is a CSV log or a directory searched recursively for *.csv. Only rows
+// logged in auto mode (`mode` A) are compared. Entering auto from another mode
+// clears the close latch as `VALVE AUTO` does; a log that starts in auto seeds
+// the latch from its first logged valve state. A run of mismatched rows
+// longer than --lag (default 1, the 1 Hz logging skew against the 50 Hz tick)
+// is a divergence. Logs without the THI/HFE columns (or with them empty) are
+// reported as skipped.
+//
+// Prints `# ...` lines for the first --show divergences per log, one
+// {"type":"replay_log"} JSON line per log in argument order and a final
+// {"type":"replay_summary"} line; exits 1 on any divergence and 2 on an
+// unreadable log or bad option.
+#include "auto_valve.h"
+#include "control_defaults.h"
+
+#include "log_csv.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Options {
+  unsigned jobs = 0;  // 0 = hardware threads
+  std::string thiColumn = "THI_C";
+  std::string hfeColumn = "TMI_C";
+  AutoValveTargets targets = { DEFAULT_HFE_GOAL_C, DEFAULT_HX_LIMIT_C, DEFAULT_HX_APPROACH_C,
+                               DEFAULT_LN_AUTO_HYSTERESIS_C };
+  unsigned lagRows = 1;
+  unsigned showDivergences = 5;
+  std::vector<std::string> paths;
+};
+
+struct Divergence {
+  double timeS;
+  unsigned rows;
+  bool loggedOpen;
+  AutoCloseReason reason;
+  float thiC;
+  float hfeC;
+};
+
+enum LogStatus : uint8_t { LOG_OK = 0, LOG_SKIPPED, LOG_ERROR };
+
+struct LogResult {
+  LogStatus status = LOG_OK;
+  std::string detail;
+  size_t rows = 0;
+  size_t autoRows = 0;
+  size_t comparedRows = 0;
+  size_t mismatchRows = 0;
+  size_t segments = 0;
+  size_t divergences = 0;
+  std::vector<Divergence> shown;
+  double wallMs = 0.0;
+};
+
+const char* logStatusKey(LogStatus status) {
+  switch (status) {
+    case LOG_SKIPPED: return "skipped";
+    case LOG_ERROR:   return "error";
+    default:          return "ok";
+  }
+}
+
+// Same keys as the EEPROM parameter block (`PARAM SET`).
+bool setTarget(AutoValveTargets *targets, const std::string& assignment) {
+  const size_t eq = assignment.find('=');
+  if (eq == std::string::npos) return false;
+  const std::string key = assignment.substr(0, eq);
+  char *end = nullptr;
+  const float value = strtof(assignment.c_str() + eq + 1, &end);
+  if (end == assignment.c_str() + eq + 1 || *end != '\0' || !isfinite(value)) return false;
+  if (key == "hfe_goal_c") targets->hfeGoalC = value;
+  else if (key == "hx_limit_c") targets->hxLimitC = value;
+  else if (key == "hx_approach_c") targets->hxApproachC = value;
+  else if (key == "ln_auto_hysteresis_c") targets->hysteresisC = value;
+  else return false;
+  return true;
+}
+
+// The state the control tick keeps between rows of one recorded run.
+struct ReplayState {
+  AutoValveStatus status = autoValveInitialStatus();
+  bool closeLatched = false;
+  char prevMode = 0;  // 0 = start of a segment, mode unknown before it
+  unsigned mismatchRun = 0;
+  Divergence pending = {};
+};
+
+void endMismatchRun(ReplayState& st, LogResult& result, const Options& opts) {
+  if (st.mismatchRun > opts.lagRows) {
+    ++result.divergences;
+    if (result.shown.size() < opts.showDivergences) {
+      st.pending.rows = st.mismatchRun;
+      result.shown.push_back(st.pending);
+    }
+  }
+  st.mismatchRun = 0;
+}
+
+LogResult replayLog(const std::string& path, const Options& opts) {
+  const auto start = std::chrono::steady_clock::now();
+  LogResult result;
+  LogCsv log;
+  if (!log.open(path, &result.detail)) {
+    result.status = LOG_ERROR;
+    return result;
+  }
+
+  const int timeCol = log.column("time_s");
+  const int valveCol = log.column("valve");
+  const int modeCol = log.column("mode");
+  const int thiCol = log.column(opts.thiColumn.c_str());
+  const int hfeCol = log.column(opts.hfeColumn.c_str());
+  // Processed exports concatenate several raw logs; each is its own run.
+  const int runCol = log.column("log_name");
+  if (valveCol < 0 || modeCol < 0 || thiCol < 0 || hfeCol < 0) {
+    result.status = LOG_SKIPPED;
+    result.detail = "missing valve/mode/" + opts.thiColumn + "/" + opts.hfeColumn + " column";
+    return result;
+  }
+
+  ReplayState st;
+  std::string runName;
+  double prevTimeS = -INFINITY;
+  size_t autoRowsWithTemps = 0;
+  while (log.next()) {
+    ++result.rows;
+    const double timeS = log.number(timeCol);
+    const std::string& name = log.text(runCol);
+    if (result.rows == 1 || name != runName || timeS < prevTimeS) {
+      endMismatchRun(st, result, opts);
+      st = ReplayState();
+      runName = name;
+      ++result.segments;
+    }
+    if (isfinite(timeS)) prevTimeS = timeS;
+
+    const char mode = log.text(modeCol).empty() ? 0 : log.text(modeCol)[0];
+    const float valve = log.number(valveCol);
+    if (mode != 'A') {
+      endMismatchRun(st, result, opts);
+      st.prevMode = mode;
+      continue;
+    }
+    ++result.autoRows;
+
+    const float thiC = log.number(thiCol);
+    const float hfeC = log.number(hfeCol);
+    if (isfinite(thiC) && isfinite(hfeC)) ++autoRowsWithTemps;
+    updateAutoValveStatusFromValues(&st.status, opts.targets, thiC, hfeC);
+    if (st.prevMode == 0) st.closeLatched = isfinite(valve) && valve < 0.5f;
+    else if (st.prevMode != 'A') st.closeLatched = false;
+    st.prevMode = mode;
+    const bool open = autoValveDecide(st.status, &st.closeLatched);
+
+    if (!isfinite(valve)) continue;
+    ++result.comparedRows;
+    const bool loggedOpen = valve >= 0.5f;
+    if (open == loggedOpen) {
+      endMismatchRun(st, result, opts);
+      continue;
+    }
+    ++result.mismatchRows;
+    if (st.mismatchRun++ == 0) {
+      st.pending = { timeS, 0, loggedOpen, st.status.reason, thiC, hfeC };
+    }
+  }
+  endMismatchRun(st, result, opts);
+
+  if (result.autoRows == 0 || autoRowsWithTemps == 0) {
+    result.status = LOG_SKIPPED;
+    result.detail = result.autoRows == 0 ? "no auto-mode rows"
+                                         : "no auto-mode rows with " + opts.thiColumn + " and " + opts.hfeColumn;
+  }
+  result.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  return result;
+}
+
+void printJsonString(const std::string& text) {
+  putchar('"');
+  for (const char c : text) {
+    if (c == '"' || c == '\\') putchar('\\');
+    putchar(c);
+  }
+  putchar('"');
+}
+
+void printLogResult(const std::string& path, const LogResult& r) {
+  for (const Divergence &d : r.shown) {
+    printf("# %s t=%.1fs logged=%s replay=%s reason=%s thi=%.2f hfe=%.2f rows=%u\n", path.c_str(), d.timeS,
+           d.loggedOpen ? "open" : "closed", d.loggedOpen ? "closed" : "open", autoCloseReasonKey(d.reason),
+           d.thiC, d.hfeC, d.rows);
+  }
+  printf("{\"type\":\"replay_log\",\"log\":");
+  printJsonString(path);
+  printf(",\"status\":\"%s\"", logStatusKey(r.status));
+  if (!r.detail.empty()) {
+    printf(",\"detail\":");
+    printJsonString(r.detail);
+  }
+  printf(",\"rows\":%zu,\"segments\":%zu,\"auto_rows\":%zu,\"compared_rows\":%zu,\"mismatch_rows\":%zu,"
+         "\"divergences\":%zu,\"ms\":%.3f}\n",
+         r.rows, r.segments, r.autoRows, r.comparedRows, r.mismatchRows, r.divergences, r.wallMs);
+}
+
+bool expandPaths(const std::vector<std::string>& args, std::vector<std::string> *logs) {
+  namespace fs = std::filesystem;
+  for (const std::string &arg : args) {
+    std::error_code ec;
+    if (!fs::is_directory(arg, ec)) {
+      logs->push_back(arg);
+      continue;
+    }
+    std::vector<std::string> found;
+    for (const fs::directory_entry &entry : fs::recursive_directory_iterator(arg, ec)) {
+      if (entry.is_regular_file() && entry.path().extension() == ".csv") found.push_back(entry.path().string());
+    }
+    if (ec) {
+      fprintf(stderr, "%s: %s\n", arg.c_str(), ec.message().c_str());
+      return false;
+    }
+    std::sort(found.begin(), found.end());
+    logs->insert(logs->end(), found.begin(), found.end());
+  }
+  return true;
+}
+
+bool parseOptions(int argc, char **argv, Options *opts) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (arg == "-j" && hasValue) opts->jobs = static_cast<unsigned>(atoi(argv[++i]));
+    else if (arg == "--thi" && hasValue) opts->thiColumn = argv[++i];
+    else if (arg == "--hfe" && hasValue) opts->hfeColumn = argv[++i];
+    else if (arg == "--target" && hasValue) {
+      if (!setTarget(&opts->targets, argv[++i])) return false;
+    }
+    else if (arg == "--lag" && hasValue) opts->lagRows = static_cast<unsigned>(atoi(argv[++i]));
+    else if (arg == "--show" && hasValue) opts->showDivergences = static_cast<unsigned>(atoi(argv[++i]));
+    else if (!arg.empty() && arg[0] == '-') return false;
+    else opts->paths.push_back(arg);
+  }
+  return !opts->paths.empty();
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options opts;
+  if (!parseOptions(argc, argv, &opts)) {
+    fprintf(stderr,
+            "usage: %s [-j N] [--thi COL] [--hfe COL] [--target KEY=VALUE]... [--lag ROWS] [--show N] PATH...\n"
+            "  KEY: hfe_goal_c, hx_limit_c, hx_approach_c, ln_auto_hysteresis_c\n",
+            argv[0]);
+    return 2;
+  }
+  std::vector<std::string> logs;
+  if (!expandPaths(opts.paths, &logs)) return 2;
+
+  unsigned jobs = opts.jobs ? opts.jobs : std::max(1U, std::thread::hardware_concurrency());
+  jobs = static_cast<unsigned>(std::min<size_t>(jobs, std::max<size_t>(logs.size(), 1)));
+
+  // Workers claim logs by index; results print afterwards in argument order.
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<LogResult> results(logs.size());
+  std::atomic<size_t> nextLog(0);
+  auto worker = [&]() {
+    for (size_t i = nextLog++; i < logs.size(); i = nextLog++) results[i] = replayLog(logs[i], opts);
+  };
+  std::vector<std::thread> pool;
+  for (unsigned t = 1; t < jobs; ++t) pool.emplace_back(worker);
+  worker();
+  for (std::thread &t : pool) t.join();
+  const double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  size_t rows = 0, compared = 0, divergences = 0, skipped = 0, errors = 0;
+  double cpuMs = 0.0;
+  for (size_t i = 0; i < logs.size(); ++i) {
+    const LogResult &r = results[i];
+    if (r.status == LOG_ERROR) fprintf(stderr, "%s: %s\n", logs[i].c_str(), r.detail.c_str());
+    printLogResult(logs[i], r);
+    rows += r.rows;
+    compared += r.comparedRows;
+    divergences += r.divergences;
+    cpuMs += r.wallMs;
+    if (r.status == LOG_SKIPPED) ++skipped;
+    if (r.status == LOG_ERROR) ++errors;
+  }
+  printf("{\"type\":\"replay_summary\",\"logs\":%zu,\"skipped\":%zu,\"errors\":%zu,\"rows\":%zu,"
+         "\"compared_rows\":%zu,\"divergences\":%zu,\"jobs\":%u,\"wall_ms\":%.3f,\"log_ms\":%.3f,"
+         "\"rows_per_s\":%.0f,\"targets\":{\"hfe_goal_c\":%g,\"hx_limit_c\":%g,\"hx_approach_c\":%g,"
+         "\"ln_auto_hysteresis_c\":%g}}\n",
+         logs.size(), skipped, errors, rows, compared, divergences, jobs, wallMs, cpuMs,
+         wallMs > 0.0 ? rows / (wallMs / 1000.0) : 0.0, opts.targets.hfeGoalC, opts.targets.hxLimitC,
+         opts.targets.hxApproachC, opts.targets.hysteresisC);
+
+  if (errors) return 2;
+  return divergences ? 1 : 0;
+}
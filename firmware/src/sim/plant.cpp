@@ -0,0 +1,135 @@
+#include "plant.h"
+
+#include <math.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+constexpr double KELVIN_OFFSET = 273.15;
+
+struct ParamKey {
+  const char *key;
+  double PlantParams::*field;
+};
+
+const ParamKey PARAM_KEYS[] = {
+  {"hfe_volume_l",                  &PlantParams::hfeVolumeL},
+  {"hfe_density_intercept_kg_m3",   &PlantParams::hfeDensityInterceptKgM3},
+  {"hfe_density_slope_kg_m3_per_c", &PlantParams::hfeDensitySlopeKgM3PerC},
+  {"hfe_cp_intercept_j_kg_k",       &PlantParams::hfeCpInterceptJKgK},
+  {"hfe_cp_slope_j_kg_k_per_c",     &PlantParams::hfeCpSlopeJKgKPerC},
+  {"hfe_freeze_c",                  &PlantParams::hfeFreezeC},
+  {"loop_steel_kg",                 &PlantParams::loopSteelKg},
+  {"hx_steel_kg",                   &PlantParams::hxSteelKg},
+  {"steel_cp_j_kg_k",               &PlantParams::steelCpJKgK},
+  {"hx_hfe_ua_w_k",                 &PlantParams::hxHfeUaWK},
+  {"hx_stagnant_ua_w_k",            &PlantParams::hxStagnantUaWK},
+  {"ambient_ua_w_k",                &PlantParams::ambientUaWK},
+  {"ambient_c",                     &PlantParams::ambientC},
+  {"initial_c",                     &PlantParams::initialC},
+  {"ln_temp_c",                     &PlantParams::lnTempC},
+  {"ln_q_max_w",                    &PlantParams::lnQMaxW},
+  {"ln_wall_ua_w_k",                &PlantParams::lnWallUaWK},
+  {"ln_latent_j_kg",                &PlantParams::lnLatentJKg},
+  {"valve_tau_s",                   &PlantParams::valveTauS},
+  {"pump_flow_lpm_per_pct",         &PlantParams::pumpFlowLpmPerPct},
+  {"pump_dp_bar_per_lpm",           &PlantParams::pumpDpBarPerLpm},
+  {"pump_dp_ref_c",                 &PlantParams::pumpDpRefC},
+  {"pump_dp_visc_k",                &PlantParams::pumpDpViscK},
+  {"pump_heat_w",                   &PlantParams::pumpHeatW},
+  {"tc_tau_s",                      &PlantParams::tcTauS},
+};
+
+}  // namespace
+
+double* plantParam(PlantParams& params, const std::string& key) {
+  for (const ParamKey &entry : PARAM_KEYS) {
+    if (key == entry.key) return &(params.*entry.field);
+  }
+  return nullptr;
+}
+
+bool loadPlantParams(const std::string& path, PlantParams* params, std::string* error) {
+  std::ifstream in(path);
+  if (!in) {
+    *error = path + ": cannot open";
+    return false;
+  }
+  std::string line;
+  for (int lineNo = 1; std::getline(in, line); ++lineNo) {
+    line = line.substr(0, line.find('#'));
+    std::istringstream fields(line);
+    std::string key;
+    if (!(fields >> key)) continue;
+    double value = NAN;
+    double *field = plantParam(*params, key);
+    if (!field || !(fields >> value) || !isfinite(value)) {
+      *error = path + ":" + std::to_string(lineNo) + ": bad parameter '" + key + "'";
+      return false;
+    }
+    *field = value;
+  }
+  return true;
+}
+
+Plant::Plant(const PlantParams& params) : p_(params) {
+  state_.bulkC = p_.initialC;
+  state_.wallC = p_.initialC;
+  state_.hxOutC = p_.initialC;
+}
+
+double Plant::densityKgM3(double tempC) const {
+  return p_.hfeDensityInterceptKgM3 - p_.hfeDensitySlopeKgM3PerC * tempC;
+}
+
+double Plant::cpJKgK(double tempC) const {
+  return p_.hfeCpInterceptJKgK + p_.hfeCpSlopeJKgKPerC * tempC;
+}
+
+void Plant::step(double dtS, const PlantInputs& in) {
+  PlantState &s = state_;
+  const double pumpPct = std::min(std::max(in.pumpPct, 0.0), 100.0);
+
+  // Fixed liquid volume, as in orca.cooldown: mass follows density.
+  const double rho = densityKgM3(s.bulkC);
+  const double cp = cpJKgK(s.bulkC);
+  const double bulkCapacity = p_.hfeVolumeL * 1e-3 * rho * cp + p_.loopSteelKg * p_.steelCpJKgK;
+  const double wallCapacity = p_.hxSteelKg * p_.steelCpJKgK;
+
+  const double valveTarget = in.valveOpen ? 1.0 : 0.0;
+  s.valveFrac += (valveTarget - s.valveFrac) * (p_.valveTauS > 0.0 ? 1.0 - exp(-dtS / p_.valveTauS) : 1.0);
+
+  s.flowLpm = pumpPct * p_.pumpFlowLpmPerPct;
+  const double massFlowKgS = s.flowLpm / 60000.0 * rho;
+  if (massFlowKgS > 1e-6) {
+    const double ntu = p_.hxHfeUaWK / (massFlowKgS * cp);
+    s.hxOutC = s.wallC + (s.bulkC - s.wallC) * exp(-ntu);
+    s.qHfeW = massFlowKgS * cp * (s.bulkC - s.hxOutC);
+  } else {
+    s.hxOutC = s.wallC;  // stagnant coil sits at wall temperature
+    s.qHfeW = p_.hxStagnantUaWK * (s.bulkC - s.wallC);
+  }
+
+  s.qLnW = s.wallC > p_.lnTempC
+             ? std::min(s.valveFrac * p_.lnQMaxW, p_.lnWallUaWK * (s.wallC - p_.lnTempC))
+             : 0.0;
+  s.qLeakW = p_.ambientUaWK * (p_.ambientC - s.bulkC);
+  const double pumpHeatW = p_.pumpHeatW * (pumpPct / 100.0) * (pumpPct / 100.0);
+
+  s.bulkC += dtS * (-s.qHfeW + s.qLeakW + in.heaterW + pumpHeatW) / bulkCapacity;
+  s.wallC += dtS * (s.qHfeW - s.qLnW) / wallCapacity;
+
+  const double viscosity = exp(p_.pumpDpViscK * (1.0 / (s.bulkC + KELVIN_OFFSET) -
+                                                 1.0 / (p_.pumpDpRefC + KELVIN_OFFSET)));
+  s.deltaPBar = s.flowLpm * p_.pumpDpBarPerLpm * viscosity * in.dpFactor;
+
+  if (p_.lnLatentJKg > 0.0) s.lnKg += s.qLnW * dtS / p_.lnLatentJKg;
+  if (s.hxOutC < p_.hfeFreezeC) s.freezeS += dtS;
+}
+
+void LaggedSensor::step(double input, double dtS, double tauS) {
+  value += (input - value) * (tauS > 0.0 ? 1.0 - exp(-dtS / tauS) : 1.0);
+}
@@ -0,0 +1,86 @@
+// Lumped thermal-hydraulic model of the HFE loop for the closed-loop simulator.
+//
+// Two thermal nodes: the HFE bulk (tank, piping and their steel) and the HX
+// coil wall. The pump sets flow through the coil; HFE leaving the coil (THI)
+// follows an effectiveness-NTU exchange with the wall; LN removes heat from
+// the wall up to the measured HX ceiling while the valve is open. Delta-P is
+// laminar in flow with an Arrhenius viscosity factor on the bulk temperature.
+// Parameters come from sim/plant_params.txt (scripts/export_sim_plant_params.py).
+#pragma once
+
+#include <string>
+
+struct PlantParams {
+  double hfeVolumeL = 3.06;
+  double hfeDensityInterceptKgM3 = 1481.1;
+  double hfeDensitySlopeKgM3PerC = 2.3026;
+  double hfeCpInterceptJKgK = 1147.74;
+  double hfeCpSlopeJKgKPerC = 2.89028;
+  double hfeFreezeC = -121.0;
+  double loopSteelKg = 7.77355;
+  double hxSteelKg = 0.955892;
+  double steelCpJKgK = 500.0;
+  double hxHfeUaWK = 30.4224;
+  double hxStagnantUaWK = 3.04224;
+  double ambientUaWK = 1.05703;
+  double ambientC = 25.0;
+  double initialC = 25.0;
+  double lnTempC = -195.8;
+  double lnQMaxW = 255.813;
+  double lnWallUaWK = 166.396;
+  double lnLatentJKg = 165000.0;
+  double valveTauS = 5.0;
+  double pumpFlowLpmPerPct = 0.0677341;
+  double pumpDpBarPerLpm = 0.237192;
+  double pumpDpRefC = -80.0;
+  double pumpDpViscK = 1115.69;
+  double pumpHeatW = 60.0;
+  double tcTauS = 1.5;
+};
+
+// Field for a params-file key, or nullptr.
+double* plantParam(PlantParams& params, const std::string& key);
+
+// `key value` lines, `#` comments. Unknown keys are an error.
+bool loadPlantParams(const std::string& path, PlantParams* params, std::string* error);
+
+struct PlantInputs {
+  bool   valveOpen = false;
+  double pumpPct = 0.0;
+  double heaterW = 0.0;
+  double dpFactor = 1.0;   // >1 models a partial line blockage
+};
+
+struct PlantState {
+  double bulkC = 0.0;      // TMI
+  double wallC = 0.0;
+  double hxOutC = 0.0;     // THI
+  double valveFrac = 0.0;  // LN line wetted fraction, lags the valve
+  double flowLpm = 0.0;
+  double deltaPBar = 0.0;
+  double qHfeW = 0.0;      // HFE -> coil wall
+  double qLnW = 0.0;       // coil wall -> LN
+  double qLeakW = 0.0;     // ambient -> HFE
+  double lnKg = 0.0;
+  double freezeS = 0.0;    // time with THI below hfe_freeze_c
+};
+
+class Plant {
+ public:
+  explicit Plant(const PlantParams& params);
+  void step(double dtS, const PlantInputs& in);
+  const PlantState& state() const { return state_; }
+
+ private:
+  double densityKgM3(double tempC) const;
+  double cpJKgK(double tempC) const;
+
+  PlantParams p_;
+  PlantState state_;
+};
+
+// First-order lag, e.g. a sheathed thermocouple.
+struct LaggedSensor {
+  double value = 0.0;
+  void step(double input, double dtS, double tauS);
+};
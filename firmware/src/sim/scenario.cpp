@@ -0,0 +1,93 @@
+#include "scenario.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+bool parseDurationS(const std::string& text, double *out) {
+  if (text.empty()) return false;
+  char *end = nullptr;
+  const double value = strtod(text.c_str(), &end);
+  if (end == text.c_str() || !isfinite(value) || value < 0.0) return false;
+  const std::string suffix(end);
+  double scale = 1.0;
+  if (suffix == "m") scale = 60.0;
+  else if (suffix == "h") scale = 3600.0;
+  else if (!suffix.empty() && suffix != "s") return false;
+  *out = value * scale;
+  return true;
+}
+
+static bool parseNumber(const std::string& text, double *out) {
+  char *end = nullptr;
+  *out = strtod(text.c_str(), &end);
+  return end != text.c_str() && *end == '\0' && isfinite(*out);
+}
+
+bool loadScenario(const std::string& path, Scenario* scenario, std::string* error) {
+  std::ifstream in(path);
+  if (!in) {
+    *error = path + ": cannot open";
+    return false;
+  }
+
+  std::string line;
+  for (int lineNo = 1; std::getline(in, line); ++lineNo) {
+    line = line.substr(0, line.find('#'));
+    std::istringstream fields(line);
+    std::vector<std::string> words;
+    for (std::string word; fields >> word;) words.push_back(word);
+    if (words.empty()) continue;
+
+    const std::string where = path + ":" + std::to_string(lineNo) + ": ";
+    const std::string &kind = words[0];
+    bool ok = true;
+    if (kind == "name" && words.size() >= 2) {
+      scenario->name = line.substr(line.find(words[1]));
+      scenario->name.erase(scenario->name.find_last_not_of(" \t\r") + 1);
+    } else if (kind == "duration" && words.size() == 2) {
+      ok = parseDurationS(words[1], &scenario->durationS);
+    } else if (kind == "param" && words.size() == 3) {
+      double value = NAN;
+      ok = parseNumber(words[2], &value);
+      if (ok) scenario->params.emplace_back(words[1], value);
+    } else if (kind == "at" && words.size() >= 3) {
+      ScenarioEvent event = { 0.0, words[2], {}, lineNo };
+      ok = parseDurationS(words[1], &event.timeS);
+      event.args.assign(words.begin() + 3, words.end());
+      if (ok) scenario->events.push_back(event);
+    } else if (kind == "expect" && words.size() == 4) {
+      ScenarioExpect expect = { words[1], words[2], NAN, lineNo };
+      ok = parseNumber(words[3], &expect.value) &&
+           (expect.op == "<" || expect.op == "<=" || expect.op == ">" ||
+            expect.op == ">=" || expect.op == "==");
+      if (ok) scenario->expects.push_back(expect);
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      *error = where + "cannot parse '" + line + "'";
+      return false;
+    }
+  }
+
+  if (scenario->durationS <= 0.0) {
+    *error = path + ": missing duration";
+    return false;
+  }
+  std::stable_sort(scenario->events.begin(), scenario->events.end(),
+                   [](const ScenarioEvent& a, const ScenarioEvent& b) { return a.timeS < b.timeS; });
+  return true;
+}
+
+bool expectHolds(const ScenarioExpect& expect, double actual) {
+  if (!isfinite(actual)) return false;
+  if (expect.op == "<")  return actual < expect.value;
+  if (expect.op == "<=") return actual <= expect.value;
+  if (expect.op == ">")  return actual > expect.value;
+  if (expect.op == ">=") return actual >= expect.value;
+  return actual == expect.value;
+}
@@ -0,0 +1,47 @@
+// Scenario scripts for the closed-loop simulator.
+//
+//   # comment
+//   name     <text>
+//   duration <time>                   times take an s, m or h suffix (default s)
+//   param    <plant key> <value>      overrides sim/plant_params.txt
+//   at <time> pump <pct>
+//   at <time> valve auto|open|close
+//   at <time> heater <W>
+//   at <time> target hfe_goal|hx_limit|hx_approach|hysteresis <C>
+//   at <time> law <key> on|off|<limit>
+//   at <time> fault thi|tmi open|clear|stuck <C>|offset <C>
+//   at <time> fault dp_block <factor>  (1 clears)
+//   at <time> estop_reset
+//   expect <metric> <|<=|>|>=|== <value>
+//
+// Events fire in time order; events at the same time fire in file order.
+#pragma once
+
+#include <string>
+#include <vector>
+
+struct ScenarioEvent {
+  double timeS;
+  std::string verb;
+  std::vector<std::string> args;
+  int line;
+};
+
+struct ScenarioExpect {
+  std::string metric;
+  std::string op;
+  double value;
+  int line;
+};
+
+struct Scenario {
+  std::string name;
+  double durationS = 0.0;
+  std::vector<std::pair<std::string, double>> params;
+  std::vector<ScenarioEvent> events;    // sorted by time
+  std::vector<ScenarioExpect> expects;
+};
+
+bool parseDurationS(const std::string& text, double *out);
+bool loadScenario(const std::string& path, Scenario* scenario, std::string* error);
+bool expectHolds(const ScenarioExpect& expect, double actual);
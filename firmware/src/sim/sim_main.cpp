@@ -0,0 +1,464 @@
+// [env:sim] closed-loop simulator: the firmware's LN auto valve and safety law
+// code (lib/orca_core) in closed loop with a lumped model of the HFE plant,
+// stepped at the 50 Hz control tick on the host HAL clock.
+//
+//   program [--params FILE] [--csv FILE] [--log-interval S] [--pace X] SCENARIO...
+//
+// Prints event lines (`# ...`) and one {"type":"sim_summary"} JSON line per
+// scenario; exits 1 when an `expect` fails and 2 on a bad scenario or params.
+// --pace X throttles to X times real time for watching a run live; the
+// default is as fast as the host allows.
+#include "auto_valve.h"
+#include "control_defaults.h"
+#include "hal_host.h"
+#include "safety_law.h"
+
+#include "plant.h"
+#include "scenario.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t TICK_MS = 1000U / CONTROL_TICK_HZ;
+constexpr uint32_t TC_PERIOD_MS = TC_CHANNELS[HFE_AUTO_SENSOR_INDEX].periodMs;  // TMI/THI read period
+
+enum ValveMode : uint8_t { VALVE_MODE_AUTO = 0, VALVE_MODE_OPEN, VALVE_MODE_CLOSE };
+
+enum SensorChannel : uint8_t { SENSOR_TMI = 0, SENSOR_THI, SENSOR_COUNT };
+
+struct SensorFault {
+  enum Kind : uint8_t { NONE = 0, OPEN, STUCK, OFFSET } kind = NONE;
+  double value = 0.0;
+};
+
+#define SIM_LAW(key, label, signal, channel, compare, enabled, limit, rate, persistMs, actions, latch, band, holdMs) \
+  { key, label, signal, channel, compare, enabled, limit, rate, persistMs, actions, latch, band, holdMs, \
+    false, false, false, NAN, NAN, NAN, 0, 0, 0 }
+
+// The firmware laws with a signal in the plant model, at their firmware defaults.
+const SafetyLawState DEFAULT_LAWS[] = {
+  SIM_LAW("pump_delta_p_high", "Pump delta P high", SAFETY_SIGNAL_DELTA_P_BAR, 0, SAFETY_ABOVE,
+          true, PUMP_DELTA_P_ESTOP_BAR, NAN, 0, SAFETY_ACTION_PUMP_STOP, SAFETY_LATCH, 0.0f, 0),
+  SIM_LAW("thi_freeze_risk", "THI freeze risk", SAFETY_SIGNAL_TC, THI_SENSOR_INDEX, SAFETY_BELOW,
+          true, THI_FREEZE_RISK_C, NAN, 2000, SAFETY_ACTION_VALVE_CLOSE, SAFETY_AUTO_RESET,
+          THI_FREEZE_RISK_CLEAR_C, THI_FREEZE_RISK_HOLD_MS),
+  SIM_LAW("thi_stale", "THI reading stale", SAFETY_SIGNAL_TC, THI_SENSOR_INDEX, SAFETY_STALE,
+          false, 5.0f, NAN, 0, SAFETY_ACTION_VALVE_CLOSE, SAFETY_AUTO_RESET, 0.0f, 0),
+};
+constexpr size_t LAW_COUNT = sizeof(DEFAULT_LAWS) / sizeof(DEFAULT_LAWS[0]);
+constexpr size_t LAW_THI_FREEZE_RISK = 1;
+
+// The slice of the firmware state the control tick works on.
+struct Controller {
+  AutoValveTargets targets = { DEFAULT_HFE_GOAL_C, DEFAULT_HX_LIMIT_C, DEFAULT_HX_APPROACH_C,
+                               DEFAULT_LN_AUTO_HYSTERESIS_C };
+  AutoValveStatus status = autoValveInitialStatus();
+  bool     statusSampled = false;
+  bool     closeLatched = false;
+  ValveMode mode = VALVE_MODE_AUTO;
+  bool     valveOpen = false;
+  double   pumpCmdPct = 0.0;
+  bool     estopLatched = false;
+  uint8_t  actions = 0;
+  SafetyLawState laws[LAW_COUNT];
+  float    temps[SENSOR_COUNT] = { NAN, NAN };
+  uint32_t tempsValidMs[SENSOR_COUNT] = { 0, 0 };
+  bool     tempsPublished = false;
+};
+
+struct Metrics {
+  double minTmiC = INFINITY;
+  double minThiC = INFINITY;
+  double maxDeltaPBar = 0.0;
+  double timeToGoalS = NAN;
+  double freezeLawS = 0.0;
+  unsigned valveOpens = 0;
+  unsigned valveCloses = 0;
+  unsigned estopTrips = 0;
+  unsigned pumpBlocked = 0;
+};
+
+struct Options {
+  std::string paramsPath = "sim/plant_params.txt";
+  std::string csvPath;
+  double logIntervalS = 10.0;
+  double pace = 0.0;
+  std::vector<std::string> scenarios;
+};
+
+double simTimeS() { return hal::host::timeUs() / 1e6; }
+
+void logEvent(const char *fmt, const std::string& detail) {
+  printf("# t=%.1fs ", simTimeS());
+  printf(fmt, detail.c_str());
+  putchar('\n');
+}
+
+size_t sensorForChannel(uint8_t channel) {
+  return channel == THI_SENSOR_INDEX ? SENSOR_THI : SENSOR_TMI;
+}
+
+float lawSignal(const Controller& ctl, const SafetyLawState& law, const PlantState& plant,
+                uint32_t nowMs, uint32_t *sampleMs) {
+  *sampleMs = nowMs;
+  if (law.signal == SAFETY_SIGNAL_DELTA_P_BAR) return static_cast<float>(plant.deltaPBar);
+  if (law.signal == SAFETY_SIGNAL_TC && ctl.tempsPublished) {
+    const size_t sensor = sensorForChannel(law.channel);
+    *sampleMs = ctl.tempsValidMs[sensor];
+    return ctl.temps[sensor];
+  }
+  *sampleMs = 0;
+  return NAN;
+}
+
+bool canResetEmergencyStop(const Controller& ctl) {
+  for (const SafetyLawState &law : ctl.laws) {
+    if (law.latch == SAFETY_LATCH && law.enabled && law.active) return false;
+  }
+  return true;
+}
+
+void setValve(Controller& ctl, bool open, Metrics& metrics) {
+  if (open == ctl.valveOpen) return;
+  ctl.valveOpen = open;
+  if (open) ++metrics.valveOpens;
+  else      ++metrics.valveCloses;
+}
+
+void applyValveMode(Controller& ctl, Metrics& metrics) {
+  if (ctl.actions & SAFETY_ACTION_VALVE_CLOSE) {
+    setValve(ctl, false, metrics);
+    return;
+  }
+  if (ctl.mode == VALVE_MODE_AUTO) {
+    if (ctl.statusSampled) setValve(ctl, autoValveDecide(ctl.status, &ctl.closeLatched), metrics);
+  } else {
+    setValve(ctl, ctl.mode == VALVE_MODE_OPEN, metrics);
+  }
+}
+
+// Same order as runControlTick(): safety laws, auto status, valve mode.
+void controlTick(Controller& ctl, const PlantState& plant, Metrics& metrics) {
+  const uint32_t nowMs = hal::nowMs();
+  uint8_t actions = 0;
+  for (SafetyLawState &law : ctl.laws) {
+    uint32_t sampleMs = 0;
+    const float value = lawSignal(ctl, law, plant, nowMs, &sampleMs);
+    const SafetyLawEvent event = safetyLawStep(law, safetyLawCondition(law, value, sampleMs, nowMs), nowMs, &actions);
+    if (event == SAFETY_EVENT_TRIPPED) {
+      ctl.estopLatched = true;
+      ++metrics.estopTrips;
+      logEvent("safety %s tripped (emergency stop)", law.key);
+    } else if (event == SAFETY_EVENT_CHANGED) {
+      logEvent(law.active ? "safety %s active" : "safety %s cleared", law.key);
+    }
+  }
+  ctl.actions = actions;
+  if ((actions & SAFETY_ACTION_PUMP_STOP) && ctl.pumpCmdPct > 0.0) ctl.pumpCmdPct = 0.0;
+
+  if (ctl.tempsPublished) {
+    updateAutoValveStatusFromValues(&ctl.status, ctl.targets, ctl.temps[SENSOR_THI], ctl.temps[SENSOR_TMI]);
+    ctl.statusSampled = true;
+  }
+  applyValveMode(ctl, metrics);
+}
+
+float readSensor(const LaggedSensor& sensor, const SensorFault& fault) {
+  switch (fault.kind) {
+    case SensorFault::OPEN:   return NAN;
+    case SensorFault::STUCK:  return static_cast<float>(fault.value);
+    case SensorFault::OFFSET: return static_cast<float>(sensor.value + fault.value);
+    default:                  return static_cast<float>(sensor.value);
+  }
+}
+
+struct Run {
+  Controller ctl;
+  Metrics metrics;
+  PlantInputs inputs;
+  SensorFault faults[SENSOR_COUNT];
+};
+
+bool applyEvent(Run& run, const ScenarioEvent& event) {
+  Controller &ctl = run.ctl;
+  const std::vector<std::string> &args = event.args;
+  const std::string arg0 = args.empty() ? "" : args[0];
+  char *end = nullptr;
+  const double value = args.empty() ? NAN : strtod(args.back().c_str(), &end);
+  const bool numeric = !args.empty() && end != args.back().c_str() && *end == '\0' && isfinite(value);
+
+  if (event.verb == "pump" && args.size() == 1 && numeric) {
+    if ((ctl.actions & SAFETY_ACTION_PUMP_STOP) && value > 0.0) {
+      ++run.metrics.pumpBlocked;
+      logEvent("pump command blocked by %s", ctl.estopLatched ? "emergency stop" : "active safety law");
+    } else {
+      ctl.pumpCmdPct = value;
+    }
+  } else if (event.verb == "valve" && args.size() == 1) {
+    if (arg0 == "auto") {
+      if (ctl.mode != VALVE_MODE_AUTO) ctl.closeLatched = false;
+      ctl.mode = VALVE_MODE_AUTO;
+    } else if (arg0 == "open") {
+      ctl.mode = VALVE_MODE_OPEN;
+    } else if (arg0 == "close") {
+      ctl.mode = VALVE_MODE_CLOSE;
+    } else {
+      return false;
+    }
+    applyValveMode(ctl, run.metrics);
+  } else if (event.verb == "heater" && args.size() == 1 && numeric) {
+    run.inputs.heaterW = value;
+  } else if (event.verb == "target" && args.size() == 2 && numeric) {
+    AutoValveTargets &t = ctl.targets;
+    float *target = arg0 == "hfe_goal"    ? &t.hfeGoalC
+                  : arg0 == "hx_limit"    ? &t.hxLimitC
+                  : arg0 == "hx_approach" ? &t.hxApproachC
+                  : arg0 == "hysteresis"  ? &t.hysteresisC
+                  : nullptr;
+    if (!target) return false;
+    *target = static_cast<float>(value);
+    // refreshAutoStatusAfterTargetChange()
+    updateAutoValveStatusFromValues(&ctl.status, ctl.targets, ctl.status.thiTempC, ctl.status.hfeTempC);
+    if (ctl.mode == VALVE_MODE_AUTO && ctl.statusSampled) applyValveMode(ctl, run.metrics);
+  } else if (event.verb == "law" && args.size() == 2) {
+    SafetyLawState *law = nullptr;
+    for (SafetyLawState &candidate : ctl.laws) {
+      if (arg0 == candidate.key) law = &candidate;
+    }
+    if (!law) return false;
+    if (args[1] == "on" || args[1] == "off") law->enabled = args[1] == "on";
+    else if (numeric) law->limit = static_cast<float>(value);
+    else return false;
+  } else if (event.verb == "fault" && args.size() >= 2) {
+    if (arg0 == "dp_block" && args.size() == 2 && numeric && value > 0.0) {
+      run.inputs.dpFactor = value;
+      return true;
+    }
+    SensorFault *fault = arg0 == "thi" ? &run.faults[SENSOR_THI]
+                       : arg0 == "tmi" ? &run.faults[SENSOR_TMI]
+                       : nullptr;
+    if (!fault) return false;
+    const std::string &kind = args[1];
+    if (kind == "open" && args.size() == 2)               *fault = { SensorFault::OPEN, 0.0 };
+    else if (kind == "clear" && args.size() == 2)         *fault = { SensorFault::NONE, 0.0 };
+    else if (kind == "stuck" && args.size() == 3 && numeric)  *fault = { SensorFault::STUCK, value };
+    else if (kind == "offset" && args.size() == 3 && numeric) *fault = { SensorFault::OFFSET, value };
+    else return false;
+  } else if (event.verb == "estop_reset" && args.empty()) {
+    if (!ctl.estopLatched) return true;
+    if (!canResetEmergencyStop(ctl)) {
+      logEvent("%s", "emergency stop reset blocked by active safety law");
+      return true;
+    }
+    uint8_t actions = 0;
+    for (SafetyLawState &law : ctl.laws) {
+      law.tripped = false;
+      if (law.latch == SAFETY_AUTO_RESET && law.active) actions |= law.actions;
+    }
+    ctl.actions = actions;
+    ctl.estopLatched = false;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void writeCsvHeader(FILE *csv) {
+  fputs("scenario,time_s,tmi_c,thi_c,tmi_meas_c,thi_meas_c,wall_c,valve,valve_frac,pump_pct,"
+        "flow_lpm,delta_p_bar,q_hfe_w,q_ln_w,q_leak_w,ln_kg,estop,auto_reason\n", csv);
+}
+
+void writeCsvRow(FILE *csv, const std::string& name, const Run& run, const PlantState& s) {
+  const Controller &ctl = run.ctl;
+  fprintf(csv, "%s,%.1f,%.3f,%.3f,%.3f,%.3f,%.3f,%d,%.3f,%.1f,%.3f,%.4f,%.2f,%.2f,%.2f,%.4f,%d,%s\n",
+          name.c_str(), simTimeS(), s.bulkC, s.hxOutC, ctl.temps[SENSOR_TMI], ctl.temps[SENSOR_THI],
+          s.wallC, ctl.valveOpen ? 1 : 0, s.valveFrac, ctl.pumpCmdPct, s.flowLpm, s.deltaPBar,
+          s.qHfeW, s.qLnW, s.qLeakW, s.lnKg, ctl.estopLatched ? 1 : 0,
+          autoCloseReasonKey(ctl.status.reason));
+}
+
+double metricValue(const std::string& key, const Run& run, const PlantState& s) {
+  const Metrics &m = run.metrics;
+  if (key == "final_tmi_c")    return s.bulkC;
+  if (key == "min_tmi_c")      return m.minTmiC;
+  if (key == "min_thi_c")      return m.minThiC;
+  if (key == "max_delta_p_bar") return m.maxDeltaPBar;
+  if (key == "time_to_goal_s") return m.timeToGoalS;
+  if (key == "freeze_s")       return s.freezeS;
+  if (key == "freeze_law_s")   return m.freezeLawS;
+  if (key == "ln_kg")          return s.lnKg;
+  if (key == "valve_opens")    return m.valveOpens;
+  if (key == "valve_closes")   return m.valveCloses;
+  if (key == "estop_trips")    return m.estopTrips;
+  if (key == "pump_blocked")   return m.pumpBlocked;
+  if (key == "estop_latched")  return run.ctl.estopLatched ? 1.0 : 0.0;
+  return NAN;
+}
+
+const char* const SUMMARY_KEYS[] = {
+  "final_tmi_c", "min_tmi_c", "min_thi_c", "max_delta_p_bar", "time_to_goal_s", "freeze_s",
+  "freeze_law_s", "ln_kg", "valve_opens", "valve_closes", "estop_trips", "pump_blocked", "estop_latched",
+};
+
+// 0 = pass, 1 = expect failed, 2 = bad input.
+int runScenario(const std::string& path, const PlantParams& baseParams, const Options& opts, FILE *csv) {
+  Scenario scenario;
+  std::string error;
+  if (!loadScenario(path, &scenario, &error)) {
+    fprintf(stderr, "%s\n", error.c_str());
+    return 2;
+  }
+  if (scenario.name.empty()) scenario.name = path;
+
+  PlantParams params = baseParams;
+  for (const auto &override : scenario.params) {
+    double *field = plantParam(params, override.first);
+    if (!field) {
+      fprintf(stderr, "%s: unknown plant parameter '%s'\n", path.c_str(), override.first.c_str());
+      return 2;
+    }
+    *field = override.second;
+  }
+
+  hal::host::setTimeUs(0);
+  Plant plant(params);
+  Run run;
+  memcpy(run.ctl.laws, DEFAULT_LAWS, sizeof(DEFAULT_LAWS));
+  LaggedSensor sensors[SENSOR_COUNT];
+  sensors[SENSOR_TMI].value = plant.state().bulkC;
+  sensors[SENSOR_THI].value = plant.state().hxOutC;
+
+  const uint64_t endUs = static_cast<uint64_t>(scenario.durationS * 1e6);
+  const double dtS = TICK_MS / 1000.0;
+  const uint32_t logEveryTicks = opts.logIntervalS > 0.0
+      ? static_cast<uint32_t>(opts.logIntervalS * 1000.0 / TICK_MS + 0.5) : 0;
+  size_t nextEvent = 0;
+  uint32_t nextTcMs = 0;
+  uint64_t tick = 0;
+  const auto wallStart = std::chrono::steady_clock::now();
+
+  printf("# Scenario %s (%s), %.0f s simulated\n", scenario.name.c_str(), path.c_str(), scenario.durationS);
+  while (hal::host::timeUs() < endUs) {
+    const double nowS = simTimeS();
+    while (nextEvent < scenario.events.size() && scenario.events[nextEvent].timeS <= nowS) {
+      const ScenarioEvent &event = scenario.events[nextEvent++];
+      if (!applyEvent(run, event)) {
+        fprintf(stderr, "%s:%d: bad '%s' event\n", path.c_str(), event.line, event.verb.c_str());
+        return 2;
+      }
+    }
+
+    const uint32_t nowMs = hal::nowMs();
+    if (static_cast<int32_t>(nowMs - nextTcMs) >= 0) {
+      for (size_t i = 0; i < SENSOR_COUNT; ++i) {
+        run.ctl.temps[i] = readSensor(sensors[i], run.faults[i]);
+        if (isfinite(run.ctl.temps[i])) run.ctl.tempsValidMs[i] = nowMs;
+      }
+      run.ctl.tempsPublished = true;
+      nextTcMs = nowMs + TC_PERIOD_MS;
+    }
+
+    controlTick(run.ctl, plant.state(), run.metrics);
+
+    run.inputs.valveOpen = run.ctl.valveOpen;
+    run.inputs.pumpPct = run.ctl.pumpCmdPct;
+    plant.step(dtS, run.inputs);
+    const PlantState &s = plant.state();
+    sensors[SENSOR_TMI].step(s.bulkC, dtS, params.tcTauS);
+    sensors[SENSOR_THI].step(s.hxOutC, dtS, params.tcTauS);
+
+    Metrics &m = run.metrics;
+    if (s.bulkC < m.minTmiC) m.minTmiC = s.bulkC;
+    if (s.hxOutC < m.minThiC) m.minThiC = s.hxOutC;
+    if (s.deltaPBar > m.maxDeltaPBar) m.maxDeltaPBar = s.deltaPBar;
+    if (!isfinite(m.timeToGoalS) && s.bulkC <= run.ctl.targets.hfeGoalC) m.timeToGoalS = nowS;
+    if (run.ctl.laws[LAW_THI_FREEZE_RISK].active) m.freezeLawS += dtS;
+
+    hal::host::advanceMs(TICK_MS);
+    ++tick;
+    if (csv && logEveryTicks && tick % logEveryTicks == 0) writeCsvRow(csv, scenario.name, run, s);
+    if (opts.pace > 0.0) {
+      const auto due = wallStart + std::chrono::duration<double>(simTimeS() / opts.pace);
+      std::this_thread::sleep_until(due);
+    }
+  }
+
+  const double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  const PlantState &s = plant.state();
+  printf("{\"type\":\"sim_summary\",\"scenario\":\"%s\",\"sim_s\":%.0f,\"wall_s\":%.3f,\"speedup\":%.0f",
+         scenario.name.c_str(), scenario.durationS, wallS, wallS > 0.0 ? scenario.durationS / wallS : 0.0);
+  for (const char *key : SUMMARY_KEYS) {
+    const double value = metricValue(key, run, s);
+    if (isfinite(value)) printf(",\"%s\":%.6g", key, value);
+    else                 printf(",\"%s\":null", key);
+  }
+  puts("}");
+
+  int status = 0;
+  for (const ScenarioExpect &expect : scenario.expects) {
+    const double actual = metricValue(expect.metric, run, s);
+    const bool ok = expectHolds(expect, actual);
+    printf("# expect %s %s %g: %s (%g)\n", expect.metric.c_str(), expect.op.c_str(), expect.value,
+           ok ? "ok" : "FAIL", actual);
+    if (!ok) status = 1;
+  }
+  return status;
+}
+
+bool parseOptions(int argc, char **argv, Options *opts) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (arg == "--params" && hasValue) opts->paramsPath = argv[++i];
+    else if (arg == "--csv" && hasValue) opts->csvPath = argv[++i];
+    else if (arg == "--log-interval" && hasValue) opts->logIntervalS = atof(argv[++i]);
+    else if (arg == "--pace" && hasValue) opts->pace = atof(argv[++i]);
+    else if (!arg.empty() && arg[0] == '-') return false;
+    else opts->scenarios.push_back(arg);
+  }
+  return !opts->scenarios.empty();
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options opts;
+  if (!parseOptions(argc, argv, &opts)) {
+    fprintf(stderr, "usage: %s [--params FILE] [--csv FILE] [--log-interval S] [--pace X] SCENARIO...\n", argv[0]);
+    return 2;
+  }
+
+  PlantParams params;
+  std::string error;
+  if (!loadPlantParams(opts.paramsPath, &params, &error)) {
+    fprintf(stderr, "%s\n", error.c_str());
+    return 2;
+  }
+
+  FILE *csv = nullptr;
+  if (!opts.csvPath.empty()) {
+    csv = fopen(opts.csvPath.c_str(), "w");
+    if (!csv) {
+      fprintf(stderr, "%s: cannot open\n", opts.csvPath.c_str());
+      return 2;
+    }
+    writeCsvHeader(csv);
+  }
+
+  int status = 0;
+  for (const std::string &path : opts.scenarios) {
+    const int result = runScenario(path, params, opts, csv);
+    if (result > status) status = result;
+  }
+  if (csv) fclose(csv);
+  return status;
+}
@@ -0,0 +1,87 @@
+"""Static RAM map of the controller ELF: .data/.bss/.noinit by symbol.
+
+[env:megaatmega2560] runs this after every link (`extra_scripts = post:...`)
+and writes `ram_map.txt` next to `firmware.elf`, so each build keeps a record
+of where the static part of the Mega's 8 KB went and how much is left for
+heap and stack. The same report from a saved ELF:
+
+    python3 firmware/tools/ram_map.py firmware.elf [--nm avr-nm]
+
+The runtime side is the firmware's `{"type":"mem"}` frame (`MEM`).
+"""
+
+from __future__ import annotations
+
+import argparse
+import subprocess
+import sys
+from pathlib import Path
+
+SRAM_BYTES = 8192
+RAM_SECTIONS = (".data", ".bss", ".noinit")
+
+
+def symbols(nm: str, elf: Path) -> list[tuple[str, int, str]]:
+    """(section, size, name) for every sized symbol in a RAM section."""
+    out = subprocess.run(
+        [nm, "--format=sysv", "--size-sort", "--demangle", str(elf)],
+        check=True, capture_output=True, text=True,
+    ).stdout
+    rows = []
+    for line in out.splitlines():
+        fields = [field.strip() for field in line.split("|")]
+        if len(fields) < 7 or fields[6] not in RAM_SECTIONS or not fields[4]:
+            continue
+        rows.append((fields[6], int(fields[4], 16), fields[0]))
+    rows.sort(key=lambda row: (-row[1], row[2]))
+    return rows
+
+
+def section_sizes(size_tool: str, elf: Path) -> dict[str, int]:
+    out = subprocess.run([size_tool, "-A", str(elf)], check=True, capture_output=True, text=True).stdout
+    sizes = {}
+    for line in out.splitlines():
+        fields = line.split()
+        if len(fields) >= 2 and fields[0] in RAM_SECTIONS:
+            sizes[fields[0]] = int(fields[1])
+    return sizes
+
+
+def report(elf: Path, nm: str, size_tool: str) -> str:
+    sizes = section_sizes(size_tool, elf)
+    total = sum(sizes.values())
+    lines = [
+        f"# RAM map: {elf.name}",
+        "# " + "  ".join(f"{name} {sizes.get(name, 0)}" for name in RAM_SECTIONS)
+        + f"  static {total} / {SRAM_BYTES} ({100.0 * total / SRAM_BYTES:.1f} %),"
+        + f" {SRAM_BYTES - total} left for heap and stack",
+        f"{'section':<8} {'bytes':>6}  symbol",
+    ]
+    lines += [f"{section:<8} {size:>6}  {name}" for section, size, name in symbols(nm, elf)]
+    return "\n".join(lines) + "\n"
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("elf", type=Path)
+    parser.add_argument("--nm", default="avr-nm")
+    parser.add_argument("--size", default="avr-size")
+    args = parser.parse_args()
+    sys.stdout.write(report(args.elf, args.nm, args.size))
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
+else:
+    Import("env")  # noqa: F821
+
+    def write_ram_map(target, source, env):
+        elf = Path(target[0].get_abspath())
+        bin_dir = Path(env.WhereIs("$CC")).parent
+        text = report(elf, str(bin_dir / "avr-nm"), str(bin_dir / "avr-size"))
+        out = elf.with_name("ram_map.txt")
+        out.write_text(text)
+        print(text.splitlines()[1].lstrip("# ") + f" -> {out}")
+
+    env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", write_ram_map)  # noqa: F821
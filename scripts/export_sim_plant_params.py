@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+"""Export lumped plant parameters for the firmware closed-loop simulator.
+
+The simulator (`firmware/src/sim`, `platformio run -d firmware -e sim`) reads a
+plain `key value` file. This script seeds it from the existing analyses so the
+simulated loop stays tied to them:
+
+- HFE-7200 density and heat-capacity fits, inventory volume, steel masses, the
+  installed HX HFE-side UA, the calibrated insulated ambient UA, the freeze
+  limit and LN latent heat from `orca.cooldown`;
+- the LN-side heat-removal ceiling and wall UA from the HX performance fits in
+  `data/processed/HX_performance/derived_from_available_raw/summaries`;
+- pump flow per percent command and the cold delta-P rise (viscosity
+  activation temperature) from the Apr 24 recirculation summary in
+  `data/processed/HFE_measurements`.
+
+Values with no measurement behind them (valve lag, TC lag, stagnant-coil UA,
+pump heat) are written with an `assumed` comment.
+"""
+
+from __future__ import annotations
+
+import argparse
+import csv
+import math
+import statistics
+import sys
+from pathlib import Path
+
+REPO_ROOT = Path(__file__).resolve().parents[1]
+sys.path.insert(0, str(REPO_ROOT / "analysis" / "src"))
+
+from orca import cooldown  # noqa: E402
+from orca.leaks import (  # noqa: E402
+    HFE_7200_DENSITY_INTERCEPT_G_ML,
+    HFE_7200_DENSITY_SLOPE_G_ML_PER_C,
+)
+
+HX_SUMMARY_CSV = (
+    REPO_ROOT
+    / "data/processed/HX_performance/derived_from_available_raw/summaries/hx_full_summary_windows.csv"
+)
+HFE_SUMMARY_CSV = (
+    REPO_ROOT / "data/processed/HFE_measurements/apr24_minus100_cooldown_warmup_summary.csv"
+)
+DEFAULT_OUTPUT = REPO_ROOT / "firmware/sim/plant_params.txt"
+
+LN_BOILING_C = -195.8
+PUMP_DP_REFERENCE_TEMP_C = -80.0
+
+
+def hx_fit(dataset: str) -> dict[str, float]:
+    with HX_SUMMARY_CSV.open(newline="") as handle:
+        for row in csv.DictReader(handle):
+            if row["dataset"] == dataset:
+                return {key: float(value) for key, value in row.items() if key not in {"dataset", "title", "window_min"}}
+    raise SystemExit(f"{HX_SUMMARY_CSV}: no '{dataset}' row")
+
+
+def pump_fit() -> tuple[float, float, float]:
+    """Return (L/min per %, bar per L/min at the reference temperature, activation K).
+
+    Delta-P across the loop is taken as laminar, proportional to flow times an
+    Arrhenius-like viscosity factor: dp/Q = a * exp(B / T).
+    """
+
+    with HFE_SUMMARY_CSV.open(newline="") as handle:
+        rows = list(csv.DictReader(handle))
+    flow_per_pct = statistics.median(
+        float(row["median_volume_flow_lmin"]) / float(row["median_pump_cmd_pct"]) for row in rows
+    )
+    inv_temp = [1.0 / cooldown.celsius_to_kelvin(float(row["median_TMI_C"])) for row in rows]
+    log_dp_per_flow = [
+        math.log(float(row["median_delta_p_bar"]) / float(row["median_volume_flow_lmin"])) for row in rows
+    ]
+    fit = statistics.linear_regression(inv_temp, log_dp_per_flow)
+    dp_per_lpm = math.exp(fit.intercept + fit.slope / cooldown.celsius_to_kelvin(PUMP_DP_REFERENCE_TEMP_C))
+    return flow_per_pct, dp_per_lpm, fit.slope
+
+
+def plant_params() -> list[tuple[str, float, str]]:
+    model = cooldown.default_system_model()
+    design = cooldown.default_cooldown_design_inputs()
+    mixed = hx_fit("mixed")
+    flow_per_pct, dp_per_lpm, visc_k = pump_fit()
+
+    cp_scale = design.hfe_cp_25c_j_kg_k / cooldown.hfe7000_specific_heat_j_kg_k(
+        cooldown.HFE7200_CP_REFERENCE_TEMP_C
+    )
+    hx_area_m2 = math.pi * design.tube_outer_diameter_m * design.installed_length_m
+    loop_steel_kg = (model.process_loop.steel_volume_m3 + model.tank.steel_volume_m3) * model.steel_density_kg_m3
+    hx_steel_kg = model.heat_exchanger.steel_volume_m3 * model.steel_density_kg_m3
+
+    return [
+        ("hfe_volume_l", design.hfe_volume_l, "orca.cooldown HFE_INVENTORY_VOLUME_L"),
+        ("hfe_density_intercept_kg_m3", 1000.0 * HFE_7200_DENSITY_INTERCEPT_G_ML, "orca.leaks HFE-7200 fit"),
+        ("hfe_density_slope_kg_m3_per_c", 1000.0 * HFE_7200_DENSITY_SLOPE_G_ML_PER_C, "orca.leaks HFE-7200 fit"),
+        ("hfe_cp_intercept_j_kg_k", cp_scale * cooldown.HFE7000_CP_INTERCEPT_J_KG_K, "orca.cooldown scaled HFE-7200 cp"),
+        ("hfe_cp_slope_j_kg_k_per_c", cp_scale * cooldown.HFE7000_CP_SLOPE_J_KG_K_PER_C, "orca.cooldown scaled HFE-7200 cp"),
+        ("hfe_freeze_c", design.freeze_temp_c, "orca.cooldown freeze_temp_c"),
+        ("loop_steel_kg", loop_steel_kg, "orca.cooldown process loop + tank shell"),
+        ("hx_steel_kg", hx_steel_kg, "orca.cooldown HX tube"),
+        ("steel_cp_j_kg_k", model.steel_cp_j_kgk, "orca.cooldown SystemModel"),
+        ("hx_hfe_ua_w_k", design.hfe_htc_w_m2_k * hx_area_m2, "orca.cooldown installed HFE-side UA"),
+        ("hx_stagnant_ua_w_k", 0.1 * design.hfe_htc_w_m2_k * hx_area_m2, "assumed: 10% of forced-flow UA"),
+        ("ambient_ua_w_k", cooldown.ambient_leak_ua_w_per_k(model, use_insulation=True), "orca.cooldown insulated warm-up"),
+        ("ambient_c", design.ambient_temp_c, "orca.cooldown ambient_temp_c"),
+        ("initial_c", design.room_temp_c, "orca.cooldown room_temp_c"),
+        ("ln_temp_c", LN_BOILING_C, "LN2 normal boiling point"),
+        ("ln_q_max_w", mixed["P_HX_fit_W"], "HX_performance mixed P_HX fit"),
+        ("ln_wall_ua_w_k", mixed["UA_fit_W_per_K"], "HX_performance mixed UA fit"),
+        ("ln_latent_j_kg", design.ln2_latent_heat_j_kg, "orca.cooldown ln2_latent_heat_j_kg"),
+        ("valve_tau_s", 5.0, "assumed: LN line wet-out lag"),
+        ("pump_flow_lpm_per_pct", flow_per_pct, "Apr 24 recirculation summary"),
+        ("pump_dp_bar_per_lpm", dp_per_lpm, "Apr 24 recirculation summary, at pump_dp_ref_c"),
+        ("pump_dp_ref_c", PUMP_DP_REFERENCE_TEMP_C, "reference temperature for pump_dp_bar_per_lpm"),
+        ("pump_dp_visc_k", visc_k, "Apr 24 recirculation summary, ln(dp/Q) vs 1/T"),
+        ("pump_heat_w", 60.0, "assumed: pump heat into HFE at 100% command"),
+        ("tc_tau_s", 1.5, "assumed: sheathed TC time constant"),
+    ]
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--output", type=Path, default=DEFAULT_OUTPUT)
+    args = parser.parse_args()
+
+    lines = [
+        "# Lumped HFE loop parameters for firmware/src/sim.",
+        "# Generated by scripts/export_sim_plant_params.py; rerun it rather than editing by hand.",
+        "# Scenario files can override any key with `param <key> <value>`.",
+    ]
+    for key, value, source in plant_params():
+        lines.append(f"{key:<32}{value:.6g}  # {source}")
+    args.output.parent.mkdir(parents=True, exist_ok=True)
+    args.output.write_text("\n".join(lines) + "\n")
+    print(f"Wrote {args.output}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""Compare firmware micro-benchmark results against the checked-in baseline.
+
+The benchmark sketch (`firmware/src/bench`, `platformio run -d firmware -e
+bench`) prints one `{"type":"bench"}` JSON line per hot-path case and a
+closing `{"type":"bench_done"}` line. This script collects one such round
+from the Mega's serial port or from a file / stdin (e.g. the `[env:emu]`
+harness running the bench ELF), prints a table against
+`firmware/bench/baseline.json` and exits 1 when a case is slower than its
+baseline by more than the baseline's `threshold_pct`, or is missing.
+
+A case whose baseline is null has not been recorded yet and fails as
+UNRECORDED, so a fresh checkout cannot pass without a recorded baseline.
+`--update` writes the measured values into the baseline instead of comparing;
+record it on the Mega or the emulator and commit it together with the change
+that moved them.
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import sys
+import time
+from pathlib import Path
+from typing import Iterable, Iterator
+
+REPO_ROOT = Path(__file__).resolve().parents[1]
+DEFAULT_BASELINE = REPO_ROOT / "firmware/bench/baseline.json"
+
+BAUD = 115200
+# One round takes well under a second; the sketch repeats every 10 s and
+# the Mega resets when the port opens.
+PORT_TIMEOUT_S = 30.0
+
+
+def serial_lines(port: str, timeout_s: float) -> Iterator[str]:
+    import serial  # pyserial, only needed for --port
+
+    deadline = time.monotonic() + timeout_s
+    with serial.Serial(port, BAUD, timeout=1.0) as link:
+        while time.monotonic() < deadline:
+            raw = link.readline()
+            if raw:
+                yield raw.decode("ascii", errors="replace")
+    raise SystemExit(f"{port}: no complete benchmark round within {timeout_s:.0f} s")
+
+
+def file_lines(path: str) -> Iterable[str]:
+    if path == "-":
+        return sys.stdin
+    return Path(path).open()
+
+
+def collect_round(lines: Iterable[str]) -> tuple[dict[str, dict], dict]:
+    """Results of the first complete round: cases by key and the done line."""
+    cases: dict[str, dict] = {}
+    for line in lines:
+        line = line.strip()
+        if not line.startswith("{"):
+            continue
+        try:
+            record = json.loads(line)
+        except json.JSONDecodeError:
+            continue
+        kind = record.get("type")
+        if kind == "bench":
+            cases[record["case"]] = record
+        elif kind == "bench_done":
+            return cases, record
+    raise SystemExit("input ended before a {\"type\":\"bench_done\"} line")
+
+
+def compare(baseline: dict, cases: dict[str, dict], done: dict) -> int:
+    metric = baseline["metric"]
+    threshold = float(baseline["threshold_pct"])
+    if done.get("f_cpu") != baseline["f_cpu"]:
+        raise SystemExit(f"measured at f_cpu {done.get('f_cpu')}, baseline is for {baseline['f_cpu']}")
+
+    failures = 0
+    print(f"{'case':<26} {'baseline':>10} {'measured':>10} {'change':>8}  status")
+    for key in sorted(set(baseline["cases"]) | set(cases)):
+        expected = baseline["cases"].get(key)
+        measured = cases.get(key, {}).get(metric)
+        if key not in baseline["cases"]:
+            status, change = "new", ""
+        elif measured is None:
+            status, change = "MISSING", ""
+            failures += 1
+        elif expected is None:
+            status, change = "UNRECORDED", ""
+            failures += 1
+        else:
+            pct = 100.0 * (measured - expected) / expected if expected else 0.0
+            change = f"{pct:+.1f}%"
+            if pct > threshold:
+                status = "REGRESSION"
+                failures += 1
+            else:
+                status = "ok"
+        print(f"{key:<26} {_cell(expected):>10} {_cell(measured):>10} {change:>8}  {status}")
+
+    print(f"# {metric}, threshold +{threshold:g}%, timer overhead {done.get('overhead_cycles')} cycles subtracted")
+    if any(value is None for value in baseline["cases"].values()):
+        print("# baseline not recorded; run with --update on the board or emulator and commit it")
+    return 1 if failures else 0
+
+
+def _cell(value: object) -> str:
+    return "-" if value is None else str(value)
+
+
+def update(path: Path, baseline: dict, cases: dict[str, dict], done: dict) -> None:
+    metric = baseline["metric"]
+    baseline["f_cpu"] = done["f_cpu"]
+    baseline["cases"] = {key: cases[key][metric] for key in sorted(cases)}
+    path.write_text(json.dumps(baseline, indent=2) + "\n")
+    print(f"wrote {len(cases)} cases to {path}")
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--port", help="serial port of a Mega running the bench sketch")
+    source.add_argument("--input", help="captured bench output, '-' for stdin")
+    parser.add_argument("--baseline", type=Path, default=DEFAULT_BASELINE)
+    parser.add_argument("--timeout", type=float, default=PORT_TIMEOUT_S, help="seconds to wait on --port")
+    parser.add_argument("--update", action="store_true", help="record the measured values as the new baseline")
+    args = parser.parse_args()
+
+    baseline = json.loads(args.baseline.read_text())
+    lines = serial_lines(args.port, args.timeout) if args.port else file_lines(args.input)
+    cases, done = collect_round(lines)
+
+    if args.update:
+        update(args.baseline, baseline, cases, done)
+        return 0
+    return compare(baseline, cases, done)
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
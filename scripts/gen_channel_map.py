@@ -0,0 +1,244 @@
+#!/usr/bin/env python3
+"""Generate the thermocouple channel tables from config/channels.yaml.
+
+The firmware, the supervisor and the web UI all index temperatures by
+channel (`temps[]` in telemetry, the `<tag>_C` log columns, the chart
+legend). The layout is defined once in `config/channels.yaml`; this script
+writes it out for each side:
+
+- `firmware/lib/orca_core/channel_map.h`: constexpr table (CS pin, TC type,
+  role, calibration and acquisition defaults) plus `TC_CH_<TAG>` indices;
+- `supervisor/channel_map.py`: channel records, log columns and tag indices;
+- `clients/web/channel_map.js`: the same as `window.ORCA_CHANNEL_MAP`, with
+  its cache-busting `?v=` in `clients/web/index.html` set to the map id.
+
+Each output carries `CHANNEL_MAP_ID`, a CRC-32 of the tags, pins, types and
+roles in order. The firmware reports it on its first telemetry line and keys
+its EEPROM parameter block on it; the supervisor warns when it does not match
+its own table.
+
+    python3 scripts/gen_channel_map.py          # rewrite the generated files
+    python3 scripts/gen_channel_map.py --check  # exit 1 if any is out of date
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import re
+import sys
+import zlib
+from pathlib import Path
+
+import yaml
+
+REPO_ROOT = Path(__file__).resolve().parents[1]
+SOURCE = REPO_ROOT / "config" / "channels.yaml"
+CPP_OUT = REPO_ROOT / "firmware" / "lib" / "orca_core" / "channel_map.h"
+PY_OUT = REPO_ROOT / "supervisor" / "channel_map.py"
+JS_OUT = REPO_ROOT / "clients" / "web" / "channel_map.js"
+WEB_INDEX = REPO_ROOT / "clients" / "web" / "index.html"
+
+TC_TYPE_LETTERS = "BEJKNRST"  # MAX31856_TCTYPE_B .. _T
+ROLES = ("spare", "monitor", "control")
+TC_AVG_VALUES = (1, 2, 4, 8, 16)
+MAX_CHANNELS = 16  # firmware EEPROM parameter block; the emulator models as many chips
+MAX_CS_PIN = 69  # Mega 2560 digital pins D0..D69 (A0..A15 = D54..D69)
+TAG_RE = re.compile(r"^[A-Z][A-Z0-9]*$")
+HEADER_NOTE = "Generated by scripts/gen_channel_map.py from config/channels.yaml; do not edit."
+
+
+def load_channels(path: Path) -> list[dict]:
+    data = yaml.safe_load(path.read_text(encoding="utf-8")) or {}
+    entries = data.get("channels")
+    if not isinstance(entries, list) or not entries:
+        raise ValueError(f"{path}: 'channels' must be a non-empty list")
+    if len(entries) > MAX_CHANNELS:
+        raise ValueError(f"{path}: {len(entries)} channels; the firmware supports at most {MAX_CHANNELS}")
+
+    channels: list[dict] = []
+    tags: set[str] = set()
+    pins: set[int] = set()
+    for index, entry in enumerate(entries):
+        where = f"{path.name}: channel {index}"
+        tag = str(entry.get("tag", ""))
+        if not TAG_RE.match(tag) or tag in tags:
+            raise ValueError(f"{where}: tag {tag!r} must be unique upper-case letters/digits")
+        pin = int(entry["cs_pin"])
+        if not 0 <= pin <= MAX_CS_PIN or pin in pins:
+            raise ValueError(f"{where}: cs_pin {pin} must be a unique Mega pin")
+        tc_type = str(entry["tc_type"]).upper()
+        if len(tc_type) != 1 or tc_type not in TC_TYPE_LETTERS:
+            raise ValueError(f"{where}: tc_type {tc_type!r} is not one of {TC_TYPE_LETTERS}")
+        role = str(entry["role"])
+        if role not in ROLES:
+            raise ValueError(f"{where}: role {role!r} is not one of {', '.join(ROLES)}")
+        avg = int(entry["avg"])
+        if avg not in TC_AVG_VALUES:
+            raise ValueError(f"{where}: avg {avg} is not one of {TC_AVG_VALUES}")
+        period_ms = int(entry["period_ms"])
+        if not 0 <= period_ms <= 60000:
+            raise ValueError(f"{where}: period_ms {period_ms} is outside 0..60000")
+        tags.add(tag)
+        pins.add(pin)
+        channels.append({
+            "index": index,
+            "tag": tag,
+            "label": str(entry.get("label", tag)),
+            "column": f"{tag}_C",
+            "cs_pin": pin,
+            "tc_type": tc_type,
+            "role": role,
+            "connected": role != "spare",
+            "gain": float(entry["gain"]),
+            "offset_c": float(entry["offset_c"]),
+            "period_ms": period_ms,
+            "avg": avg,
+        })
+    return channels
+
+
+def map_id(channels: list[dict]) -> str:
+    identity = [[ch["tag"], ch["cs_pin"], ch["tc_type"], ch["role"]] for ch in channels]
+    text = json.dumps(identity, separators=(",", ":"))
+    return f"{zlib.crc32(text.encode('ascii')):08x}"
+
+
+def cpp_float(value: float) -> str:
+    text = repr(float(value))
+    return f"{text}f"
+
+
+def py_literal(value: object) -> str:
+    return json.dumps(value) if isinstance(value, str) else repr(value)
+
+
+def js_literal(value: object) -> str:
+    if isinstance(value, bool):
+        return "true" if value else "false"
+    if isinstance(value, str):
+        return "'" + value.replace("\\", "\\\\").replace("'", "\\'") + "'"
+    return repr(value)
+
+
+def render_cpp(channels: list[dict], ident: str) -> str:
+    tag_width = max(len(ch["tag"]) for ch in channels)
+    lines = [
+        f"// {HEADER_NOTE}",
+        "//",
+        "// Thermocouple channels in temps[] order. Telemetry carries temperatures by",
+        "// index only; the supervisor and web UI resolve names from their own",
+        "// generated tables, checked against TC_CHANNEL_MAP_ID.",
+        "#pragma once",
+        "",
+        "#include <stddef.h>",
+        "#include <stdint.h>",
+        "",
+        "enum TcRole : uint8_t { TC_ROLE_SPARE, TC_ROLE_MONITOR, TC_ROLE_CONTROL };",
+        "",
+        "struct TcChannelDef {",
+        "  uint8_t  csPin;",
+        "  uint8_t  tcType;    // MAX31856_TCTYPE_* (0 = B .. 7 = T)",
+        "  TcRole   role;",
+        "  float    gain;      // calibration default: gain * raw + offsetC",
+        "  float    offsetC;",
+        "  uint16_t periodMs;  // read period default, 0 = disabled",
+        "  uint8_t  avg;       // samples averaged per conversion default",
+        "};",
+        "",
+        f"#define TC_CHANNEL_MAP_ID \"{ident}\"",
+        f"constexpr uint32_t TC_CHANNEL_MAP_CRC = 0x{ident}UL;  // TC_CHANNEL_MAP_ID as a number",
+        f"constexpr size_t TC_CHANNEL_COUNT = {len(channels)};",
+        "",
+    ]
+    for ch in channels:
+        lines.append(f"constexpr uint8_t TC_CH_{ch['tag']:<{tag_width}} = {ch['index']};")
+    lines += ["", "constexpr TcChannelDef TC_CHANNELS[TC_CHANNEL_COUNT] = {"]
+    for ch in channels:
+        role = f"TC_ROLE_{ch['role'].upper()},"
+        lines.append(
+            f"  {{ {ch['cs_pin']:>2}, {TC_TYPE_LETTERS.index(ch['tc_type'])}, {role:<16} "
+            f"{cpp_float(ch['gain']):>10}, {cpp_float(ch['offset_c']):>10}, "
+            f"{ch['period_ms']:>5}, {ch['avg']:>2} }},  // U{ch['index']} / {ch['tag']} ({ch['tc_type']})"
+        )
+    lines += ["};", "", "// Contiguous CS pins for hal::thermocoupleBus() and the emulator board.",
+              "constexpr uint8_t TC_CS_PINS[TC_CHANNEL_COUNT] = { "
+              + ", ".join(str(ch["cs_pin"]) for ch in channels) + " };", ""]
+    return "\n".join(lines)
+
+
+def render_py(channels: list[dict], ident: str) -> str:
+    fields = ("index", "tag", "label", "column", "cs_pin", "tc_type", "role", "connected")
+    lines = [
+        f'"""Thermocouple channel map. {HEADER_NOTE}"""',
+        "",
+        "from __future__ import annotations",
+        "",
+        f'CHANNEL_MAP_ID = "{ident}"',
+        "",
+        "TC_CHANNELS: tuple[dict, ...] = (",
+    ]
+    for ch in channels:
+        record = ", ".join(f'"{key}": {py_literal(ch[key])}' for key in fields)
+        lines.append(f"    {{{record}}},")
+    lines += [
+        ")",
+        "TC_CHANNEL_COUNT = len(TC_CHANNELS)",
+        'TC_INDEX: dict[str, int] = {ch["tag"]: ch["index"] for ch in TC_CHANNELS}',
+        'TEMP_LOG_COLUMNS: list[str] = [ch["column"] for ch in TC_CHANNELS]',
+        "",
+    ]
+    return "\n".join(lines)
+
+
+def render_js(channels: list[dict], ident: str) -> str:
+    fields = ("index", "tag", "label", "column", "role", "connected")
+    lines = [
+        f"// {HEADER_NOTE}",
+        "'use strict';",
+        "",
+        "window.ORCA_CHANNEL_MAP = Object.freeze({",
+        f"  id: '{ident}',",
+        "  channels: Object.freeze([",
+    ]
+    for ch in channels:
+        record = ", ".join(f"{key}: {js_literal(ch[key])}" for key in fields)
+        lines.append(f"    Object.freeze({{ {record} }}),")
+    lines += [
+        "  ]),",
+        "  index: Object.freeze({ "
+        + ", ".join(f"{ch['tag']}: {ch['index']}" for ch in channels) + " }),",
+        "});",
+        "",
+    ]
+    return "\n".join(lines)
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--check", action="store_true", help="report stale outputs instead of writing them")
+    args = parser.parse_args()
+
+    channels = load_channels(SOURCE)
+    ident = map_id(channels)
+    outputs = {
+        CPP_OUT: render_cpp(channels, ident),
+        PY_OUT: render_py(channels, ident),
+        JS_OUT: render_js(channels, ident),
+        WEB_INDEX: re.sub(r"channel_map\.js\?v=[0-9a-f]*", f"channel_map.js?v={ident}",
+                          WEB_INDEX.read_text(encoding="utf-8")),
+    }
+    stale = [path for path, text in outputs.items()
+             if not path.exists() or path.read_text(encoding="utf-8") != text]
+    for path in stale:
+        rel = path.relative_to(REPO_ROOT)
+        if args.check:
+            print(f"{rel} is out of date; run scripts/gen_channel_map.py", file=sys.stderr)
+        else:
+            path.write_text(outputs[path], encoding="utf-8")
+            print(f"wrote {rel}")
+    return 1 if args.check and stale else 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
@@ -29,6 +29,11 @@ from fastapi import (
 from fastapi.responses import JSONResponse
 from fastapi.staticfiles import StaticFiles
 
+try:  # `uvicorn supervisor.app:app` from the repo root or `app:app` from here
+    from .channel_map import CHANNEL_MAP_ID, TC_CHANNEL_COUNT, TC_INDEX, TEMP_LOG_COLUMNS
+except ImportError:
+    from channel_map import CHANNEL_MAP_ID, TC_CHANNEL_COUNT, TC_INDEX, TEMP_LOG_COLUMNS
+
 # ─────────────────────────── logging ───────────────────────────
 logging.basicConfig(level=logging.INFO, format="%(levelname)s: %(message)s")
 log = logging.getLogger("supervisor")
@@ -201,19 +206,9 @@ def parse_serial_payload(raw: bytes) -> Optional[dict]:
 
 DETECT_ZERO_AS_NC = True
 
-MAX_LOG_SENSORS = 10
-TEMP_LOG_COLUMNS = [
-    "THR_C",
-    "U1_C",
-    "TTEST_C",
-    "TFO_C",
-    "TTI_C",
-    "TNO_C",
-    "TTO_C",
-    "TMI_C",
-    "THM_C",
-    "THI_C",
-]
+# Channel tags, log columns and order come from supervisor/channel_map.py,
+# generated from config/channels.yaml (scripts/gen_channel_map.py).
+MAX_LOG_SENSORS = TC_CHANNEL_COUNT
 TC_CALIBRATION_PATH = REPO / "data" / "processed" / "calibration" / "TC_calibration_20260420.csv"
 RAW_LOG_DIR = REPO / "data" / "raw"
 PUMP_LOG_FIELDS: list[tuple[str, str, str]] = [
@@ -249,6 +244,9 @@ RSV_SCALE_LOG_FIELDS: list[tuple[str, str, str]] = [
     ("rsv_scale_mass_kg", "mass_kg", "{:.3f}"),
     ("rsv_scale_raw_counts", "raw_counts", "{:.0f}"),
     ("rsv_scale_calibrated", "calibrated", "{:.0f}"),
+    ("rsv_scale_mass_filtered_kg", "mass_filtered_kg", "{:.4f}"),
+    ("rsv_scale_rate_kg_h", "rate_kg_h", "{:.5f}"),
+    ("rsv_scale_rate_sigma_kg_h", "rate_sigma_kg_h", "{:.5f}"),
 ]
 RSV_SCALE_INVALID_RAW_COUNTS = {8388607, -8388608}
 
@@ -323,6 +321,15 @@ def _calibrate_tc_temps(temps: object) -> tuple[list[float | None], list[float |
     return calibrated_temps, raw_temps
 
 
+def _firmware_tc_temps(payload: dict) -> tuple[list[float | None], list[float | None]] | None:
+    # Firmware with on-device calibration sends calibrated temps[] plus temps_raw[].
+    temps = payload.get("temps")
+    raw = payload.get("temps_raw")
+    if payload.get("tc_calibrated") is not True or not isinstance(temps, list) or not isinstance(raw, list):
+        return None
+    return [_finite_float(value) for value in temps], [_finite_float(value) for value in raw]
+
+
 def _first_finite(values: list[float | None]) -> float | None:
     for value in values:
         if isinstance(value, (int, float)) and math.isfinite(float(value)):
@@ -373,6 +380,7 @@ def _normalize_rsv_scale_payload(rsv_scale: object) -> dict | None:
     if not ready:
         normalized["raw_counts"] = None
         normalized["mass_kg"] = None
+        normalized["mass_filtered_kg"] = None
     return normalized
 
 
@@ -580,15 +588,32 @@ def _fluid_delta_p_bar(pump: dict) -> float | None:
     return after - before
 
 
+def _check_channel_map(payload: dict) -> None:
+    # Firmware reports its channel map once, on the first line after boot.
+    firmware_map = payload.get("channel_map")
+    if isinstance(firmware_map, str) and firmware_map != CHANNEL_MAP_ID:
+        log.warning(
+            "Firmware channel map %s differs from supervisor %s; temps[] columns may be mislabelled "
+            "(rebuild both from config/channels.yaml)",
+            firmware_map,
+            CHANNEL_MAP_ID,
+        )
+
+
 def _normalize_telemetry_payload(payload: dict) -> dict:
     if not isinstance(payload, dict) or payload.get("type") != "telemetry":
         return payload
     if payload.get("_units_normalized"):
         return payload
+    _check_channel_map(payload)
 
     normalized = dict(payload)
 
-    calibrated_temps, raw_temps = _calibrate_tc_temps(payload.get("temps"))
+    firmware_temps = _firmware_tc_temps(payload)
+    if firmware_temps is not None:
+        calibrated_temps, raw_temps = firmware_temps
+    else:
+        calibrated_temps, raw_temps = _calibrate_tc_temps(payload.get("temps"))
     if calibrated_temps:
         normalized["temps"] = calibrated_temps
         normalized["temps_raw"] = raw_temps
@@ -604,7 +629,11 @@ def _normalize_telemetry_payload(payload: dict) -> dict:
     if control is not None:
         normalized_control = dict(control)
         thi_raw = _finite_float(control.get("thi_temp_c"))
-        if thi_raw is not None:
+        if firmware_temps is not None:
+            thi_index = TC_INDEX["THI"]
+            if thi_index < len(raw_temps):
+                normalized_control["thi_temp_c_raw"] = raw_temps[thi_index]
+        elif thi_raw is not None:
             normalized_control["thi_temp_c_raw"] = thi_raw
             normalized_control["thi_temp_c"] = _calibrate_tc_value("THI_C", thi_raw)
         normalized["control"] = normalized_control
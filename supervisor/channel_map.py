@@ -0,0 +1,21 @@
+"""Thermocouple channel map. Generated by scripts/gen_channel_map.py from config/channels.yaml; do not edit."""
+
+from __future__ import annotations
+
+CHANNEL_MAP_ID = "58f364bf"
+
+TC_CHANNELS: tuple[dict, ...] = (
+    {"index": 0, "tag": "THR", "label": "Heater internal", "column": "THR_C", "cs_pin": 9, "tc_type": "K", "role": "control", "connected": True},
+    {"index": 1, "tag": "U1", "label": "Unassigned", "column": "U1_C", "cs_pin": 3, "tc_type": "K", "role": "spare", "connected": False},
+    {"index": 2, "tag": "TTEST", "label": "Test thermocouple", "column": "TTEST_C", "cs_pin": 23, "tc_type": "K", "role": "monitor", "connected": True},
+    {"index": 3, "tag": "TFO", "label": "Flow meter outlet", "column": "TFO_C", "cs_pin": 31, "tc_type": "T", "role": "monitor", "connected": True},
+    {"index": 4, "tag": "TTI", "label": "Tank inlet", "column": "TTI_C", "cs_pin": 39, "tc_type": "T", "role": "monitor", "connected": True},
+    {"index": 5, "tag": "TNO", "label": "Nitrogen outlet", "column": "TNO_C", "cs_pin": 47, "tc_type": "K", "role": "control", "connected": True},
+    {"index": 6, "tag": "TTO", "label": "Tank outlet", "column": "TTO_C", "cs_pin": 30, "tc_type": "T", "role": "monitor", "connected": True},
+    {"index": 7, "tag": "TMI", "label": "Pump inlet", "column": "TMI_C", "cs_pin": 38, "tc_type": "T", "role": "control", "connected": True},
+    {"index": 8, "tag": "THM", "label": "HEX middle", "column": "THM_C", "cs_pin": 46, "tc_type": "K", "role": "control", "connected": True},
+    {"index": 9, "tag": "THI", "label": "HEX inlet", "column": "THI_C", "cs_pin": 48, "tc_type": "K", "role": "control", "connected": True},
+)
+TC_CHANNEL_COUNT = len(TC_CHANNELS)
+TC_INDEX: dict[str, int] = {ch["tag"]: ch["index"] for ch in TC_CHANNELS}
+TEMP_LOG_COLUMNS: list[str] = [ch["column"] for ch in TC_CHANNELS]